@@ -5,6 +5,10 @@ set MSYS2=C:\msys64
 set BASH=%MSYS2%\usr\bin\bash.exe
 set OUT=wooting-aim.exe
 
+:: "build.bat instrument" compiles in the per-stage counters (instrument.h)
+set DEFS=
+if /i "%~1"=="instrument" set DEFS=-DWA_INSTRUMENT
+
 :: Get script directory (where build.bat lives)
 set "PROJDIR=%~dp0"
 :: Remove trailing backslash
@@ -33,7 +37,7 @@ if %errorlevel%==0 (
 
 echo [BUILD] Compiling wooting-aim v0.7...
 echo [BUILD] Project: %PROJDIR%
-"%BASH%" -lc "cd '%POSIX%' && gcc -O2 -Wall -g -I./include -I/mingw64/include -o wooting-aim.exe src/main.c src/hid_writer.c -L./lib -L/mingw64/lib -lwooting_analog_sdk -lhidapi -lsetupapi -lws2_32 -ladvapi32"
+"%BASH%" -lc "cd '%POSIX%' && gcc -O2 -Wall -g %DEFS% -I./include -I/mingw64/include -o wooting-aim.exe src/main.c src/hid_writer.c src/hid_queue.c src/stats_log.c src/stats_store.c src/histogram.c src/telemetry_shm.c src/metrics.c src/config.c src/control.c src/trace_file.c src/proc_watch.c src/thread_place.c src/platform.c src/frame_trace.c src/instrument.c src/gsi.c -L./lib -L/mingw64/lib -lwooting_analog_sdk -lhidapi -lsetupapi -lws2_32 -ladvapi32"
 
 if %errorlevel%==0 (
     echo [BUILD] OK: %OUT%
@@ -51,6 +55,60 @@ if %errorlevel%==0 (
     echo [BUILD] hid-enum failed, non-critical
 )
 
+echo [BUILD] Compiling stats-export...
+"%BASH%" -lc "cd '%POSIX%' && gcc -O2 -Wall -I./include -o stats-export.exe src/stats_export.c src/stats_store.c"
+
+if %errorlevel%==0 (
+    echo [BUILD] OK: stats-export.exe
+) else (
+    echo [BUILD] stats-export failed, non-critical
+)
+
+echo [BUILD] Compiling stats-analyze...
+"%BASH%" -lc "cd '%POSIX%' && gcc -O2 -Wall -I./include -o stats-analyze.exe src/stats_analyze.c src/stats_store.c src/histogram.c"
+
+if %errorlevel%==0 (
+    echo [BUILD] OK: stats-analyze.exe
+) else (
+    echo [BUILD] stats-analyze failed, non-critical
+)
+
+echo [BUILD] Compiling telemetry-view...
+"%BASH%" -lc "cd '%POSIX%' && gcc -O2 -Wall -I./include -o telemetry-view.exe src/telemetry_view.c src/telemetry_shm.c"
+
+if %errorlevel%==0 (
+    echo [BUILD] OK: telemetry-view.exe
+) else (
+    echo [BUILD] telemetry-view failed, non-critical
+)
+
+echo [BUILD] Compiling wooting-aim-ctl...
+"%BASH%" -lc "cd '%POSIX%' && gcc -O2 -Wall -I./include -o wooting-aim-ctl.exe src/control_client.c src/control.c src/platform.c -lws2_32 -ladvapi32"
+
+if %errorlevel%==0 (
+    echo [BUILD] OK: wooting-aim-ctl.exe
+) else (
+    echo [BUILD] wooting-aim-ctl failed, non-critical
+)
+
+echo [BUILD] Compiling actuation-sim...
+"%BASH%" -lc "cd '%POSIX%' && gcc -O2 -Wall -I./include -o actuation-sim.exe src/actuation_sim.c src/actuation.c src/trace_file.c src/config.c"
+
+if %errorlevel%==0 (
+    echo [BUILD] OK: actuation-sim.exe
+) else (
+    echo [BUILD] actuation-sim failed, non-critical
+)
+
+echo [BUILD] Compiling sweep...
+"%BASH%" -lc "cd '%POSIX%' && gcc -O2 -Wall -I./include -I/mingw64/include -o sweep.exe src/sweep.c src/actuation.c src/sweep_stubs.c src/hid_queue.c src/stats_log.c src/stats_store.c src/histogram.c src/telemetry_shm.c src/metrics.c src/config.c src/control.c src/trace_file.c src/proc_watch.c src/thread_place.c src/platform.c src/frame_trace.c src/instrument.c src/gsi.c -lws2_32 -ladvapi32"
+
+if %errorlevel%==0 (
+    echo [BUILD] OK: sweep.exe
+) else (
+    echo [BUILD] sweep failed, non-critical
+)
+
 echo.
 echo Done. Run with: %OUT% --adaptive
 endlocal
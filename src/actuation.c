@@ -0,0 +1,413 @@
+/*
+ * actuation.c - Offline actuation / rapid-trigger simulator
+ *
+ * Two runs over the same frames, adaptive (the engine's AP/RT) and static
+ * (ActOptions.base_*), each with its own key models, edge lists and
+ * per-axis player velocity. Counter-strafes come from the recorded axis
+ * states, which depend on analog depth only, so both runs see the same ones.
+ */
+
+#include "actuation.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* AxisState values as main.c records them */
+enum { AS_IDLE, AS_STRAFE_POS, AS_STRAFE_NEG, AS_COUNTER_POS, AS_COUNTER_NEG };
+
+/* CS2 movement, the model vel_update() in main.c uses */
+#define SV_FRICTION    5.2f
+#define SV_ACCELERATE  5.5f
+#define SV_STOPSPEED   80.0f
+#define SHOOTABLE      0.34f    /* accuracy threshold, fraction of max speed */
+#define MOVE_STEP_MS   1.0      /* integration step between frames */
+
+/* Key index per axis and direction: H = A(neg) / D(pos), V = S(neg) / W(pos) */
+static const int AXIS_KEY[2][2] = { { 1, 3 }, { 2, 0 } };
+
+/* ---------- key model ---------- */
+
+void act_key_reset(ActKey *k) {
+    k->pressed = false;
+    k->rt_zone = false;
+    k->extreme = 0.0f;
+}
+
+int act_key_step(ActKey *k, float depth, float ap, float rt) {
+    if (k->pressed) {
+        if (depth > k->extreme) k->extreme = depth;
+        if (depth < ap) {
+            k->pressed = false;
+            k->rt_zone = false;
+            return -1;
+        }
+        if (rt > 0.0f && depth <= k->extreme - rt) {
+            k->pressed = false;
+            k->extreme = depth;
+            return -1;
+        }
+        return 0;
+    }
+
+    if (depth < ap) {
+        k->rt_zone = false;
+        return 0;
+    }
+    if (!k->rt_zone) {
+        k->pressed = true;
+        k->rt_zone = true;
+        k->extreme = depth;
+        return 1;
+    }
+    if (depth < k->extreme) k->extreme = depth;
+    if (depth >= k->extreme + rt) {
+        k->pressed = true;
+        k->extreme = depth;
+        return 1;
+    }
+    return 0;
+}
+
+/* ---------- edge lists ---------- */
+
+typedef struct {
+    double *t;
+    int8_t *dir;                /* +1 press / became shootable, -1 release / lost it */
+    size_t n, cap;
+} Edges;
+
+static bool edges_push(Edges *e, double t, int dir) {
+    if (e->n == e->cap) {
+        size_t cap = e->cap ? e->cap * 2 : 256;
+        double *nt = realloc(e->t, cap * sizeof(*nt));
+        if (!nt) return false;
+        e->t = nt;
+        int8_t *nd = realloc(e->dir, cap * sizeof(*nd));
+        if (!nd) return false;
+        e->dir = nd;
+        e->cap = cap;
+    }
+    e->t[e->n] = t;
+    e->dir[e->n] = (int8_t)dir;
+    e->n++;
+    return true;
+}
+
+static void edges_free(Edges *e) {
+    free(e->t);
+    free(e->dir);
+}
+
+/* First index with t >= from */
+static size_t edges_lower(const Edges *e, double from) {
+    size_t lo = 0, hi = e->n;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (e->t[mid] < from) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+/* Time of the first `dir` edge in [from, to], NAN if none */
+static double edges_first(const Edges *e, double from, double to, int dir) {
+    for (size_t i = edges_lower(e, from); i < e->n && e->t[i] <= to; i++)
+        if (e->dir[i] == dir) return e->t[i];
+    return NAN;
+}
+
+/* ---------- one run ---------- */
+
+struct ActRun {
+    ActKey key[ACT_KEYS];
+    Edges edges[ACT_KEYS];
+    float vel[2];
+    bool shootable[2];
+    Edges shoot[2];             /* shootable transitions per axis */
+    uint64_t presses;
+};
+typedef ActRun Run;
+
+static void run_init(Run *r) {
+    memset(r, 0, sizeof(*r));
+    for (int k = 0; k < ACT_KEYS; k++) act_key_reset(&r->key[k]);
+    r->shootable[0] = r->shootable[1] = true;
+}
+
+static void run_free(Run *r) {
+    for (int k = 0; k < ACT_KEYS; k++) edges_free(&r->edges[k]);
+    edges_free(&r->shoot[0]);
+    edges_free(&r->shoot[1]);
+}
+
+static bool run_shootable(Run *r, int axis, double t, float max_speed) {
+    bool sh = fabsf(r->vel[axis]) <= SHOOTABLE * max_speed;
+    if (sh == r->shootable[axis]) return true;
+    r->shootable[axis] = sh;
+    return edges_push(&r->shoot[axis], t, sh ? 1 : -1);
+}
+
+/* Integrate both axes from t0 to t1 with the keys as they are now */
+static bool run_move(Run *r, double t0, double t1, float max_speed) {
+    for (int axis = 0; axis < 2; axis++) {
+        bool pos = r->key[AXIS_KEY[axis][1]].pressed;
+        bool neg = r->key[AXIS_KEY[axis][0]].pressed;
+        float wish = pos == neg ? 0.0f : pos ? 1.0f : -1.0f;
+        float *v = &r->vel[axis];
+
+        if (fabsf(*v) > max_speed) *v = *v > 0 ? max_speed : -max_speed;
+        if (!run_shootable(r, axis, t0, max_speed)) return false;
+
+        for (double t = t0; t < t1; ) {
+            /* Nothing changes at rest or at full speed with the key held */
+            if (*v == 0.0f && wish == 0.0f) break;
+            if (wish != 0.0f && *v * wish >= max_speed) break;
+
+            double step = t1 - t < MOVE_STEP_MS ? t1 - t : MOVE_STEP_MS;
+            float dt = (float)(step / 1000.0);
+            float speed = fabsf(*v);
+            if (speed > 0.001f) {
+                float control = speed < SV_STOPSPEED ? SV_STOPSPEED : speed;
+                float new_speed = speed - control * SV_FRICTION * dt;
+                if (new_speed < 0.0f) new_speed = 0.0f;
+                *v *= new_speed / speed;
+            }
+            if (wish != 0.0f) {
+                float add = max_speed - *v * wish;
+                if (add > 0.0f) {
+                    float accel = SV_ACCELERATE * dt * max_speed;
+                    *v += (accel > add ? add : accel) * wish;
+                }
+            }
+            if (fabsf(*v) < 0.5f) *v = 0.0f;
+            t += step;
+            if (!run_shootable(r, axis, t, max_speed)) return false;
+        }
+    }
+    return true;
+}
+
+static bool run_keys(Run *r, double t, const float *depth, const float *ap, const float *rt) {
+    for (int k = 0; k < ACT_KEYS; k++) {
+        int edge = act_key_step(&r->key[k], depth[k] * ACT_TRAVEL_MM, ap[k], rt[k]);
+        if (!edge) continue;
+        if (edge > 0) r->presses++;
+        if (!edges_push(&r->edges[k], t, edge)) return false;
+    }
+    return true;
+}
+
+/* First moment at or after t when the axis is shootable, within the window */
+static double run_shootable_at(const Run *r, int axis, double t) {
+    const Edges *e = &r->shoot[axis];
+    size_t i = edges_lower(e, t);
+    while (i < e->n && e->t[i] <= t) i++;
+    if (i == 0 || e->dir[i - 1] > 0) return t;       /* runs start at rest */
+    return edges_first(e, t, t + ACT_WINDOW_MS, 1);
+}
+
+/* ---------- episodes ---------- */
+
+typedef struct {
+    uint8_t axis, dir;
+    size_t i_strafe, i_counter; /* frame indices */
+} Episode;
+
+/* Adaptive presses with no overlapping static press on the same key */
+static uint64_t count_ghosts(const Edges *a, const Edges *b) {
+    uint64_t ghosts = 0;
+    size_t j = 0;
+    /* Both lists alternate press, release, ... starting released */
+    for (size_t i = 0; i < a->n; i += 2) {
+        double start = a->t[i];
+        double end = i + 1 < a->n ? a->t[i + 1] : INFINITY;
+        while (j < b->n && (j + 1 < b->n ? b->t[j + 1] : INFINITY) < start) j += 2;
+        if (j >= b->n || b->t[j] > end) ghosts++;
+    }
+    return ghosts;
+}
+
+static uint8_t state_of(const ActFrame *f, int axis) {
+    return axis ? f->v_state : f->h_state;
+}
+
+/* One run over all frames: the engine's AP/RT as recorded, or the static
+ * profile. False on allocation failure or time going backwards. */
+static bool run_frames(Run *r, const ActFrame *f, size_t n, const ActOptions *o, bool adaptive) {
+    float base_ap[ACT_KEYS], base_rt[ACT_KEYS];
+    for (int k = 0; k < ACT_KEYS; k++) {
+        base_ap[k] = o->base_ap;
+        base_rt[k] = o->base_rt;
+    }
+
+    size_t applied = 0;         /* frame whose AP/RT the firmware has */
+    for (size_t i = 0; i < n; i++) {
+        if (i > 0 && !(f[i].t_ms >= f[i - 1].t_ms)) return false;    /* edges must stay sorted */
+        if (i > 0 && !run_move(r, f[i - 1].t_ms, f[i].t_ms, f[i - 1].max_speed)) return false;
+        if (!adaptive) {
+            if (!run_keys(r, f[i].t_ms, f[i].depth, base_ap, base_rt)) return false;
+            continue;
+        }
+        while (applied + 1 <= i && f[applied + 1].t_ms <= f[i].t_ms - o->write_latency_ms)
+            applied++;
+        if (!run_keys(r, f[i].t_ms, f[i].depth, f[applied].ap, f[applied].rt)) return false;
+    }
+    return true;
+}
+
+ActRun *act_run_static(const ActFrame *f, size_t n, const ActOptions *o) {
+    Run *r = malloc(sizeof(*r));
+    if (!r) return NULL;
+    run_init(r);
+    if (!run_frames(r, f, n, o, false)) {
+        act_run_free(r);
+        return NULL;
+    }
+    return r;
+}
+
+void act_run_free(ActRun *r) {
+    if (!r) return;
+    run_free(r);
+    free(r);
+}
+
+bool act_simulate(const ActFrame *f, size_t n, const ActOptions *o, ActResult *res) {
+    return act_simulate_with(f, n, o, NULL, res);
+}
+
+bool act_simulate_with(const ActFrame *f, size_t n, const ActOptions *o, const ActRun *base,
+                       ActResult *res) {
+    memset(res, 0, sizeof(*res));
+    Run adaptive, own;
+    run_init(&adaptive);
+    run_init(&own);
+    Episode *ep = NULL;
+    size_t n_ep = 0, cap_ep = 0;
+
+    bool ok = run_frames(&adaptive, f, n, o, true);
+    if (ok && !base) {
+        ok = run_frames(&own, f, n, o, false);
+        base = &own;
+    }
+    const Run *run[2] = { &adaptive, base };     /* base is NULL if !ok */
+
+    size_t strafe_at[2] = { 0, 0 };
+    for (size_t i = 0; i < n && ok; i++) {
+        for (int axis = 0; axis < 2; axis++) {
+            uint8_t st = state_of(&f[i], axis);
+            uint8_t prev = i > 0 ? state_of(&f[i - 1], axis) : AS_IDLE;
+            if (st == prev) continue;
+            if (st == AS_STRAFE_POS || st == AS_STRAFE_NEG) strafe_at[axis] = i;
+            if ((st == AS_COUNTER_POS || st == AS_COUNTER_NEG) &&
+                (prev == AS_STRAFE_POS || prev == AS_STRAFE_NEG)) {
+                if (n_ep == cap_ep) {
+                    size_t cap = cap_ep ? cap_ep * 2 : 256;
+                    Episode *ne = realloc(ep, cap * sizeof(*ne));
+                    if (!ne) { ok = false; break; }
+                    ep = ne;
+                    cap_ep = cap;
+                }
+                ep[n_ep++] = (Episode){ (uint8_t)axis, st == AS_COUNTER_POS,
+                                        strafe_at[axis], i };
+            }
+        }
+    }
+
+    if (ok && n_ep) {
+        res->strafes = malloc(n_ep * sizeof(ActStrafe));
+        ok = res->strafes != NULL;
+    }
+    for (size_t e = 0; ok && e < n_ep; e++) {
+        const Episode *x = &ep[e];
+        int held = AXIS_KEY[x->axis][!x->dir], counter = AXIS_KEY[x->axis][x->dir];
+
+        /* The held key's final lift starts at its last deepest point; an RT
+         * wobble release before that is not the release that stops the strafe */
+        size_t peak = x->i_strafe;
+        for (size_t i = x->i_strafe; i <= x->i_counter; i++)
+            if (f[i].depth[held] >= f[peak].depth[held]) peak = i;
+
+        double from = f[x->i_strafe].t_ms, to = f[x->i_counter].t_ms + ACT_WINDOW_MS;
+        double rel[2], prs[2], sh[2];
+        bool found = true;
+        for (int s = 0; s < 2; s++) {
+            rel[s] = edges_first(&run[s]->edges[held], f[peak].t_ms, to, -1);
+            prs[s] = edges_first(&run[s]->edges[counter], from, to, 1);
+            found &= !isnan(rel[s]) && !isnan(prs[s]);
+            sh[s] = isnan(rel[s]) ? NAN : run_shootable_at(run[s], x->axis, rel[s]);
+        }
+        if (!found) {
+            res->skipped++;
+            continue;
+        }
+        res->strafes[res->count++] = (ActStrafe){
+            .axis = x->axis,
+            .dir = x->dir,
+            .t_ms = f[x->i_counter].t_ms,
+            .release_ms = (float)(rel[1] - rel[0]),
+            .press_ms = (float)(prs[1] - prs[0]),
+            .shootable_ms = (isnan(sh[0]) || isnan(sh[1])) ? NAN : (float)(sh[1] - sh[0]),
+        };
+    }
+
+    if (ok) {
+        res->presses[0] = run[0]->presses;
+        res->presses[1] = run[1]->presses;
+        for (int k = 0; k < ACT_KEYS; k++)
+            res->ghost_presses += count_ghosts(&run[0]->edges[k], &run[1]->edges[k]);
+    }
+
+    free(ep);
+    run_free(&adaptive);
+    run_free(&own);
+    if (!ok) act_result_free(res);
+    return ok;
+}
+
+void act_result_free(ActResult *r) {
+    free(r->strafes);
+    r->strafes = NULL;
+    r->count = 0;
+}
+
+/* ---------- summary ---------- */
+
+static int cmp_float(const void *a, const void *b) {
+    float x = *(const float *)a, y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+static void stat_of(float *v, size_t n, ActStat *s) {
+    memset(s, 0, sizeof(*s));
+    s->n = n;
+    if (!n) return;
+    qsort(v, n, sizeof(float), cmp_float);
+    double sum = 0;
+    for (size_t i = 0; i < n; i++) sum += v[i];
+    s->mean = (float)(sum / (double)n);
+    s->p50 = v[(size_t)((double)(n - 1) * 0.50 + 0.5)];
+    s->p90 = v[(size_t)((double)(n - 1) * 0.90 + 0.5)];
+    s->min = v[0];
+    s->max = v[n - 1];
+}
+
+void act_summarize(const ActResult *r, ActSummary *s) {
+    memset(s, 0, sizeof(*s));
+    float *v = malloc((r->count ? r->count : 1) * sizeof(float));
+    if (!v) return;
+
+    size_t n = 0;
+    for (size_t i = 0; i < r->count; i++) v[n++] = r->strafes[i].release_ms;
+    stat_of(v, n, &s->release);
+
+    n = 0;
+    for (size_t i = 0; i < r->count; i++) v[n++] = r->strafes[i].press_ms;
+    stat_of(v, n, &s->press);
+
+    n = 0;
+    for (size_t i = 0; i < r->count; i++)
+        if (!isnan(r->strafes[i].shootable_ms)) v[n++] = r->strafes[i].shootable_ms;
+    stat_of(v, n, &s->shootable);
+    free(v);
+}
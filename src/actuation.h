@@ -0,0 +1,109 @@
+/*
+ * actuation.h - Offline model of Wooting actuation and rapid trigger
+ *
+ * Replays recorded analog depths against the AP/RT that was on the
+ * keyboard and yields the press/release edges the firmware would have
+ * sent, then does the same with a static profile. For each counter-strafe
+ * it reports how much earlier the held key let go, the counter key went
+ * down and, through the CS2 movement model, the player was shootable.
+ *
+ * Key model, per key (depths in mm from the top):
+ *   released, outside RT zone:  press when depth >= AP
+ *   pressed:                    release when depth < AP (RT zone ends), or
+ *                               when it rose RT above its deepest point
+ *   released, inside RT zone:   press when it sank RT below its highest point
+ *
+ * Kept free of SDK/HID/OS dependencies so the simulator tool, the sweep
+ * and the unit tests share it.
+ */
+
+#ifndef ACTUATION_H
+#define ACTUATION_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define ACT_KEYS       4        /* W, A, S, D: the keys a trace records */
+#define ACT_TRAVEL_MM  4.0f     /* analog 1.0 = full travel */
+#define ACT_WINDOW_MS  500.0    /* counter-strafe edges are searched this long after it starts */
+
+typedef struct {
+    bool  pressed;
+    bool  rt_zone;              /* actuated since the key last rose above AP */
+    float extreme;              /* deepest point while pressed, highest while released in the zone */
+} ActKey;
+
+void act_key_reset(ActKey *k);
+
+/* One depth sample. Returns +1 on press, -1 on release, 0 otherwise. */
+int act_key_step(ActKey *k, float depth_mm, float ap_mm, float rt_mm);
+
+/* One recorded frame, in the tool's own compact form */
+typedef struct {
+    double  t_ms;               /* since the start of the trace */
+    float   depth[ACT_KEYS];    /* analog 0-1, W A S D */
+    float   ap[ACT_KEYS];       /* AP/RT the engine had on the keyboard (mm) */
+    float   rt[ACT_KEYS];
+    float   max_speed;          /* weapon max speed (u/s) */
+    uint8_t h_state, v_state;   /* AxisState as recorded */
+} ActFrame;
+
+typedef struct {
+    float base_ap, base_rt;     /* static profile compared against (mm) */
+    float write_latency_ms;     /* frame -> firmware delay for the engine's AP/RT */
+} ActOptions;
+
+typedef struct {
+    uint8_t axis;               /* 0 = H (A/D), 1 = V (S/W) */
+    uint8_t dir;                /* counter key: 0 = negative (A/S), 1 = positive (D/W) */
+    double  t_ms;               /* counter-strafe start */
+    float   release_ms;         /* held key released earlier by (static - adaptive) */
+    float   press_ms;           /* counter key pressed earlier by */
+    float   shootable_ms;       /* below 34% speed earlier by; NAN if a run never got there */
+} ActStrafe;
+
+typedef struct {
+    ActStrafe *strafes;         /* malloc'd, act_result_free() */
+    size_t count;
+    size_t skipped;             /* a run never released or never pressed in the window */
+    uint64_t presses[2];        /* [0] adaptive, [1] static */
+    uint64_t ghost_presses;     /* adaptive presses the static profile never made */
+} ActResult;
+
+/*
+ * Simulate both profiles over n frames (time order) and match their
+ * edges per counter-strafe. Returns false, with r empty, on allocation
+ * failure or frames out of time order.
+ */
+bool act_simulate(const ActFrame *f, size_t n, const ActOptions *o, ActResult *r);
+
+void act_result_free(ActResult *r);
+
+/*
+ * The static run depends only on the depths and the static profile, so a
+ * caller replaying many AP/RT streams over one trace computes it once.
+ * Read-only once built: threads may share it.
+ */
+typedef struct ActRun ActRun;
+
+ActRun *act_run_static(const ActFrame *f, size_t n, const ActOptions *o);   /* NULL: as above */
+void act_run_free(ActRun *r);
+
+/* act_simulate() against a prebuilt static run (NULL = build it here). */
+bool act_simulate_with(const ActFrame *f, size_t n, const ActOptions *o, const ActRun *base,
+                       ActResult *r);
+
+typedef struct {
+    size_t n;
+    float mean, p50, p90, min, max;
+} ActStat;
+
+typedef struct {
+    ActStat release, press, shootable;
+} ActSummary;
+
+/* Distribution of each gain over a result's counter-strafes. */
+void act_summarize(const ActResult *r, ActSummary *s);
+
+#endif /* ACTUATION_H */
@@ -0,0 +1,191 @@
+/*
+ * actuation_sim.c - How much earlier do keys actuate with adaptive AP/RT?
+ *
+ * Replays recorded traces (.watrace, see trace_file.h) through the
+ * firmware actuation model in actuation.c twice: with the AP/RT the engine
+ * had on the keyboard, and with a static profile (ap_normal/rt_normal from
+ * a config, or --ap/--rt). Prints the per-counter-strafe gain distribution:
+ * held key released earlier, counter key pressed earlier, and shootable
+ * (below 34% speed) earlier. --csv prints one line per counter-strafe.
+ *
+ * Usage: actuation-sim [--config FILE] [--ap MM] [--rt MM] [--latency MS]
+ *                      [--csv] trace.watrace ...
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "actuation.h"
+#include "config.h"
+#include "trace_file.h"
+
+#define MAX_TRACES 256
+
+static void usage(void) {
+    printf("Usage: actuation-sim [--config FILE] [--ap MM] [--rt MM] [--latency MS]\n"
+           "                     [--csv] trace.watrace ...\n"
+           "  --config FILE  static profile = ap_normal/rt_normal of this config\n"
+           "  --ap, --rt     static profile AP/RT in mm (default 1.2 / 1.0)\n"
+           "  --latency MS   delay before the engine's AP/RT reaches the firmware\n"
+           "  --csv          one line per counter-strafe instead of the summary\n");
+}
+
+/* Whole trace as ActFrames; time from the first frame */
+static bool load_trace(const char *path, ActFrame **out, size_t *count, uint32_t *lost) {
+    TraceFile t;
+    if (!trace_open(&t, path)) {
+        fprintf(stderr, "Cannot open trace: %s\n", path);
+        return false;
+    }
+
+    size_t n = 0, cap = t.hdr.frames ? (size_t)t.hdr.frames : 4096;
+    ActFrame *f = malloc(cap * sizeof(*f));
+    double tick_ms = 1000.0 / (double)t.hdr.tick_freq;
+    int64_t t0 = 0;
+    TelemetryFrame tf;
+    while (f && trace_read(&t, &tf)) {
+        if (n == cap) {
+            cap *= 2;
+            ActFrame *nf = realloc(f, cap * sizeof(*nf));
+            if (!nf) { free(f); f = NULL; break; }
+            f = nf;
+        }
+        if (n == 0) t0 = tf.ticks;
+        ActFrame *a = &f[n++];
+        a->t_ms = (double)(tf.ticks - t0) * tick_ms;
+        a->depth[0] = tf.w; a->depth[1] = tf.a; a->depth[2] = tf.s; a->depth[3] = tf.d;
+        memcpy(a->ap, tf.ap, sizeof(a->ap));
+        memcpy(a->rt, tf.rt, sizeof(a->rt));
+        a->max_speed = tf.vel_threshold > 0 ? tf.vel_threshold / 0.34f : 225.0f;
+        a->h_state = tf.h_state;
+        a->v_state = tf.v_state;
+    }
+    *lost = t.hdr.lost;
+    trace_close(&t);
+    if (!f) {
+        fprintf(stderr, "Out of memory reading %s\n", path);
+        return false;
+    }
+    *out = f;
+    *count = n;
+    return true;
+}
+
+static void print_stat(const char *label, const ActStat *s) {
+    if (!s->n) {
+        printf("%-24s %6d\n", label, 0);
+        return;
+    }
+    printf("%-24s %6zu %+7.1f %+7.1f %+7.1f %+7.1f %+7.1f\n", label, s->n,
+           s->mean, s->p50, s->p90, s->min, s->max);
+}
+
+int main(int argc, char *argv[]) {
+    Config cfg;
+    config_defaults(&cfg);
+    ActOptions opt = { cfg.ap_normal, cfg.rt_normal, 0.0f };
+    float ap = -1.0f, rt = -1.0f;
+    bool csv = false;
+    const char *paths[MAX_TRACES];
+    int num_paths = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--config") == 0 && i + 1 < argc) {
+            const char *path = argv[++i];
+            FILE *probe = fopen(path, "rb");
+            if (!probe) { fprintf(stderr, "Cannot open config: %s\n", path); return 1; }
+            fclose(probe);
+            if (config_parse_file(&cfg, path, NULL) != 0) return 1;
+            opt.base_ap = cfg.ap_normal;
+            opt.base_rt = cfg.rt_normal;
+        } else if (strcmp(argv[i], "--ap") == 0 && i + 1 < argc) ap = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--rt") == 0 && i + 1 < argc) rt = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--latency") == 0 && i + 1 < argc)
+            opt.write_latency_ms = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--csv") == 0) csv = true;
+        else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) { usage(); return 0; }
+        else if (argv[i][0] == '-') { usage(); return 1; }
+        else if (num_paths < MAX_TRACES) paths[num_paths++] = argv[i];
+    }
+    if (ap >= 0.0f) opt.base_ap = ap;
+    if (rt >= 0.0f) opt.base_rt = rt;
+    if (num_paths == 0 || opt.base_ap < 0.1f || opt.base_ap > 4.0f ||
+        opt.base_rt < 0.0f || opt.base_rt > 4.0f || opt.write_latency_ms < 0.0f) {
+        usage();
+        return 1;
+    }
+
+    /* Each trace on its own time base; strafes pooled for the summary */
+    ActResult all = { 0 };
+    size_t frames = 0;
+    double minutes = 0;
+    uint64_t lost_total = 0;
+    size_t h_count = 0;
+    if (csv) printf("trace,axis,counter_key,t_s,release_ms,press_ms,shootable_ms\n");
+
+    for (int p = 0; p < num_paths; p++) {
+        ActFrame *f;
+        size_t n;
+        uint32_t lost;
+        if (!load_trace(paths[p], &f, &n, &lost)) return 1;
+        frames += n;
+        lost_total += lost;
+        if (n) minutes += f[n - 1].t_ms / 60000.0;
+
+        ActResult r;
+        if (!act_simulate(f, n, &opt, &r)) {
+            fprintf(stderr, "Cannot simulate %s: out of memory or frames out of order\n",
+                    paths[p]);
+            return 1;
+        }
+        free(f);
+
+        ActStrafe *grown = realloc(all.strafes, (all.count + r.count + 1) * sizeof(ActStrafe));
+        if (!grown) {
+            fprintf(stderr, "Out of memory\n");
+            return 1;
+        }
+        all.strafes = grown;
+        for (size_t i = 0; i < r.count; i++) {
+            const ActStrafe *s = &r.strafes[i];
+            static const char keys[2][2] = { { 'A', 'D' }, { 'S', 'W' } };
+            if (s->axis == 0) h_count++;
+            if (csv)
+                printf("%s,%s,%c,%.3f,%.2f,%.2f,%.2f\n", paths[p], s->axis ? "V" : "H",
+                       keys[s->axis][s->dir], s->t_ms / 1000.0, s->release_ms, s->press_ms,
+                       s->shootable_ms);
+            all.strafes[all.count++] = *s;
+        }
+        all.skipped += r.skipped;
+        all.presses[0] += r.presses[0];
+        all.presses[1] += r.presses[1];
+        all.ghost_presses += r.ghost_presses;
+        act_result_free(&r);
+    }
+    if (csv) {
+        act_result_free(&all);
+        return 0;
+    }
+
+    ActSummary sum;
+    act_summarize(&all, &sum);
+
+    printf("Traces: %d, %zu frames, %.1f min", num_paths, frames, minutes);
+    if (lost_total) printf(" (%llu frames lost while recording)", (unsigned long long)lost_total);
+    printf("\nStatic profile: AP %.2f mm  RT %.2f mm   write latency %.1f ms\n\n",
+           opt.base_ap, opt.base_rt, opt.write_latency_ms);
+    printf("Counter-strafes: %zu (H %zu, V %zu), %zu skipped\n", all.count, h_count,
+           all.count - h_count, all.skipped);
+    printf("%-24s %6s %7s %7s %7s %7s %7s\n", "earlier by (ms)", "n", "mean", "p50", "p90",
+           "min", "max");
+    print_stat("held key released", &sum.release);
+    print_stat("counter key pressed", &sum.press);
+    print_stat("shootable", &sum.shootable);
+    printf("\nPresses: adaptive %llu, static %llu; %llu only with adaptive (ghost risk)\n",
+           (unsigned long long)all.presses[0], (unsigned long long)all.presses[1],
+           (unsigned long long)all.ghost_presses);
+
+    act_result_free(&all);
+    return 0;
+}
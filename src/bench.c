@@ -0,0 +1,360 @@
+/*
+ * bench.c - Microbenchmarks for the sampling loop's hot-path functions
+ *
+ * Compiles main.c and hid_writer.c into this file (main renamed), so the
+ * benchmarks time the real static functions rather than copies. Each one
+ * is warmed up, calibrated to a batch of calls long enough for the clock,
+ * then timed over --reps batches. Reported per call: median and MAD
+ * (median absolute deviation), both robust to the odd preempted batch.
+ *
+ * --json prints the results one per line, for saving per commit.
+ * --baseline FILE compares against such a file and exits with 2 when a
+ * median got slower by more than 3 MADs and 5%.
+ *
+ * Usage: bench [--reps N] [--filter SUBSTR] [--json] [--baseline FILE]
+ */
+
+#define main wooting_aim_main
+#include "main.c"
+#undef main
+#include "hid_writer.c"
+
+#define BENCH_WARMUP_MS      20
+#define BENCH_MIN_BATCH_NS   200000.0   /* ~0.2 ms per timed batch */
+#define BENCH_MAX_REPS       1001
+#define BENCH_MAX_RESULTS    32
+#define BENCH_CFG_PATH       "bench-config.tmp"
+
+static volatile float g_sink;           /* keeps results observable */
+static double g_freq;
+
+/* ---------- benchmarks ---------- */
+
+/* One D strafe, A counter-strafe, release: 32 frames of analog depth */
+#define PATTERN_LEN 32
+static float g_pat_pos[PATTERN_LEN], g_pat_neg[PATTERN_LEN];
+
+static void pattern_init(void) {
+    for (int i = 0; i < PATTERN_LEN; i++) {
+        g_pat_pos[i] = i < 12 ? (float)i / 12.0f : i < 16 ? (float)(16 - i) / 4.0f : 0.0f;
+        g_pat_neg[i] = i >= 14 && i < 28 ? (float)(i - 13) / 14.0f : 0.0f;
+    }
+}
+
+static void bench_axis_update(uint32_t n) {
+    static Axis ax;
+    static int64_t now;
+    int64_t step = (int64_t)(g_freq / 8000.0);     /* 8 kHz polling */
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t k = i % PATTERN_LEN, p = (i - 1) % PATTERN_LEN;
+        now += step;
+        axis_update(&ax, g_cfg, g_pat_pos[k], g_pat_neg[k], g_pat_pos[p], g_pat_neg[p], now,
+                    g_freq);
+    }
+    g_sink = (float)ax.state;
+}
+
+static AimContext g_bctx;
+
+static void bench_update_targets(uint32_t n) {
+    static const AxisState states[] = { S_IDLE, S_STRAFE_POS, S_COUNTER_NEG, S_STRAFE_NEG,
+                                        S_COUNTER_POS };
+    for (uint32_t i = 0; i < n; i++) {
+        g_bctx.h.state = states[i % 5];
+        g_bctx.v.state = states[(i / 5) % 5];
+        g_bctx.h.counter_ms = (double)(i % 250);
+        g_bctx.vel_h.vel = (float)(i % 230);
+        gsi_snapshot(&g_bctx);      /* session_frame takes it right before */
+        update_targets(&g_bctx, g_cfg);
+    }
+    g_sink = g_bctx.target_ap[K_A];
+}
+
+static void bench_vel_update(uint32_t n) {
+    static VelEstimator ve;
+    static int64_t now;
+    int64_t step = (int64_t)(g_freq / 1000.0);     /* 1 kHz sampling */
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t k = i % PATTERN_LEN;
+        now += step;
+        vel_update(&ve, g_pat_pos[k], g_pat_neg[k], 225.0f, now, g_freq);
+    }
+    g_sink = ve.vel;
+}
+
+static void bench_phase_decay_ap(uint32_t n) {
+    float acc = 0;
+    for (uint32_t i = 0; i < n; i++) acc += phase_decay_ap(g_cfg, 0.4f, (double)(i % 256));
+    g_sink = acc;
+}
+
+static void bench_vel_scale_ap(uint32_t n) {
+    float acc = 0;
+    for (uint32_t i = 0; i < n; i++) acc += vel_scale_ap(0.4f, (float)(i % 128) / 127.0f);
+    g_sink = acc;
+}
+
+static void bench_weapon_max_speed(uint32_t n) {
+    /* Early, middle, late and no match in the strstr chain */
+    static const char *names[] = { "weapon_knife", "weapon_ak47", "weapon_glock",
+                                   "weapon_xm1014", "weapon_taser", "" };
+    float acc = 0;
+    for (uint32_t i = 0; i < n; i++) acc += weapon_max_speed(names[i % 6]);
+    g_sink = acc;
+}
+
+static void bench_build_partial_proto(uint32_t n) {
+    KeySetting keys[] = {
+        { KEY_W_ROW, KEY_W_COL, 0.4f }, { KEY_A_ROW, KEY_A_COL, 0.15f },
+        { KEY_S_ROW, KEY_S_COL, 1.2f }, { KEY_D_ROW, KEY_D_COL, 0.8f },
+    };
+    uint8_t buf[64];
+    int acc = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        keys[i & 3].mm = (float)(i % 40) * 0.1f;
+        acc += build_partial_proto(buf, sizeof(buf), keys, 4);
+    }
+    g_sink = (float)acc;
+}
+
+/* Full-keyboard mode: every key of the 60HE in one batch (report 3) */
+static void bench_build_partial_proto_61(uint32_t n) {
+    KeySetting keys[WOOTING_MAX_KEYS];
+    for (int k = 0; k < WOOTING_MAX_KEYS; k++)
+        keys[k] = (KeySetting){ KEY_MATRIX[k].row, KEY_MATRIX[k].col, 1.2f };
+    uint8_t buf[512];
+    int acc = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        keys[i % WOOTING_MAX_KEYS].mm = (float)(i % 40) * 0.1f;
+        acc += build_partial_proto(buf, sizeof(buf), keys, WOOTING_MAX_KEYS);
+    }
+    g_sink = (float)acc;
+}
+
+static void bench_encode_varint(uint32_t n) {
+    uint8_t buf[8];
+    int acc = 0;
+    for (uint32_t i = 0; i < n; i++) acc += encode_varint(buf, i * 2654435761u >> (i & 31));
+    g_sink = (float)acc;
+}
+
+/* Trimmed CS2 GSI payload: provider, map, round, player with weapons */
+static const char g_gsi_payload[] =
+    "{\n"
+    " \"provider\": { \"name\": \"Counter-Strike: Global Offensive\", \"appid\": 730,"
+    " \"version\": 14000, \"steamid\": \"76561198000000000\", \"timestamp\": 1700000000 },\n"
+    " \"map\": { \"mode\": \"competitive\", \"name\": \"de_mirage\", \"phase\": \"live\","
+    " \"round\": 7, \"team_ct\": { \"score\": 4 }, \"team_t\": { \"score\": 2 } },\n"
+    " \"round\": { \"phase\": \"live\" },\n"
+    " \"player\": { \"steamid\": \"76561198000000000\", \"name\": \"player\", \"team\": \"CT\",\n"
+    "  \"activity\": \"playing\",\n"
+    "  \"state\": { \"health\": 100, \"armor\": 100, \"helmet\": true, \"flashed\": 0,"
+    " \"smoked\": 0, \"burning\": 0, \"money\": 3250, \"round_kills\": 1,"
+    " \"round_killhs\": 1, \"equip_value\": 4700 },\n"
+    "  \"weapons\": {\n"
+    "   \"weapon_0\": { \"name\": \"weapon_knife\", \"paintkit\": \"default\","
+    " \"type\": \"Knife\", \"state\": \"holstered\" },\n"
+    "   \"weapon_1\": { \"name\": \"weapon_hkp2000\", \"paintkit\": \"default\","
+    " \"type\": \"Pistol\", \"ammo_clip\": 13, \"ammo_clip_max\": 13,"
+    " \"ammo_reserve\": 52, \"state\": \"holstered\" },\n"
+    "   \"weapon_2\": { \"name\": \"weapon_m4a1_silencer\", \"paintkit\": \"default\","
+    " \"type\": \"Rifle\", \"ammo_clip\": 17, \"ammo_clip_max\": 20,"
+    " \"ammo_reserve\": 80, \"state\": \"active\" }\n"
+    "  }\n"
+    " }\n"
+    "}\n";
+
+static void bench_parse_gsi_json(uint32_t n) {
+    for (uint32_t i = 0; i < n; i++)
+        parse_gsi_json(g_gsi_payload, (int)sizeof(g_gsi_payload) - 1);
+    g_sink = g_gsi.weapon_speed;
+}
+
+/* Every key at its default plus a profile, like an edited user config.
+ * Written here rather than by config_write_defaults, which prints. */
+static bool write_bench_config(void) {
+    FILE *f = fopen(BENCH_CFG_PATH, "w");
+    if (!f) return false;
+    Config c;
+    config_defaults(&c);
+    for (int i = 0; i < config_schema_count; i++) {
+        char val[CFG_VALUE_MAX];
+        config_format(&c, &config_schema[i], val, sizeof(val));
+        fprintf(f, "%s=%s\n", config_schema[i].key, val);
+    }
+    fprintf(f, "\n[profile.retake]\nap_aggro=0.3\n[profile.retake.weapon.awp]\nap=0.6\n");
+    fclose(f);
+    return true;
+}
+
+/* config_load's parse + compile, without its console line */
+static void bench_config_load(uint32_t n) {
+    static Config c;
+    for (uint32_t i = 0; i < n; i++) config_build(BENCH_CFG_PATH, &c);
+    g_sink = c.ap_normal;
+}
+
+typedef struct {
+    const char *name;
+    void (*run)(uint32_t n);
+} Bench;
+
+static const Bench g_benches[] = {
+    { "axis_update",         bench_axis_update },
+    { "update_targets",      bench_update_targets },
+    { "vel_update",          bench_vel_update },
+    { "phase_decay_ap",      bench_phase_decay_ap },
+    { "vel_scale_ap",        bench_vel_scale_ap },
+    { "weapon_max_speed",    bench_weapon_max_speed },
+    { "build_partial_proto", bench_build_partial_proto },
+    { "build_partial_proto_61", bench_build_partial_proto_61 },
+    { "encode_varint",       bench_encode_varint },
+    { "parse_gsi_json",      bench_parse_gsi_json },
+    { "config_load",         bench_config_load },
+};
+
+/* ---------- harness ---------- */
+
+typedef struct {
+    char name[64];
+    double median_ns, mad_ns;
+    uint32_t batch;
+} Result;
+
+static double batch_ns(const Bench *b, uint32_t n) {
+    int64_t t0 = plat_ticks();
+    b->run(n);
+    return (double)(plat_ticks() - t0) * 1e9 / g_freq;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double median(double *v, int n) {
+    qsort(v, (size_t)n, sizeof(double), cmp_double);
+    return n & 1 ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) * 0.5;
+}
+
+static void run_bench(const Bench *b, int reps, Result *r) {
+    /* Size the batch, then warm caches and branch predictors with it */
+    uint32_t batch = 1;
+    while (batch < (1u << 30) && batch_ns(b, batch) < BENCH_MIN_BATCH_NS) batch *= 2;
+    int64_t until = plat_ticks() + (int64_t)(g_freq * BENCH_WARMUP_MS / 1000.0);
+    while (plat_ticks() < until) b->run(batch);
+
+    double per_call[BENCH_MAX_REPS], dev[BENCH_MAX_REPS];
+    for (int i = 0; i < reps; i++) per_call[i] = batch_ns(b, batch) / batch;
+
+    double med = median(per_call, reps);
+    for (int i = 0; i < reps; i++) dev[i] = fabs(per_call[i] - med);
+
+    snprintf(r->name, sizeof(r->name), "%s", b->name);
+    r->median_ns = med;
+    r->mad_ns = median(dev, reps);
+    r->batch = batch;
+}
+
+/* Results from an earlier --json run, or -1 */
+static int load_baseline(const char *path, Result *base, int max) {
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+    int n = 0;
+    char line[256];
+    while (n < max && fgets(line, sizeof(line), f)) {
+        Result *r = &base[n];
+        if (sscanf(line, " {\"name\": \"%63[^\"]\", \"median_ns\": %lf, \"mad_ns\": %lf",
+                   r->name, &r->median_ns, &r->mad_ns) == 3)
+            n++;
+    }
+    fclose(f);
+    return n;
+}
+
+static const Result *find_result(const Result *v, int n, const char *name) {
+    for (int i = 0; i < n; i++)
+        if (strcmp(v[i].name, name) == 0) return &v[i];
+    return NULL;
+}
+
+static bool regressed(const Result *old, const Result *now) {
+    double d = now->median_ns - old->median_ns;
+    return d > 3.0 * (old->mad_ns + now->mad_ns) && d > 0.05 * old->median_ns;
+}
+
+int main(int argc, char *argv[]) {
+    int reps = 51;
+    bool json = false;
+    const char *filter = NULL, *baseline = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0) json = true;
+        else if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc) reps = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) filter = argv[++i];
+        else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) baseline = argv[++i];
+        else {
+            printf("Usage: bench [--reps N] [--filter SUBSTR] [--json] [--baseline FILE]\n");
+            return strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+    if (reps < 5) reps = 5;
+    if (reps > BENCH_MAX_REPS) reps = BENCH_MAX_REPS;
+
+    Result base[BENCH_MAX_RESULTS];
+    int num_base = 0;
+    if (baseline && (num_base = load_baseline(baseline, base, BENCH_MAX_RESULTS)) < 0) {
+        fprintf(stderr, "Cannot read baseline: %s\n", baseline);
+        return 1;
+    }
+
+    /* Same state the sampler sees: default config, GSI with a rifle */
+    g_freq = (double)plat_tick_freq();
+    config_defaults(&cfg_boot);
+    config_compile(&cfg_boot, g_freq);
+    if (!write_bench_config()) {
+        fprintf(stderr, "Cannot write %s\n", BENCH_CFG_PATH);
+        return 1;
+    }
+    plat_mutex_init(&g_gsi.lock);
+    parse_gsi_json(g_gsi_payload, (int)sizeof(g_gsi_payload) - 1);
+    pattern_init();
+    plat_timer_resolution_begin();
+
+    Result res[BENCH_MAX_RESULTS];
+    int n = 0;
+    for (size_t i = 0; i < sizeof(g_benches) / sizeof(g_benches[0]); i++) {
+        if (filter && !strstr(g_benches[i].name, filter)) continue;
+        run_bench(&g_benches[i], reps, &res[n++]);
+    }
+    remove(BENCH_CFG_PATH);
+    plat_timer_resolution_end();
+
+    int slower = 0;
+    if (json) {
+        printf("{\n  \"bench\": \"wooting-aim\",\n  \"reps\": %d,\n  \"results\": [\n", reps);
+        for (int i = 0; i < n; i++)
+            printf("    {\"name\": \"%s\", \"median_ns\": %.3f, \"mad_ns\": %.3f, \"batch\": %u}%s\n",
+                   res[i].name, res[i].median_ns, res[i].mad_ns, res[i].batch,
+                   i + 1 < n ? "," : "");
+        printf("  ]\n}\n");
+    } else {
+        printf("%-20s %12s %10s %10s%s\n", "benchmark", "median ns", "MAD ns", "batch",
+               baseline ? "   vs baseline" : "");
+    }
+    for (int i = 0; i < n; i++) {
+        const Result *old = find_result(base, num_base, res[i].name);
+        bool bad = old && regressed(old, &res[i]);
+        slower += bad;
+        if (json) continue;
+        printf("%-20s %12.2f %10.2f %10u", res[i].name, res[i].median_ns, res[i].mad_ns,
+               res[i].batch);
+        if (old)
+            printf("   %+6.1f%%%s", (res[i].median_ns / old->median_ns - 1.0) * 100.0,
+                   bad ? "  SLOWER" : "");
+        printf("\n");
+    }
+    if (baseline)
+        fprintf(json ? stderr : stdout, "%d of %d slower than %s\n", slower, n, baseline);
+    return slower ? 2 : 0;
+}
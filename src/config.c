@@ -0,0 +1,624 @@
+/*
+ * config.c - Schema table, parser and compiler for wooting-aim.cfg
+ *
+ * Kept free of SDK/HID/Win32 dependencies so it can be unit-tested.
+ */
+
+#include "config.h"
+#include <ctype.h>
+#include <errno.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+const char *const wcat_names[WCAT_COUNT] = {
+    "RIFLE", "AWP", "PISTOL", "SMG", "KNIFE", "OTHER"
+};
+
+#define OFF(field) ((uint16_t)offsetof(Config, field))
+#define MM(key, field, def, grp, help) \
+    { key, CFG_FLOAT, OFF(field), 0, 0.1f, 4.0f, def, grp, help }
+#define FLAG(key, field, def, grp, help) \
+    { key, CFG_BOOL, OFF(field), 0, 0, 1, def, grp, help }
+#define KEY(key, field, def, grp, help) \
+    { key, CFG_KEY, OFF(field), CFG_RESTART, 0, 255, def, grp, help }
+
+const CfgField config_schema[] = {
+    MM("ap_normal", ap_normal, 1.2f, "Base settings (used when GSI not connected)",
+       "Normal actuation point (mm)"),
+    MM("ap_aggro",  ap_aggro,  0.4f, NULL, "Aggressive AP during counter-strafe (mm)"),
+    MM("rt_normal", rt_normal, 1.0f, NULL, "Normal rapid trigger (mm)"),
+    MM("rt_aggro",  rt_aggro,  0.1f, NULL, "Aggressive RT during counter-strafe (mm)"),
+    { "write_interval_ms", CFG_FLOAT, OFF(write_interval_ms), 0, 0, 1000, 50,
+      NULL, "Min time between HID writes" },
+    { "predict_threshold", CFG_FLOAT, OFF(predict_threshold), 0, 0.05f, 0.99f, 0.70f,
+      NULL, "Finger-lift prediction: fraction of peak depth" },
+    { "predict_min_peak", CFG_FLOAT, OFF(predict_min_peak), 0, 0, 1, 0.30f,
+      NULL, "Min peak depth before predicting" },
+    { "crouch_rt_factor", CFG_FLOAT, OFF(crouch_rt_factor), 0, 0.1f, 4, 0.5f,
+      NULL, "RT multiplier while crouching" },
+    FLAG("ws_adaptive", ws_adaptive, 0, NULL, "Also tune W/S"),
+    { "stats_enabled", CFG_BOOL, OFF(stats_enabled), CFG_RESTART, 0, 1, 1,
+      NULL, "Log every counter-strafe to wooting-aim-stats.bin" },
+    { "telemetry_shm", CFG_BOOL, OFF(telemetry_shm), CFG_RESTART, 0, 1, 1,
+      NULL, "Shared-memory telemetry for overlays" },
+    { "profile", CFG_NAME, OFF(profile), 0, 0, 0, 0,
+      NULL, "Active [profile.NAME] section (empty = none)" },
+
+    MM("rifle_ap",  weapon[WCAT_RIFLE].ap,  0.4f,
+       "Weapon profiles (AP/RT when counter-strafing, GSI active)", NULL),
+    MM("rifle_rt",  weapon[WCAT_RIFLE].rt,  0.1f, NULL, NULL),
+    MM("awp_ap",    weapon[WCAT_AWP].ap,    0.8f, NULL, NULL),
+    MM("awp_rt",    weapon[WCAT_AWP].rt,    0.4f, NULL, NULL),
+    MM("pistol_ap", weapon[WCAT_PISTOL].ap, 0.3f, NULL, NULL),
+    MM("pistol_rt", weapon[WCAT_PISTOL].rt, 0.1f, NULL, NULL),
+    MM("smg_ap",    weapon[WCAT_SMG].ap,    0.5f, NULL, NULL),
+    MM("smg_rt",    weapon[WCAT_SMG].rt,    0.2f, NULL, NULL),
+    MM("knife_ap",  weapon[WCAT_KNIFE].ap,  1.5f, NULL, NULL),
+    MM("knife_rt",  weapon[WCAT_KNIFE].rt,  1.0f, NULL, NULL),
+
+    { "gsi_enabled", CFG_BOOL, OFF(gsi_enabled), CFG_RESTART, 0, 1, 1, "GSI settings", NULL },
+    { "gsi_port", CFG_INT, OFF(gsi_port), CFG_RESTART, 1, 65535, 58732, NULL, NULL },
+
+    FLAG("vel_enabled", vel_enabled, 1, "Velocity estimation", NULL),
+
+    { "metrics_enabled", CFG_BOOL, OFF(metrics_enabled), CFG_RESTART, 0, 1, 0,
+      "Prometheus /metrics on 127.0.0.1", NULL },
+    { "metrics_port", CFG_INT, OFF(metrics_port), CFG_RESTART, 1, 65535, 58733, NULL, NULL },
+
+    { "control_enabled", CFG_BOOL, OFF(control_enabled), CFG_RESTART, 0, 1, 1,
+      "Local control channel (named pipe / Unix socket)", NULL },
+
+    { "sampler_cpus", CFG_CPUSET, OFF(sampler_cpus), CFG_RESTART, 0, 0, 0,
+      "Thread placement (CPU lists like 2-3,6; empty = any)",
+      "CPUs for the sampling loop" },
+    { "sampler_priority", CFG_INT, OFF(sampler_priority), CFG_RESTART, 0, 3, 0,
+      NULL, "0 default, 1 above normal, 2 highest, 3 time critical (Linux: nice, SCHED_FIFO with isolate_sampler)" },
+    { "sampler_mmcss", CFG_BOOL, OFF(sampler_mmcss), CFG_RESTART, 0, 1, 0,
+      NULL, "Register the sampling loop with MMCSS as a \"Games\" task" },
+    { "aux_cpus", CFG_CPUSET, OFF(aux_cpus), CFG_RESTART, 0, 0, 0,
+      NULL, "CPUs for GSI, stats writer, renderer, metrics and control threads" },
+    { "isolate_sampler", CFG_BOOL, OFF(isolate_sampler), CFG_RESTART, 0, 1, 0,
+      NULL, "Keep the other threads off sampler_cpus" },
+
+    FLAG("jiggle_enabled",    jiggle_enabled,    1, "v0.7 features", "Jiggle peek detection"),
+    FLAG("vel_scale_enabled", vel_scale_enabled, 1, NULL, "Velocity-aware AP scaling"),
+    FLAG("phase_decay",       phase_decay,       1, NULL, "Counter-strafe phase decay"),
+    { "phase_ultra_ms", CFG_FLOAT, OFF(phase_ultra_ms), 0, 0, 500, 80,
+      NULL, "Phase decay: minimum AP for this long into a counter-strafe" },
+    { "phase_decay_ms", CFG_FLOAT, OFF(phase_decay_ms), 0, 0, 1000, 200,
+      NULL, "Phase decay: back to the weapon AP by this time" },
+    { "poll_rate_hz", CFG_FLOAT, OFF(poll_rate_hz), 0, 0, 100000, 8000,
+      NULL, "Target poll rate, 0 = unlimited (8kHz matches keyboard polling)" },
+
+    { "idle_after_ms", CFG_FLOAT, OFF(idle_after_ms), 0, 0, 600000, 5000,
+      "Idle governor (low-rate sampling while nothing is pressed)",
+      "Go idle after this long without input, 0 = never" },
+    { "idle_poll_hz", CFG_FLOAT, OFF(idle_poll_hz), 0, 10, 1000, 1000,
+      NULL, "Sample rate while idle; a key press wakes within 1/rate" },
+
+    KEY("key_forward", key_forward, 0x1A,
+        "Keys (names: a-z, 0-9, space, lshift, lctrl, semicolon, ...)", "Forward (W/S axis)"),
+    KEY("key_left",    key_left,    0x04, NULL, "Strafe left (A/D axis)"),
+    KEY("key_back",    key_back,    0x16, NULL, NULL),
+    KEY("key_right",   key_right,   0x07, NULL, NULL),
+    KEY("key_crouch",  key_crouch,  0xE0, NULL, "Crouch-peek key"),
+    { "adaptive_keys", CFG_KEYS, OFF(adaptive_keys), CFG_RESTART, 0, 0, 0,
+      NULL, "More keys to tune, e.g. space,lshift,e,q (up to all 61)" },
+    MM("ap_extra", ap_extra, 0.8f, NULL, "AP for adaptive_keys during a round (mm)"),
+    MM("rt_extra", rt_extra, 0.3f, NULL, "RT for adaptive_keys during a round (mm)"),
+};
+const int config_schema_count = (int)(sizeof(config_schema) / sizeof(config_schema[0]));
+
+/* ---------- fields ---------- */
+
+void config_defaults(Config *c) {
+    memset(c, 0, sizeof(*c));
+    for (int i = 0; i < config_schema_count; i++) {
+        const CfgField *f = &config_schema[i];
+        void *p = (char *)c + f->offset;
+        switch (f->type) {
+        case CFG_FLOAT: *(float *)p = f->def; break;
+        case CFG_INT:   *(int *)p = (int)f->def; break;
+        case CFG_BOOL:  *(bool *)p = f->def != 0; break;
+        case CFG_NAME:  ((char *)p)[0] = '\0'; break;
+        case CFG_CPUSET: *(uint64_t *)p = 0; break;
+        case CFG_KEY:   *(uint8_t *)p = (uint8_t)f->def; break;
+        case CFG_KEYS:  ((KeyList *)p)->count = 0; break;
+        }
+    }
+    /* Not configurable: grenades/C4 relax to normal before this is used */
+    c->weapon[WCAT_OTHER].ap = 1.0f;
+    c->weapon[WCAT_OTHER].rt = 0.5f;
+}
+
+const CfgField *config_find(const char *key) {
+    for (int i = 0; i < config_schema_count; i++)
+        if (strcmp(config_schema[i].key, key) == 0) return &config_schema[i];
+    return NULL;
+}
+
+static bool parse_bool(const char *s, bool *out) {
+    static const char *const yes[] = { "1", "true", "on", "yes" };
+    static const char *const no[]  = { "0", "false", "off", "no" };
+    for (int i = 0; i < 4; i++) {
+        if (strcmp(s, yes[i]) == 0) { *out = true;  return true; }
+        if (strcmp(s, no[i]) == 0)  { *out = false; return true; }
+    }
+    return false;
+}
+
+static bool valid_name(const char *s) {
+    if (strlen(s) >= CFG_NAME_LEN) return false;
+    for (; *s; s++)
+        if (!isalnum((unsigned char)*s) && *s != '_' && *s != '-') return false;
+    return true;
+}
+
+/* "0-3,6" -> bits 0..3 and 6. Empty = 0 (any CPU). */
+static bool parse_cpuset(const char *s, uint64_t *out) {
+    uint64_t mask = 0;
+    while (*s) {
+        char *end;
+        unsigned long lo = strtoul(s, &end, 10), hi = lo;
+        if (end == s || !isdigit((unsigned char)*s)) return false;
+        s = end;
+        if (*s == '-') {
+            if (!isdigit((unsigned char)s[1])) return false;
+            hi = strtoul(s + 1, &end, 10);
+            s = end;
+        }
+        if (lo > hi || hi > 63) return false;
+        for (unsigned long i = lo; i <= hi; i++) mask |= 1ull << i;
+        if (*s == ',') s++;
+        else if (*s) return false;
+    }
+    *out = mask;
+    return true;
+}
+
+void config_format_cpuset(uint64_t mask, char *buf, size_t size) {
+    size_t len = 0;
+    buf[0] = '\0';
+    for (int i = 0; i < 64 && len < size; ) {
+        if (!(mask >> i & 1)) { i++; continue; }
+        int j = i;
+        while (j < 63 && (mask >> (j + 1) & 1)) j++;
+        int n = j > i ? snprintf(buf + len, size - len, "%s%d-%d", len ? "," : "", i, j)
+                      : snprintf(buf + len, size - len, "%s%d", len ? "," : "", i);
+        if (n < 0) break;
+        len += (size_t)n;
+        i = j + 1;
+    }
+}
+
+/* Names of the keys on the 60HE matrix, by HID usage */
+static const struct { const char *name; uint8_t usage; } KEY_NAMES[] = {
+    { "esc", 0x29 }, { "1", 0x1E }, { "2", 0x1F }, { "3", 0x20 }, { "4", 0x21 },
+    { "5", 0x22 }, { "6", 0x23 }, { "7", 0x24 }, { "8", 0x25 }, { "9", 0x26 },
+    { "0", 0x27 }, { "minus", 0x2D }, { "equal", 0x2E }, { "backspace", 0x2A },
+    { "tab", 0x2B }, { "q", 0x14 }, { "w", 0x1A }, { "e", 0x08 }, { "r", 0x15 },
+    { "t", 0x17 }, { "y", 0x1C }, { "u", 0x18 }, { "i", 0x0C }, { "o", 0x12 },
+    { "p", 0x13 }, { "lbracket", 0x2F }, { "rbracket", 0x30 }, { "backslash", 0x31 },
+    { "capslock", 0x39 }, { "a", 0x04 }, { "s", 0x16 }, { "d", 0x07 }, { "f", 0x09 },
+    { "g", 0x0A }, { "h", 0x0B }, { "j", 0x0D }, { "k", 0x0E }, { "l", 0x0F },
+    { "semicolon", 0x33 }, { "quote", 0x34 }, { "enter", 0x28 },
+    { "lshift", 0xE1 }, { "z", 0x1D }, { "x", 0x1B }, { "c", 0x06 }, { "v", 0x19 },
+    { "b", 0x05 }, { "n", 0x11 }, { "m", 0x10 }, { "comma", 0x36 }, { "period", 0x37 },
+    { "slash", 0x38 }, { "rshift", 0xE5 },
+    { "lctrl", 0xE0 }, { "lgui", 0xE3 }, { "lalt", 0xE2 }, { "space", 0x2C },
+    { "ralt", 0xE6 }, { "rgui", 0xE7 }, { "menu", 0x65 }, { "rctrl", 0xE4 },
+};
+#define KEY_NAME_COUNT ((int)(sizeof(KEY_NAMES) / sizeof(KEY_NAMES[0])))
+
+int config_key_usage(const char *name) {
+    for (int i = 0; i < KEY_NAME_COUNT; i++)
+        if (strcmp(KEY_NAMES[i].name, name) == 0) return KEY_NAMES[i].usage;
+    return -1;
+}
+
+const char *config_key_name(int usage) {
+    for (int i = 0; i < KEY_NAME_COUNT; i++)
+        if (KEY_NAMES[i].usage == usage) return KEY_NAMES[i].name;
+    return NULL;
+}
+
+/* "space, e,q" -> usages in listed order. Empty = no keys. */
+static bool parse_keys(const char *s, KeyList *out, char *bad, size_t bad_size) {
+    KeyList l = { 0 };
+    while (*s) {
+        while (*s == ' ') s++;
+        size_t n = strcspn(s, ",");
+        char name[16];
+        size_t len = n;
+        while (len > 0 && s[len - 1] == ' ') len--;
+        snprintf(bad, bad_size, "%.*s", (int)len, s);
+        if (len == 0 || len >= sizeof(name)) return false;
+        memcpy(name, s, len);
+        name[len] = '\0';
+
+        int usage = config_key_usage(name);
+        if (usage < 0) return false;
+        for (int i = 0; i < l.count; i++)
+            if (l.usage[i] == usage) return false;
+        if (l.count == CFG_MAX_KEYS) return false;
+        l.usage[l.count++] = (uint8_t)usage;
+
+        s += n;
+        if (*s == ',') s++;
+    }
+    *out = l;
+    return true;
+}
+
+bool config_set(Config *c, const char *key, const char *value, char *err, size_t err_size) {
+    const CfgField *f = config_find(key);
+    if (!f) {
+        snprintf(err, err_size, "unknown key '%s'", key);
+        return false;
+    }
+    void *p = (char *)c + f->offset;
+    char *end;
+
+    switch (f->type) {
+    case CFG_FLOAT: {
+        errno = 0;
+        float v = strtof(value, &end);
+        if (end == value || *end || errno || !isfinite(v)) {
+            snprintf(err, err_size, "%s: '%s' is not a number", key, value);
+            return false;
+        }
+        if (v < f->min || v > f->max) {
+            snprintf(err, err_size, "%s = %g outside %g..%g", key, v, f->min, f->max);
+            return false;
+        }
+        *(float *)p = v;
+        return true;
+    }
+    case CFG_INT: {
+        errno = 0;
+        long v = strtol(value, &end, 10);
+        if (end == value || *end || errno) {
+            snprintf(err, err_size, "%s: '%s' is not an integer", key, value);
+            return false;
+        }
+        if (v < (long)f->min || v > (long)f->max) {
+            snprintf(err, err_size, "%s = %ld outside %.0f..%.0f", key, v, f->min, f->max);
+            return false;
+        }
+        *(int *)p = (int)v;
+        return true;
+    }
+    case CFG_BOOL: {
+        bool v;
+        if (!parse_bool(value, &v)) {
+            snprintf(err, err_size, "%s: '%s' is not a boolean (0/1, true/false, on/off)", key, value);
+            return false;
+        }
+        *(bool *)p = v;
+        return true;
+    }
+    case CFG_NAME:
+        if (!valid_name(value)) {
+            snprintf(err, err_size, "%s: '%s' is not a valid name", key, value);
+            return false;
+        }
+        strcpy((char *)p, value);
+        return true;
+    case CFG_CPUSET:
+        if (!parse_cpuset(value, (uint64_t *)p)) {
+            snprintf(err, err_size, "%s: '%s' is not a CPU list (e.g. 2-3,6; CPUs 0-63)", key, value);
+            return false;
+        }
+        return true;
+    case CFG_KEY: {
+        int usage = config_key_usage(value);
+        if (usage < 0) {
+            snprintf(err, err_size, "%s: unknown key '%s'", key, value);
+            return false;
+        }
+        *(uint8_t *)p = (uint8_t)usage;
+        return true;
+    }
+    case CFG_KEYS: {
+        char bad[32];
+        if (!parse_keys(value, (KeyList *)p, bad, sizeof(bad))) {
+            snprintf(err, err_size, "%s: unknown or repeated key '%s'", key, bad);
+            return false;
+        }
+        return true;
+    }
+    }
+    return false;
+}
+
+void config_format(const Config *c, const CfgField *f, char *buf, size_t size) {
+    const void *p = (const char *)c + f->offset;
+    switch (f->type) {
+    case CFG_FLOAT: snprintf(buf, size, "%g", *(const float *)p); break;
+    case CFG_INT:   snprintf(buf, size, "%d", *(const int *)p); break;
+    case CFG_BOOL:  snprintf(buf, size, "%d", *(const bool *)p ? 1 : 0); break;
+    case CFG_NAME:  snprintf(buf, size, "%s", (const char *)p); break;
+    case CFG_CPUSET: config_format_cpuset(*(const uint64_t *)p, buf, size); break;
+    case CFG_KEY: {
+        const char *name = config_key_name(*(const uint8_t *)p);
+        snprintf(buf, size, "%s", name ? name : "");
+        break;
+    }
+    case CFG_KEYS: {
+        const KeyList *l = p;
+        size_t len = 0;
+        buf[0] = '\0';
+        for (int i = 0; i < l->count && len < size; i++) {
+            int n = snprintf(buf + len, size - len, "%s%s", i ? "," : "",
+                             config_key_name(l->usage[i]));
+            if (n < 0) break;
+            len += (size_t)n;
+        }
+        break;
+    }
+    }
+}
+
+/* ---------- parser ---------- */
+
+static char *trim(char *s) {
+    while (isspace((unsigned char)*s)) s++;
+    char *e = s + strlen(s);
+    while (e > s && isspace((unsigned char)e[-1])) *--e = '\0';
+    return s;
+}
+
+/* "awp" -> WCAT_AWP, or -1 */
+static int weapon_section(const char *name) {
+    for (int i = 0; i < WCAT_COUNT; i++) {
+        if (i == WCAT_OTHER) continue;
+        const char *w = wcat_names[i];
+        size_t n = strlen(w);
+        if (strlen(name) != n) continue;
+        size_t j = 0;
+        while (j < n && tolower((unsigned char)name[j]) == tolower((unsigned char)w[j])) j++;
+        if (j == n) return i;
+    }
+    return -1;
+}
+
+typedef struct {
+    bool in_profile;             /* inside any [profile.*] */
+    bool active;                 /* values land in the real config */
+    int  weapon;                 /* -1, or WCAT_* for [..weapon.X] sections */
+    bool skip;                   /* header was rejected: ignore its body */
+} Section;
+
+/* Parse "[...]" contents. Returns false with err set on an unknown form. */
+static bool parse_section(Config *c, char *name, const char *want, bool *found,
+                          Section *sec, char *err, size_t err_size) {
+    sec->in_profile = false;
+    sec->active = true;
+    sec->weapon = -1;
+    sec->skip = true;
+
+    char *weapon = NULL;
+    if (strncmp(name, "profile.", 8) == 0) {
+        char *pname = name + 8;
+        char *dot = strstr(pname, ".weapon.");
+        if (dot) { *dot = '\0'; weapon = dot + 8; }
+        if (!valid_name(pname) || !pname[0]) {
+            snprintf(err, err_size, "bad profile name '%s'", pname);
+            return false;
+        }
+        sec->in_profile = true;
+        sec->active = want && strcmp(pname, want) == 0;
+        if (sec->active) *found = true;
+
+        bool known = false;
+        for (int i = 0; i < c->profile_count; i++)
+            if (strcmp(c->profiles[i], pname) == 0) known = true;
+        if (!known && c->profile_count < CFG_MAX_PROFILES)
+            strcpy(c->profiles[c->profile_count++], pname);
+    } else if (strncmp(name, "weapon.", 7) == 0) {
+        weapon = name + 7;
+    } else {
+        snprintf(err, err_size, "unknown section [%s]", name);
+        return false;
+    }
+
+    if (weapon) {
+        sec->weapon = weapon_section(weapon);
+        if (sec->weapon < 0) {
+            snprintf(err, err_size, "unknown weapon category '%s' (rifle, awp, pistol, smg, knife)",
+                     weapon);
+            return false;
+        }
+    }
+    sec->skip = false;
+    return true;
+}
+
+static void (*g_output)(const char *line);
+
+void config_set_output(void (*fn)(const char *line)) {
+    g_output = fn;
+}
+
+/* One message line, without its newline */
+static void say(const char *fmt, ...) {
+    char line[CFG_VALUE_MAX + 256];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(line, sizeof(line), fmt, ap);
+    va_end(ap);
+    if (g_output) g_output(line);
+    else printf("%s\n", line);
+}
+
+int config_parse_text(Config *c, const char *text, const char *name,
+                      const char *profile, bool verbose) {
+    config_defaults(c);
+
+    /* Values in inactive profiles are checked against a scratch copy */
+    Config scratch;
+    config_defaults(&scratch);
+
+    char want[CFG_NAME_LEN] = "";
+    if (profile) snprintf(want, sizeof(want), "%s", profile);
+    bool found = false;
+    Section sec = { false, true, -1, false };
+    int errors = 0;
+    int lineno = 0;
+    char err[160];
+
+    const char *p = text;
+    while (*p) {
+        const char *nl = strchr(p, '\n');
+        size_t len = nl ? (size_t)(nl - p) : strlen(p);
+        char line[CFG_VALUE_MAX + 64];
+        lineno++;
+
+        if (len >= sizeof(line)) {
+            snprintf(err, sizeof(err), "line too long");
+            goto bad;
+        }
+        memcpy(line, p, len);
+        line[len] = '\0';
+
+        char *hash = strpbrk(line, "#;");
+        if (hash) *hash = '\0';
+        char *s = trim(line);
+        if (!*s) goto next;
+
+        if (*s == '[') {
+            char *close = strchr(s, ']');
+            if (!close || *trim(close + 1)) {
+                snprintf(err, sizeof(err), "malformed section header");
+                sec.skip = true;
+                goto bad;
+            }
+            *close = '\0';
+            if (!parse_section(c, trim(s + 1), want[0] ? want : NULL, &found, &sec,
+                               err, sizeof(err)))
+                goto bad;
+            goto next;
+        }
+        if (sec.skip) goto next;
+
+        char *eq = strchr(s, '=');
+        if (!eq) {
+            snprintf(err, sizeof(err), "expected key = value");
+            goto bad;
+        }
+        *eq = '\0';
+        char *key = trim(s);
+        char *val = trim(eq + 1);
+
+        char full[CFG_NAME_LEN + 8];
+        if (sec.weapon >= 0) {
+            if (strcmp(key, "ap") != 0 && strcmp(key, "rt") != 0) {
+                snprintf(err, sizeof(err), "weapon sections take only ap and rt, not '%s'", key);
+                goto bad;
+            }
+            char lower[16];
+            size_t i = 0;
+            for (; wcat_names[sec.weapon][i] && i < sizeof(lower) - 1; i++)
+                lower[i] = (char)tolower((unsigned char)wcat_names[sec.weapon][i]);
+            lower[i] = '\0';
+            snprintf(full, sizeof(full), "%s_%s", lower, key);
+            key = full;
+        }
+
+        if (strcmp(key, "profile") == 0) {
+            if (sec.in_profile || sec.weapon >= 0) {
+                snprintf(err, sizeof(err), "profile= is only valid before the first section");
+                goto bad;
+            }
+            if (!config_set(c, key, val, err, sizeof(err))) goto bad;
+            if (!profile) snprintf(want, sizeof(want), "%s", val);
+            goto next;
+        }
+
+        if (!config_set(sec.active ? c : &scratch, key, val, err, sizeof(err))) goto bad;
+        goto next;
+
+    bad:
+        errors++;
+        if (verbose) say("[CFG] %s:%d: %s", name, lineno, err);
+    next:
+        if (!nl) break;
+        p = nl + 1;
+    }
+
+    if (want[0] && !found) {
+        errors++;
+        if (verbose) say("[CFG] %s: profile '%s' is not defined", name, want);
+    }
+    snprintf(c->profile, sizeof(c->profile), "%s", want);
+    return errors;
+}
+
+int config_parse_file(Config *c, const char *path, const char *profile) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        config_write_defaults(path);
+        config_defaults(c);
+        if (profile && profile[0]) {
+            say("[CFG] %s: profile '%s' is not defined", path, profile);
+            return 1;
+        }
+        return 0;
+    }
+
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (size < 0 || size > 1 << 20) {
+        fclose(f);
+        say("[CFG] %s: unreadable or too large", path);
+        return -1;
+    }
+    char *text = malloc((size_t)size + 1);
+    if (!text) { fclose(f); return -1; }
+    size_t n = fread(text, 1, (size_t)size, f);
+    text[n] = '\0';
+    fclose(f);
+
+    int errors = config_parse_text(c, text, path, profile, true);
+    free(text);
+    return errors;
+}
+
+void config_write_defaults(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) return;
+
+    Config c;
+    config_defaults(&c);
+    fprintf(f, "# wooting-aim v0.7 configuration\n");
+    for (int i = 0; i < config_schema_count; i++) {
+        const CfgField *fd = &config_schema[i];
+        char val[CFG_VALUE_MAX];
+        if (fd->group) fprintf(f, "\n# %s\n", fd->group);
+        config_format(&c, fd, val, sizeof(val));
+        if (fd->help) fprintf(f, "%s=%s    # %s\n", fd->key, val, fd->help);
+        else          fprintf(f, "%s=%s\n", fd->key, val);
+    }
+    fprintf(f, "\n# Named profiles override any key above. Select one with\n");
+    fprintf(f, "# profile=NAME (or --profile NAME). Examples:\n");
+    fprintf(f, "# [profile.retake]\n# ap_aggro=0.3\n# [profile.retake.weapon.awp]\n# ap=0.6\n");
+    fprintf(f, "# [weapon.rifle]     (same as rifle_ap/rifle_rt)\n# ap=0.4\n# rt=0.1\n");
+    fclose(f);
+    printf("[CFG] Default config created: %s\n", path);
+}
+
+void config_compile(Config *c, double tick_freq) {
+    for (int i = 0; i < WCAT_COUNT; i++) c->aggro[i] = c->weapon[i];
+    c->aggro[WCAT_COUNT].ap = c->ap_aggro;
+    c->aggro[WCAT_COUNT].rt = c->rt_aggro;
+
+    c->write_interval_ticks = (int64_t)(c->write_interval_ms * tick_freq / 1000.0);
+    c->poll_period_ticks = c->poll_rate_hz > 0 ? (int64_t)(tick_freq / c->poll_rate_hz) : 0;
+    c->idle_after_ticks = (int64_t)(c->idle_after_ms * tick_freq / 1000.0);
+    c->idle_sleep_ms = c->idle_poll_hz >= 1.0f ? (int)lroundf(1000.0f / c->idle_poll_hz) : 1000;
+    if (c->idle_sleep_ms < 1) c->idle_sleep_ms = 1;
+}
@@ -0,0 +1,186 @@
+/*
+ * config.h - Schema-driven configuration
+ *
+ * Every key in wooting-aim.cfg is a row in config_schema[] (type, offset
+ * into Config, range, default). One parser walks the file against that
+ * table, so adding a setting is a struct field plus one table row.
+ *
+ * File format:
+ *   key = value                 base settings
+ *   [weapon.awp]                per-weapon-category overrides (ap, rt)
+ *   [profile.NAME]              named override set, chosen with profile=NAME
+ *   [profile.NAME.weapon.awp]   per-weapon overrides inside a profile
+ *
+ * Bad values, unknown keys and unknown sections are rejected with their
+ * line number; the whole file is then refused (defaults on startup, the
+ * previous config on a live reload).
+ */
+
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define CFG_NAME_LEN      32
+#define CFG_MAX_PROFILES  8
+#define CFG_MAX_KEYS      64
+#define CFG_VALUE_MAX     512   /* longest formatted value (a long key list) */
+
+typedef enum {
+    WCAT_RIFLE,
+    WCAT_AWP,
+    WCAT_PISTOL,
+    WCAT_SMG,
+    WCAT_KNIFE,
+    WCAT_OTHER,
+    WCAT_COUNT
+} WeaponCategory;
+
+extern const char *const wcat_names[WCAT_COUNT];
+
+typedef struct {
+    float ap;
+    float rt;
+} WeaponProfile;
+
+/* Set of keys by HID usage, in the order listed */
+typedef struct {
+    int     count;
+    uint8_t usage[CFG_MAX_KEYS];
+} KeyList;
+
+/*
+ * Compiled engine config. Immutable once published. Fields the sampling
+ * thread reads every frame come first and fit in two cache lines.
+ */
+typedef struct {
+    /* --- hot --- */
+    _Alignas(64) WeaponProfile aggro[WCAT_COUNT + 1]; /* per category, [WCAT_COUNT] = no GSI */
+    float   ap_normal;
+    float   rt_normal;
+    float   predict_threshold;
+    float   predict_min_peak;
+    float   crouch_rt_factor;
+    float   ap_extra;               /* adaptive_keys while a round is live */
+    float   rt_extra;
+    float   phase_ultra_ms;         /* phase decay: min AP this long into a counter-strafe */
+    float   phase_decay_ms;         /* ... back to the weapon AP by this time */
+    int     idle_sleep_ms;          /* 1 / idle_poll_hz; fills the gap before the int64s */
+    int64_t write_interval_ticks;   /* write_interval_ms in QPC ticks */
+    int64_t poll_period_ticks;      /* 1 / poll_rate_hz in QPC ticks, 0 = unlimited */
+    int64_t idle_after_ticks;       /* idle_after_ms in QPC ticks, 0 = never idle */
+    bool    ws_adaptive;
+    bool    stats_enabled;
+    bool    vel_enabled;
+    bool    vel_scale_enabled;      /* velocity-aware AP scaling */
+    bool    jiggle_enabled;         /* jiggle peek detection */
+    bool    phase_decay;            /* counter-strafe phase decay */
+
+    /* --- cold: source values for the derived fields, startup-bound settings --- */
+    float   ap_aggro;               /* used when GSI not connected */
+    float   rt_aggro;
+    WeaponProfile weapon[WCAT_COUNT];
+    float   write_interval_ms;
+    float   poll_rate_hz;           /* target poll rate (0=unlimited) */
+    float   idle_after_ms;
+    float   idle_poll_hz;
+    bool    gsi_enabled;
+    int     gsi_port;
+    bool    metrics_enabled;
+    int     metrics_port;
+    bool    telemetry_shm;          /* publish frames to shared memory for overlays */
+    bool    control_enabled;        /* local control pipe / socket */
+    uint64_t sampler_cpus;          /* CPU sets (bit n = CPU n), 0 = any */
+    uint64_t aux_cpus;
+    int     sampler_priority;       /* THREAD_PRIO_* */
+    bool    sampler_mmcss;
+    bool    isolate_sampler;        /* keep other threads off sampler_cpus */
+    uint8_t key_forward, key_left;  /* movement keys (HID usages) */
+    uint8_t key_back, key_right;
+    uint8_t key_crouch;
+    KeyList adaptive_keys;          /* extra keys tuned with ap_extra/rt_extra */
+
+    char    profile[CFG_NAME_LEN];  /* active [profile.NAME], "" = none */
+    char    profiles[CFG_MAX_PROFILES][CFG_NAME_LEN];   /* profiles defined in the file */
+    int     profile_count;
+} Config;
+
+_Static_assert(offsetof(Config, phase_decay) + sizeof(bool) <= 128,
+               "Config hot fields must fit in two cache lines");
+
+typedef enum {
+    CFG_FLOAT,
+    CFG_INT,
+    CFG_BOOL,
+    CFG_NAME,      /* short identifier: [A-Za-z0-9_-] */
+    CFG_CPUSET,    /* CPU list "0-3,6" into a uint64_t mask, empty = any */
+    CFG_KEY,       /* key name ("space", "lshift", "w") into a uint8_t HID usage */
+    CFG_KEYS,      /* key name list "space,e,q" into a KeyList, empty = none */
+} CfgType;
+
+#define CFG_RESTART  0x01    /* bound at startup (sockets, threads, files) */
+
+typedef struct {
+    const char *key;
+    CfgType     type;
+    uint16_t    offset;      /* into Config */
+    uint8_t     flags;
+    float       min, max;
+    float       def;
+    const char *group;       /* starts a commented block in the default file */
+    const char *help;
+} CfgField;
+
+extern const CfgField config_schema[];
+extern const int config_schema_count;
+
+/* Defaults from the schema (not compiled). */
+void config_defaults(Config *c);
+
+/* Schema row for `key`, or NULL. */
+const CfgField *config_find(const char *key);
+
+/*
+ * Parse and range-check one value into c. On failure writes the reason to
+ * err and leaves c unchanged.
+ */
+bool config_set(Config *c, const char *key, const char *value, char *err, size_t err_size);
+
+/* Format the current value of field f. */
+void config_format(const Config *c, const CfgField *f, char *buf, size_t size);
+
+/* CPU mask as a list ("0-3,6"); "" for an empty mask. */
+void config_format_cpuset(uint64_t mask, char *buf, size_t size);
+
+/* HID usage for a key name, or -1. Names cover the 60HE's 61 keys. */
+int config_key_usage(const char *name);
+
+/* Key name for a HID usage, or NULL. */
+const char *config_key_name(int usage);
+
+/*
+ * Parse config text on top of the defaults. `name` labels error messages,
+ * `profile` (NULL = use the file's profile= key) selects the profile.
+ * Returns the number of errors; c is only meaningful when it is 0.
+ */
+int config_parse_text(Config *c, const char *text, const char *name,
+                      const char *profile, bool verbose);
+
+/*
+ * Same, from a file. A missing file is created with the defaults.
+ * Returns the number of errors, or -1 if the file cannot be read.
+ */
+int config_parse_file(Config *c, const char *path, const char *profile);
+
+void config_write_defaults(const char *path);
+
+/* Where parse errors go, one line at a time without the newline
+ * (NULL = stdout, the default). */
+void config_set_output(void (*fn)(const char *line));
+
+/* Fill in the derived fields. tick_freq = QPC ticks per second. */
+void config_compile(Config *c, double tick_freq);
+
+#endif /* CONFIG_H */
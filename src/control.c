@@ -0,0 +1,272 @@
+/*
+ * control.c - Control channel transport (named pipe / Unix socket)
+ *
+ * Line framing and the accept loop only; what a command does is up to the
+ * handler. Kept free of SDK/HID dependencies.
+ */
+
+#include "control.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#define CONTROL_POLL_MS  500     /* how often blocked I/O rechecks `running` */
+
+#define TRUNCATED_LINE   "ERR reply truncated\n"
+
+void control_printf(ControlReply *r, const char *fmt, ...) {
+    if (r->truncated) return;
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(r->buf + r->len, r->size - r->len, fmt, ap);
+    va_end(ap);
+    if (n < 0 || (size_t)n >= r->size - r->len) {
+        r->truncated = true;
+        r->buf[r->len] = '\0';
+        return;
+    }
+    r->len += (size_t)n;
+}
+
+void control_endpoint(char *buf, size_t size) {
+#ifdef _WIN32
+    snprintf(buf, size, "%s", CONTROL_PIPE_NAME);
+#else
+    const char *dir = getenv("XDG_RUNTIME_DIR");
+    snprintf(buf, size, "%s/%s", dir && dir[0] ? dir : "/tmp", CONTROL_SOCKET_NAME);
+#endif
+}
+
+/* ---------- connection I/O ---------- */
+
+#ifdef _WIN32
+typedef struct {
+    HANDLE pipe;
+    OVERLAPPED ov;
+} Conn;
+
+/* Wait for the pending overlapped op, giving up when the server stops */
+static bool conn_wait(ControlServer *s, Conn *c, DWORD *bytes) {
+    while (WaitForSingleObject(c->ov.hEvent, CONTROL_POLL_MS) == WAIT_TIMEOUT) {
+        if (!atomic_load(&s->running)) {
+            CancelIoEx(c->pipe, &c->ov);
+            GetOverlappedResult(c->pipe, &c->ov, bytes, TRUE);
+            return false;
+        }
+    }
+    return GetOverlappedResult(c->pipe, &c->ov, bytes, FALSE) != 0;
+}
+
+static int conn_read(ControlServer *s, Conn *c, char *buf, int size) {
+    DWORD n = 0;
+    ResetEvent(c->ov.hEvent);
+    if (!ReadFile(c->pipe, buf, (DWORD)size, NULL, &c->ov) && GetLastError() != ERROR_IO_PENDING)
+        return 0;
+    if (!conn_wait(s, c, &n)) return 0;
+    return (int)n;
+}
+
+static bool conn_write(ControlServer *s, Conn *c, const char *buf, size_t len) {
+    while (len > 0) {
+        DWORD n = 0;
+        ResetEvent(c->ov.hEvent);
+        if (!WriteFile(c->pipe, buf, (DWORD)len, NULL, &c->ov) && GetLastError() != ERROR_IO_PENDING)
+            return false;
+        if (!conn_wait(s, c, &n) || n == 0) return false;
+        buf += n;
+        len -= n;
+    }
+    return true;
+}
+#else
+typedef struct {
+    int fd;
+} Conn;
+
+static int conn_read(ControlServer *s, Conn *c, char *buf, int size) {
+    struct pollfd p = { c->fd, POLLIN, 0 };
+    while (atomic_load(&s->running)) {
+        int r = poll(&p, 1, CONTROL_POLL_MS);
+        if (r < 0 && errno != EINTR) return 0;
+        if (r <= 0) continue;
+        ssize_t n = read(c->fd, buf, (size_t)size);
+        if (n < 0 && errno == EINTR) continue;
+        return n > 0 ? (int)n : 0;
+    }
+    return 0;
+}
+
+static bool conn_write(ControlServer *s, Conn *c, const char *buf, size_t len) {
+    (void)s;
+    while (len > 0) {
+        ssize_t n = send(c->fd, buf, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        buf += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+#endif
+
+/* One client session: split input into lines, answer each in order */
+static void serve_client(ControlServer *s, Conn *c) {
+    static char reply_buf[CONTROL_REPLY_MAX];
+    const size_t reply_room = sizeof(reply_buf) - (sizeof(TRUNCATED_LINE) - 1);
+    char line[CONTROL_LINE_MAX];
+    char in[512];
+    size_t len = 0;
+    bool overflow = false;
+    int n;
+
+    while ((n = conn_read(s, c, in, (int)sizeof(in))) > 0) {
+        for (int i = 0; i < n; i++) {
+            if (in[i] != '\n') {
+                if (len < sizeof(line) - 1) line[len++] = in[i];
+                else overflow = true;
+                continue;
+            }
+            while (len > 0 && (line[len - 1] == '\r' || line[len - 1] == ' ')) len--;
+            line[len] = '\0';
+
+            ControlReply r = { reply_buf, reply_room, 0, false };
+            reply_buf[0] = '\0';
+            if (overflow)
+                control_printf(&r, "ERR line too long\n");
+            else if (len > 0)
+                s->handler(line, &r);
+            if (r.truncated) {
+                /* Whole lines only, then ERR in the room kept for it */
+                while (r.len > 0 && reply_buf[r.len - 1] != '\n') r.len--;
+                memcpy(reply_buf + r.len, TRUNCATED_LINE, sizeof(TRUNCATED_LINE) - 1);
+                r.len += sizeof(TRUNCATED_LINE) - 1;
+            }
+            len = 0;
+            overflow = false;
+            if (r.len && !conn_write(s, c, reply_buf, r.len)) return;
+        }
+    }
+}
+
+/* ---------- server ---------- */
+
+#ifdef _WIN32
+static void control_thread(void *param) {
+    ControlServer *s = (ControlServer *)param;
+    Conn c;
+    memset(&c, 0, sizeof(c));
+    c.ov.hEvent = CreateEventA(NULL, TRUE, FALSE, NULL);
+    bool announced = false;
+
+    while (atomic_load(&s->running)) {
+        /* Single instance: a second tuner fails here instead of sharing */
+        c.pipe = CreateNamedPipeA(s->path, PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED,
+                                  PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT |
+                                  PIPE_REJECT_REMOTE_CLIENTS,
+                                  1, 4096, 4096, 0, NULL);
+        if (c.pipe == INVALID_HANDLE_VALUE) {
+            printf("[CTL] Cannot create %s: %lu\n", s->path, GetLastError());
+            break;
+        }
+        if (!announced) {
+            printf("[CTL] Control channel: %s\n", s->path);
+            announced = true;
+        }
+
+        ResetEvent(c.ov.hEvent);
+        bool connected = ConnectNamedPipe(c.pipe, &c.ov) != 0;
+        if (!connected) {
+            DWORD err = GetLastError(), n;
+            if (err == ERROR_PIPE_CONNECTED) connected = true;
+            else if (err == ERROR_IO_PENDING) connected = conn_wait(s, &c, &n);
+        }
+        if (connected) {
+            serve_client(s, &c);
+            FlushFileBuffers(c.pipe);
+            DisconnectNamedPipe(c.pipe);
+        }
+        CloseHandle(c.pipe);
+    }
+
+    CloseHandle(c.ov.hEvent);
+}
+#else
+static void control_thread(void *param) {
+    ControlServer *s = (ControlServer *)param;
+
+    int lfd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (lfd < 0) {
+        printf("[CTL] Socket creation failed: %s\n", strerror(errno));
+        return;
+    }
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%.*s", (int)sizeof(addr.sun_path) - 1, s->path);
+
+    /* A socket someone answers on belongs to a running instance: leave it.
+     * One nobody answers on is left over from a crash and would make bind
+     * fail. */
+    int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    bool live = false, stale = false;
+    if (probe >= 0) {
+        /* EAGAIN: its backlog is full, which is just as alive */
+        live = connect(probe, (struct sockaddr *)&addr, sizeof(addr)) == 0 || errno == EAGAIN;
+        stale = !live && (errno == ECONNREFUSED || errno == ENOENT);
+    }
+    if (probe >= 0) close(probe);
+    if (live) {
+        printf("[CTL] %s is in use by another instance, control channel off.\n", s->path);
+        close(lfd);
+        return;
+    }
+    if (stale) unlink(s->path);
+    /* Owner only. chmod, not umask: that is process-wide and other threads
+     * create files meanwhile. Nobody can connect before listen() anyway */
+    if (bind(lfd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        chmod(s->path, 0600) < 0 || listen(lfd, 1) < 0) {
+        printf("[CTL] Cannot listen on %s: %s\n", s->path, strerror(errno));
+        close(lfd);
+        return;
+    }
+    printf("[CTL] Control channel: %s\n", s->path);
+
+    struct pollfd p = { lfd, POLLIN, 0 };
+    while (atomic_load(&s->running)) {
+        if (poll(&p, 1, CONTROL_POLL_MS) <= 0) continue;
+        Conn c = { accept(lfd, NULL, NULL) };
+        if (c.fd < 0) continue;
+        serve_client(s, &c);
+        close(c.fd);
+    }
+
+    close(lfd);
+    unlink(s->path);
+}
+#endif
+
+bool control_start(ControlServer *s, ControlHandler handler) {
+    s->handler = handler;
+    control_endpoint(s->path, sizeof(s->path));
+    atomic_store(&s->running, true);
+    if (!plat_thread_start(&s->thread, control_thread, s, PLAT_PRIO_BELOW_NORMAL)) {
+        atomic_store(&s->running, false);
+        return false;
+    }
+    return true;
+}
+
+void control_stop(ControlServer *s) {
+    atomic_store(&s->running, false);
+    plat_thread_join(&s->thread, 2000);
+}
@@ -0,0 +1,67 @@
+/*
+ * control.h - Local control channel for live tuning from scripts
+ *
+ * A named pipe (\\.\pipe\wooting-aim) on Windows, a Unix domain socket
+ * ($XDG_RUNTIME_DIR/wooting-aim.sock, else /tmp) elsewhere. One client at
+ * a time, one command per line:
+ *
+ *   get KEY | set KEY VALUE | list | profile [NAME] | reload
+ *   hist | record start [PATH] | record stop | help
+ *
+ * Every reply is zero or more data lines followed by a final "OK" or
+ * "ERR <reason>" line, so a client reads until it sees either.
+ *
+ * The server thread only moves bytes; commands run in the handler the
+ * application passes in, on the server thread, never the sampler's.
+ */
+
+#ifndef CONTROL_H
+#define CONTROL_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "platform.h"
+
+#define CONTROL_PIPE_NAME    "\\\\.\\pipe\\wooting-aim"
+#define CONTROL_SOCKET_NAME  "wooting-aim.sock"
+#define CONTROL_LINE_MAX     512
+#define CONTROL_REPLY_MAX    16384
+
+typedef struct {
+    char *buf;
+    size_t size;
+    size_t len;
+    bool truncated;             /* something did not fit */
+} ControlReply;
+
+/*
+ * Append formatted text to the reply. A reply that outgrows
+ * CONTROL_REPLY_MAX is cut after its last whole line and ends with
+ * "ERR reply truncated" instead of the handler's OK.
+ */
+void control_printf(ControlReply *r, const char *fmt, ...);
+
+/* Handle one command line (no newline). Must end the reply with OK or ERR. */
+typedef void (*ControlHandler)(char *line, ControlReply *reply);
+
+typedef struct {
+    ControlHandler handler;
+    char path[256];
+    atomic_bool running;
+    PlatThread thread;
+} ControlServer;
+
+/* Endpoint path for this platform (pipe name or socket path). */
+void control_endpoint(char *buf, size_t size);
+
+/*
+ * Start the server thread. Returns false if the thread could not start;
+ * endpoint errors are reported from the thread as [CTL] lines.
+ */
+bool control_start(ControlServer *s, ControlHandler handler);
+
+/* Stop the server thread. Safe to call when it never started. */
+void control_stop(ControlServer *s);
+
+#endif /* CONTROL_H */
@@ -0,0 +1,125 @@
+/*
+ * control_client.c - wooting-aim-ctl: send one control command
+ *
+ * For scripts and stream-deck buttons:
+ *   wooting-aim-ctl set ap_aggro 0.3
+ *   wooting-aim-ctl profile retake
+ *   wooting-aim-ctl record start
+ *
+ * Prints the reply (without the final OK) and exits 0 on OK, 1 on ERR
+ * or when no tuner is running.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "control.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#define CONNECT_WAIT_MS 2000    /* the server takes one client at a time */
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        printf("Usage: wooting-aim-ctl COMMAND [ARGS...]   (try: wooting-aim-ctl help)\n");
+        return 1;
+    }
+
+    char line[CONTROL_LINE_MAX];
+    size_t len = 0;
+    for (int i = 1; i < argc; i++) {
+        int n = snprintf(line + len, sizeof(line) - len, "%s%s", i > 1 ? " " : "", argv[i]);
+        if (n < 0 || (size_t)n >= sizeof(line) - len - 1) {
+            fprintf(stderr, "Command too long.\n");
+            return 1;
+        }
+        len += (size_t)n;
+    }
+    line[len++] = '\n';
+
+    char path[256];
+    control_endpoint(path, sizeof(path));
+
+#ifdef _WIN32
+    HANDLE pipe = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL);
+    if (pipe == INVALID_HANDLE_VALUE && GetLastError() == ERROR_PIPE_BUSY &&
+        WaitNamedPipeA(path, CONNECT_WAIT_MS))
+        pipe = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL);
+    if (pipe == INVALID_HANDLE_VALUE) {
+        fprintf(stderr, "No control channel at %s. Is wooting-aim running (control_enabled=1)?\n", path);
+        return 1;
+    }
+    DWORD n;
+    if (!WriteFile(pipe, line, (DWORD)len, &n, NULL)) {
+        CloseHandle(pipe);
+        return 1;
+    }
+#else
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%.*s", (int)sizeof(addr.sun_path) - 1, path);
+    if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        fprintf(stderr, "No control channel at %s. Is wooting-aim running (control_enabled=1)?\n", path);
+        return 1;
+    }
+    if (write(fd, line, len) != (ssize_t)len) {
+        close(fd);
+        return 1;
+    }
+#endif
+
+    /* Echo reply lines until the final OK / ERR */
+    char buf[CONTROL_REPLY_MAX];
+    size_t have = 0, start = 0;
+    int rc = 1;
+    for (;;) {
+        if (have == sizeof(buf)) {
+            /* Oversized line: flush what we have */
+            fwrite(buf + start, 1, have - start, stdout);
+            have = start = 0;
+        }
+#ifdef _WIN32
+        DWORD got = 0;
+        if (!ReadFile(pipe, buf + have, (DWORD)(sizeof(buf) - have), &got, NULL) || got == 0) break;
+#else
+        ssize_t got = read(fd, buf + have, sizeof(buf) - have);
+        if (got <= 0) break;
+#endif
+        have += (size_t)got;
+
+        bool done = false;
+        char *nl;
+        while (!done && (nl = memchr(buf + start, '\n', have - start))) {
+            *nl = '\0';
+            const char *l = buf + start;
+            start = (size_t)(nl - buf) + 1;
+            if (strcmp(l, "OK") == 0) {
+                rc = 0;
+                done = true;
+            } else if (strncmp(l, "ERR", 3) == 0) {
+                fprintf(stderr, "%s\n", l[3] ? l + 4 : "error");
+                done = true;
+            } else {
+                printf("%s\n", l);
+            }
+        }
+        if (done) break;
+        memmove(buf, buf + start, have - start);
+        have -= start;
+        start = 0;
+    }
+
+#ifdef _WIN32
+    CloseHandle(pipe);
+#else
+    close(fd);
+#endif
+    return rc;
+}
@@ -0,0 +1,171 @@
+/*
+ * frame_trace.c - Per-thread trace rings, Chrome trace-event JSON writer
+ */
+
+#include "frame_trace.h"
+#include "platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    int64_t  ts;            /* ticks */
+    int64_t  dur;           /* ticks, -1 = instant */
+    uint64_t frame;
+    int32_t  arg;
+    uint32_t ev;
+} FtRecord;
+
+typedef struct {
+    char name[24];
+    FtRecord *rec;          /* FTRACE_EVENTS_PER_THREAD, oldest overwritten */
+    atomic_uint_fast64_t head;   /* records written; owner stores, dump loads */
+} FtThread;
+
+atomic_bool g_ftrace_on;
+
+static FtThread g_threads[FTRACE_MAX_THREADS];
+static atomic_int g_num_threads;
+static char g_path[PLAT_PATH_MAX];
+
+static _Thread_local FtThread *t_self;
+static _Thread_local uint64_t t_frame;
+static _Thread_local bool t_full;        /* no slot left for this thread */
+
+static const char *event_names[FT_EVENT_COUNT] = {
+    "frame", "acquire", "transition", "targets", "write", "hid_write", "hid_ack", "gsi",
+};
+
+bool ftrace_start(const char *path) {
+    snprintf(g_path, sizeof(g_path), "%s", path);
+    FILE *f = fopen(g_path, "w");     /* fail now rather than at exit */
+    if (!f) {
+        printf("[TRACE] Cannot create %s\n", g_path);
+        return false;
+    }
+    fclose(f);
+    atomic_store(&g_ftrace_on, true);
+    return true;
+}
+
+static FtThread *claim(const char *name) {
+    if (t_self || t_full) return t_self;
+    int i = atomic_fetch_add(&g_num_threads, 1);
+    if (i >= FTRACE_MAX_THREADS) {
+        t_full = true;
+        return NULL;
+    }
+    FtThread *t = &g_threads[i];
+    t->rec = malloc(sizeof(FtRecord) * FTRACE_EVENTS_PER_THREAD);
+    if (!t->rec) {
+        t_full = true;
+        return NULL;
+    }
+    snprintf(t->name, sizeof(t->name), "%s", name);
+    t_self = t;
+    return t;
+}
+
+void ftrace_thread(const char *name) {
+    if (!ftrace_on()) return;
+    if (t_self) snprintf(t_self->name, sizeof(t_self->name), "%s", name);
+    else claim(name);
+}
+
+void ftrace_frame(uint64_t frame) {
+    t_frame = frame;
+}
+
+void ftrace_span(FtEvent ev, int64_t start, int64_t end, int32_t arg) {
+    FtThread *t = t_self ? t_self : claim("thread");
+    if (!t) return;
+    uint64_t h = atomic_load_explicit(&t->head, memory_order_relaxed);
+    FtRecord *r = &t->rec[h & (FTRACE_EVENTS_PER_THREAD - 1)];
+    r->ts = start;
+    r->dur = end < 0 ? -1 : end - start;
+    r->frame = t_frame;
+    r->arg = arg;
+    r->ev = (uint32_t)ev;
+    atomic_store_explicit(&t->head, h + 1, memory_order_release);
+}
+
+void ftrace_instant(FtEvent ev, int32_t arg) {
+    ftrace_span(ev, plat_ticks(), -1, arg);
+}
+
+/* ---------- export ---------- */
+
+static void write_args(FILE *f, const FtRecord *r) {
+    fprintf(f, "\"args\":{\"frame\":%llu", (unsigned long long)r->frame);
+    switch (r->ev) {
+    case FT_TRANSITION:
+        fprintf(f, ",\"axis\":\"%c\",\"state\":%d", (r->arg >> 8) ? 'V' : 'H', r->arg & 0xFF);
+        break;
+    case FT_HID_WRITE:
+        fprintf(f, ",\"cmd\":%d", r->arg);
+        break;
+    case FT_HID_ACK:
+        fprintf(f, ",\"bytes\":%d", r->arg);
+        break;
+    default:
+        break;
+    }
+    fputc('}', f);
+}
+
+bool ftrace_finish(void) {
+    if (!atomic_exchange(&g_ftrace_on, false)) return false;
+
+    FILE *f = fopen(g_path, "w");
+    if (!f) {
+        printf("[TRACE] Cannot write %s\n", g_path);
+        return false;
+    }
+
+    int n = atomic_load(&g_num_threads);
+    if (n > FTRACE_MAX_THREADS) n = FTRACE_MAX_THREADS;
+
+    /* Timestamps relative to the oldest record still held, in us */
+    int64_t t0 = INT64_MAX;
+    uint64_t heads[FTRACE_MAX_THREADS];
+    for (int i = 0; i < n; i++) {
+        FtThread *t = &g_threads[i];
+        heads[i] = t->rec ? atomic_load_explicit(&t->head, memory_order_acquire) : 0;
+        uint64_t first = heads[i] > FTRACE_EVENTS_PER_THREAD ? heads[i] - FTRACE_EVENTS_PER_THREAD : 0;
+        if (heads[i] > first) {
+            int64_t ts = t->rec[first & (FTRACE_EVENTS_PER_THREAD - 1)].ts;
+            if (ts < t0) t0 = ts;
+        }
+    }
+    double us = 1e6 / (double)plat_tick_freq();
+
+    fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    fprintf(f, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+               "\"args\":{\"name\":\"wooting-aim\"}}");
+    uint64_t total = 0;
+    for (int i = 0; i < n; i++) {
+        FtThread *t = &g_threads[i];
+        if (!t->rec) continue;
+        fprintf(f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                   "\"args\":{\"name\":\"%s\"}}", i + 1, t->name);
+
+        uint64_t first = heads[i] > FTRACE_EVENTS_PER_THREAD ? heads[i] - FTRACE_EVENTS_PER_THREAD : 0;
+        for (uint64_t k = first; k < heads[i]; k++) {
+            const FtRecord *r = &t->rec[k & (FTRACE_EVENTS_PER_THREAD - 1)];
+            if (r->ev >= FT_EVENT_COUNT) continue;
+            fprintf(f, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,",
+                    event_names[r->ev], t->name, i + 1, (double)(r->ts - t0) * us);
+            if (r->dur < 0) fprintf(f, "\"ph\":\"i\",\"s\":\"t\",");
+            else            fprintf(f, "\"ph\":\"X\",\"dur\":%.3f,", (double)r->dur * us);
+            write_args(f, r);
+            fputc('}', f);
+            total++;
+        }
+    }
+    fprintf(f, "\n]}\n");
+    bool ok = !ferror(f);
+    ok &= fclose(f) == 0;
+    if (ok) printf("[TRACE] %llu events written to %s\n", (unsigned long long)total, g_path);
+    else    printf("[TRACE] Write failed: %s\n", g_path);
+    return ok;
+}
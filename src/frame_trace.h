@@ -0,0 +1,63 @@
+/*
+ * frame_trace.h - Per-frame latency tracer with Chrome trace-event export
+ *
+ * Trace points along the path from a key moving to the firmware holding
+ * new AP/RT: analog read, axis transition, new targets, write start, each
+ * HID report and its response. The GSI server's requests go on their own
+ * track. Every thread records into a ring of its own (one writer, no
+ * locks). ftrace_finish() writes them as Chrome trace-event JSON for
+ * ui.perfetto.dev or chrome://tracing.
+ *
+ * Off unless ftrace_start() was called (--frame-trace FILE). A disabled
+ * trace point is a relaxed load and an untaken branch.
+ */
+
+#ifndef FRAME_TRACE_H
+#define FRAME_TRACE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define FTRACE_MAX_THREADS        8
+#define FTRACE_EVENTS_PER_THREAD  (1u << 18)   /* 8 MB per recording thread */
+
+typedef enum {
+    FT_FRAME,           /* span: a frame whose input changed, read to write queued */
+    FT_ACQUIRE,         /* span: the analog reads */
+    FT_TRANSITION,      /* instant: arg = axis << 8 | new state */
+    FT_TARGETS,         /* instant: AP/RT targets changed */
+    FT_WRITE,           /* instant: write queued for the writer (write_interval passed) */
+    FT_HID_WRITE,       /* span: one output report on the writer thread, arg = command */
+    FT_HID_ACK,         /* span: report written to response read, arg = bytes (0 = none) */
+    FT_GSI,             /* span: one GSI request, accept to parsed */
+    FT_EVENT_COUNT
+} FtEvent;
+
+extern atomic_bool g_ftrace_on;
+
+static inline bool ftrace_on(void) {
+    return atomic_load_explicit(&g_ftrace_on, memory_order_relaxed);
+}
+
+/* Start recording; the JSON goes to path at ftrace_finish(). */
+bool ftrace_start(const char *path);
+
+/* Name the calling thread's track (first call allocates its ring). */
+void ftrace_thread(const char *name);
+
+/* Frame number attached to the calling thread's following events. */
+void ftrace_frame(uint64_t frame);
+
+/* Record on the calling thread's ring. Ticks are plat_ticks(). */
+void ftrace_span(FtEvent ev, int64_t start, int64_t end, int32_t arg);
+void ftrace_instant(FtEvent ev, int32_t arg);
+
+/*
+ * Stop recording and write the JSON. Call once the traced threads are
+ * idle or joined; the rings stay allocated for any late writer.
+ */
+bool ftrace_finish(void);
+
+#endif /* FRAME_TRACE_H */
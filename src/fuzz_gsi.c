@@ -0,0 +1,134 @@
+/*
+ * fuzz_gsi.c - libFuzzer harness for GSI request framing and parsing
+ *
+ * Each input is one raw HTTP request as the GSI server receives it. It is
+ * fed to gsi_http_body in recv-sized pieces (the first byte picks the
+ * piece size) and the body handed to gsi_parse; then the whole input is
+ * parsed again as a bare JSON body. Both run on exact-size heap copies,
+ * so ASan flags any read past the length.
+ *
+ * An input slower than WA_FUZZ_SLOW_US microseconds (default 10000)
+ * aborts, so libFuzzer keeps it like a crash. Parse throughput and the
+ * slowest input so far are printed every 10 s.
+ *
+ *   make fuzz-gsi          clang, -fsanitize=fuzzer,address,undefined
+ *   make fuzz-gsi-replay   any compiler: runs every seed in fuzz/gsi once
+ *
+ * Crashes and slow inputs go into fuzz/gsi/ and stay there as seeds.
+ */
+
+#include "gsi.h"
+#include "platform.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static struct {
+    uint64_t inputs;
+    uint64_t bytes;
+    int64_t  ticks;
+    int64_t  slowest;
+    size_t   slowest_size;
+    int64_t  last_report;
+    int64_t  slow_limit;
+} g_fz;
+
+static void check_update(const GsiUpdate *u) {
+    if (strnlen(u->weapon_name, sizeof(u->weapon_name)) == sizeof(u->weapon_name) ||
+        strnlen(u->weapon_type, sizeof(u->weapon_type)) == sizeof(u->weapon_type) ||
+        strnlen(u->round_phase, sizeof(u->round_phase)) == sizeof(u->round_phase) ||
+        u->health < -1)
+        abort();
+}
+
+static void report(void) {
+    double secs = (double)g_fz.ticks / (double)plat_tick_freq();
+    printf("[FUZZ] %llu inputs, %.1f MB/s parse throughput, slowest %.1f us (%zu bytes)\n",
+           (unsigned long long)g_fz.inputs, secs > 0 ? (double)g_fz.bytes / secs / 1e6 : 0.0,
+           (double)g_fz.slowest * 1e6 / (double)plat_tick_freq(), g_fz.slowest_size);
+    fflush(stdout);
+}
+
+int LLVMFuzzerInitialize(int *argc, char ***argv) {
+    (void)argc; (void)argv;
+    const char *env = getenv("WA_FUZZ_SLOW_US");
+    long us = env ? atol(env) : 10000;
+    g_fz.slow_limit = (int64_t)us * plat_tick_freq() / 1000000;
+    g_fz.last_report = plat_ticks();
+    return 0;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    GsiUpdate u;
+    int64_t t0 = plat_ticks();
+
+    /* As a request: at most what fits the server's buffer, in pieces */
+    int total = size < GSI_BUF_SIZE - 1 ? (int)size : GSI_BUF_SIZE - 1;
+    char *buf = malloc(total ? (size_t)total : 1);
+    if (!buf) return 0;
+    memcpy(buf, data, (size_t)total);
+    int piece = size ? (data[0] % 64 + 1) * 16 : 1;
+    const char *body = NULL;
+    bool complete = false;
+    int body_len = -1;
+    for (int got = 0; got < total && !complete; ) {
+        got = got + piece < total ? got + piece : total;
+        body_len = gsi_http_body(buf, got, &body, &complete);
+        if (body_len >= 0 && (body < buf || body + body_len > buf + got)) abort();
+    }
+    if (body_len > 0) {
+        gsi_parse(body, body_len, &u);
+        check_update(&u);
+    }
+    free(buf);
+
+    /* As a bare body */
+    char *json = malloc(size ? size : 1);
+    if (!json) return 0;
+    memcpy(json, data, size);
+    gsi_parse(json, (int)(size < INT32_MAX ? size : INT32_MAX), &u);
+    check_update(&u);
+    free(json);
+
+    int64_t t1 = plat_ticks();
+    g_fz.inputs++;
+    g_fz.bytes += size + (uint64_t)(body_len > 0 ? body_len : 0);
+    g_fz.ticks += t1 - t0;
+    if (t1 - t0 > g_fz.slowest) {
+        g_fz.slowest = t1 - t0;
+        g_fz.slowest_size = size;
+    }
+    if (g_fz.slow_limit > 0 && t1 - t0 > g_fz.slow_limit) {
+        printf("[FUZZ] Slow input: %.1f us for %zu bytes\n",
+               (double)(t1 - t0) * 1e6 / (double)plat_tick_freq(), size);
+        abort();
+    }
+    if (t1 - g_fz.last_report > 10 * plat_tick_freq()) {
+        g_fz.last_report = t1;
+        report();
+    }
+    return 0;
+}
+
+#ifdef GSI_FUZZ_REPLAY
+/* No libFuzzer: run each file named on the command line once */
+int main(int argc, char **argv) {
+    LLVMFuzzerInitialize(&argc, &argv);
+    int ran = 0;
+    for (int i = 1; i < argc; i++) {
+        FILE *f = fopen(argv[i], "rb");
+        if (!f) continue;
+        uint8_t *data = malloc(1 << 20);
+        size_t n = data ? fread(data, 1, 1 << 20, f) : 0;
+        fclose(f);
+        if (!data) return 1;
+        LLVMFuzzerTestOneInput(data, n);
+        free(data);
+        ran++;
+    }
+    printf("[FUZZ] %d seeds replayed\n", ran);
+    report();
+    return 0;
+}
+#endif
@@ -0,0 +1,188 @@
+/*
+ * gsi.c - GSI request framing and a bounded scan of the JSON payload
+ *
+ * Not a JSON parser: the payload is walked just far enough to find the
+ * round, player.state and the active weapon. Every scan is bounded by the
+ * received length; the round, the state and each weapon are delimited by
+ * matching braces (skipping strings), so their fields are looked up only
+ * inside them.
+ */
+
+#include "gsi.h"
+#include <string.h>
+
+#define GSI_MAX_CONTENT_LENGTH  (1 << 30)
+
+/* First occurrence of needle in [p, end), or NULL. Keys all start with a
+ * quote, which is everywhere in JSON, so memchr looks for the byte after. */
+static const char *find(const char *p, const char *end, const char *needle) {
+    size_t n = strlen(needle);
+    size_t lead = n > 1 ? 1 : 0;
+    while (p && (size_t)(end - p) >= n) {
+        const char *q = memchr(p + lead, needle[lead], (size_t)(end - p) - n + 1);
+        if (!q) return NULL;
+        q -= lead;
+        if (memcmp(q, needle, n) == 0) return q;
+        p = q + 1;
+    }
+    return NULL;
+}
+
+static const char *skip_ws(const char *p, const char *end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) p++;
+    return p;
+}
+
+/* p at an opening quote; returns just past the closing one, or end. */
+static const char *skip_string(const char *p, const char *end) {
+    p++;
+    while (p < end) {
+        if (*p == '\\') p += (end - p >= 2) ? 2 : 1;
+        else if (*p++ == '"') return p;
+    }
+    return end;
+}
+
+/* p at '{'; returns just past the matching '}', or end if it never closes. */
+static const char *object_end(const char *p, const char *end) {
+    long depth = 0;
+    while (p < end) {
+        char c = *p;
+        if (c == '"') {
+            p = skip_string(p, end);
+            continue;
+        }
+        if (c == '{') depth++;
+        else if (c == '}' && --depth == 0) return p + 1;
+        p++;
+    }
+    return end;
+}
+
+/* Value of the first "key": in [start, end) whose value starts with want
+ * ('{' or '"'; 0 = anything). Returns the value's first byte or NULL. */
+static const char *find_value(const char *start, const char *end, const char *key, char want) {
+    const char *k = start;
+    while ((k = find(k, end, key)) != NULL) {
+        const char *v = skip_ws(k + strlen(key), end);
+        if (v < end && *v == ':') {
+            v = skip_ws(v + 1, end);
+            if (v < end && (!want || *v == want)) return v;
+        }
+        k++;
+    }
+    return NULL;
+}
+
+static bool json_extract_str(const char *start, const char *end, const char *key,
+                             char *buf, int buf_size) {
+    buf[0] = '\0';
+    const char *k = find_value(start, end, key, '"');
+    if (!k) return false;
+    k++;
+    int i = 0;
+    while (k < end && *k != '"' && i < buf_size - 1) buf[i++] = *k++;
+    buf[i] = '\0';
+    return true;
+}
+
+static int json_extract_int(const char *start, const char *end, const char *key) {
+    const char *k = find_value(start, end, key, 0);
+    if (!k || k >= end || *k < '0' || *k > '9') return -1;
+    int v = 0;
+    while (k < end && *k >= '0' && *k <= '9' && v < 1000000) v = v * 10 + (*k++ - '0');
+    return v;
+}
+
+void gsi_parse(const char *json, int len, GsiUpdate *out) {
+    memset(out, 0, sizeof(*out));
+    out->health = -1;
+    if (!json || len <= 0) return;
+    const char *end = json + len;
+
+    /* "round" the object, not map.round (the round number) */
+    const char *round = find_value(json, end, "\"round\"", '{');
+    if (round)
+        json_extract_str(round, object_end(round, end), "\"phase\"",
+                         out->round_phase, sizeof(out->round_phase));
+
+    /* Lookups start at "player" (spectators also get "allplayers") */
+    const char *player = find_value(json, end, "\"player\"", '{');
+    if (!player) player = json;
+
+    /* player.state is an object; each weapon's "state" is a string */
+    const char *state = find_value(player, end, "\"state\"", '{');
+    if (state) out->health = json_extract_int(state, object_end(state, end), "\"health\"");
+
+    /* Active weapon: the child of "weapons" whose state is "active" */
+    const char *weapons = find_value(player, end, "\"weapons\"", '{');
+    if (!weapons) return;
+    const char *p = weapons + 1;
+    while (p < end && *p != '}') {
+        if (*p == '"') {
+            p = skip_string(p, end);
+            continue;
+        }
+        if (*p != '{') {
+            p++;
+            continue;
+        }
+        const char *w = p;
+        p = object_end(w, end);
+        char wstate[16];
+        if (json_extract_str(w, p, "\"state\"", wstate, sizeof(wstate)) &&
+            strcmp(wstate, "active") == 0) {
+            json_extract_str(w, p, "\"name\"", out->weapon_name, sizeof(out->weapon_name));
+            json_extract_str(w, p, "\"type\"", out->weapon_type, sizeof(out->weapon_type));
+            return;
+        }
+    }
+}
+
+/* ---------- HTTP framing ---------- */
+
+static bool header_is(const char *line, const char *eol, const char *name, const char **value) {
+    size_t n = strlen(name);
+    if ((size_t)(eol - line) <= n) return false;
+    for (size_t i = 0; i < n; i++) {
+        char c = line[i];
+        if (c >= 'A' && c <= 'Z') c = (char)(c - 'A' + 'a');
+        if (c != name[i]) return false;
+    }
+    const char *p = line + n;
+    while (p < eol && (*p == ' ' || *p == '\t')) p++;
+    if (p >= eol || *p != ':') return false;
+    p++;
+    while (p < eol && (*p == ' ' || *p == '\t')) p++;
+    *value = p;
+    return true;
+}
+
+int gsi_http_body(const char *buf, int total, const char **body, bool *complete) {
+    *body = NULL;
+    *complete = false;
+    if (!buf || total <= 0) return -1;
+    const char *end = buf + total;
+    const char *hdr_end = find(buf, end, "\r\n\r\n");
+    if (!hdr_end) return -1;
+
+    /* Content-Length from the header block only, never from the body */
+    long content_length = 0;
+    const char *line = buf;
+    while (line < hdr_end) {
+        const char *eol = find(line, hdr_end, "\r\n");
+        if (!eol) eol = hdr_end;
+        const char *v;
+        if (header_is(line, eol, "content-length", &v)) {
+            content_length = 0;
+            while (v < eol && *v >= '0' && *v <= '9' && content_length < GSI_MAX_CONTENT_LENGTH)
+                content_length = content_length * 10 + (*v++ - '0');
+        }
+        line = eol + 2;
+    }
+
+    *body = hdr_end + 4;
+    int received = (int)(end - *body);
+    *complete = received >= content_length;
+    return content_length < received ? (int)content_length : received;
+}
@@ -0,0 +1,39 @@
+/*
+ * gsi.h - CS2 Game State Integration: HTTP framing and payload parsing
+ *
+ * CS2 POSTs the game state as JSON to the GSI server once per change. These
+ * functions take the received bytes apart without touching the network or
+ * any shared state, so the server thread, the benchmarks and the fuzz
+ * harness all drive the same code.
+ *
+ * Both only read inside the length they are given; neither needs the data
+ * to be NUL-terminated or well formed. Malformed input yields missing
+ * fields, never a read past the end.
+ */
+
+#ifndef GSI_H
+#define GSI_H
+
+#include <stdbool.h>
+
+#define GSI_BUF_SIZE 8192       /* request buffer; longer requests are cut off */
+
+typedef struct {
+    char weapon_name[64];       /* active weapon, "" if not in the payload */
+    char weapon_type[32];
+    char round_phase[16];       /* "live", "freezetime", "over" */
+    int health;                 /* -1 = not in the payload */
+} GsiUpdate;
+
+/*
+ * Locate the body of the HTTP request in buf[0..total). Returns -1 until
+ * the header block is complete, then the body length: Content-Length
+ * clipped to the bytes received (0 without the header). *complete is set
+ * once all Content-Length bytes are in.
+ */
+int gsi_http_body(const char *buf, int total, const char **body, bool *complete);
+
+/* Pick the round phase, player health and active weapon out of json[0..len). */
+void gsi_parse(const char *json, int len, GsiUpdate *out);
+
+#endif /* GSI_H */
@@ -0,0 +1,127 @@
+/*
+ * hid_queue.c - Per-keyboard HID writer thread
+ *
+ * Producer: the sampling loop, via hid_queue_push() (ring push + event).
+ * Consumer: hidq_thread, which is the only code touching the HID handle
+ * while the queue runs.
+ */
+
+#include "hid_queue.h"
+#include <stdio.h>
+#include <string.h>
+#include "frame_trace.h"
+#include "instrument.h"
+
+/* Wake-up check while nothing is queued, so a stop is noticed promptly */
+#define HIDQ_IDLE_WAIT_MS 100
+
+static bool key_equal(const KeySetting *a, const KeySetting *b) {
+    return a->row == b->row && a->col == b->col && a->mm == b->mm;
+}
+
+/* Keys of `want` the board doesn't have yet; all of them when unknown */
+static int hidq_changed(const KeySetting *want, const KeySetting *sent, int count,
+                        bool known, KeySetting *out) {
+    int n = 0;
+    for (int i = 0; i < count; i++)
+        if (!known || !key_equal(&want[i], &sent[i])) out[n++] = want[i];
+    return n;
+}
+
+static void hidq_write(HidQueue *q, const HidWriteJob *job) {
+    bool known = q->sent_count == job->count;
+    KeySetting ap[HIDQ_MAX_KEYS], rt[HIDQ_MAX_KEYS];
+    int n_ap = hidq_changed(job->ap, q->sent_ap, job->count, known, ap);
+    int n_rt = hidq_changed(job->rt, q->sent_rt, job->count, known, rt);
+    if (n_ap == 0 && n_rt == 0) return;
+
+    double freq = (double)plat_tick_freq();
+    if (ftrace_on()) ftrace_frame(job->frame);
+
+    int64_t start = plat_ticks();
+    bool ok = true;
+    if (n_ap) ok &= wooting_hid_write_actuation(q->hid, q->profile_idx, ap, n_ap, false);
+    if (n_rt) ok &= wooting_hid_write_rt(q->hid, q->profile_idx, rt, n_rt, false);
+    int64_t done = plat_ticks();
+
+    /* After a failure the board's state is unknown: resend in full */
+    if (ok) {
+        memcpy(q->sent_ap, job->ap, (size_t)job->count * sizeof(KeySetting));
+        memcpy(q->sent_rt, job->rt, (size_t)job->count * sizeof(KeySetting));
+        q->sent_count = job->count;
+    } else {
+        q->sent_count = 0;
+    }
+
+    if (q->metrics) {
+        metric_add(&q->metrics->writes, 1);
+        if (!ok) metric_add(&q->metrics->failures, 1);
+        metric_observe(&q->metrics->latency, &metric_bounds_hid,
+                       (uint64_t)((double)(done - start) * 1000000.0 / freq));
+    }
+}
+
+/* Newest queued job, older ones discarded. False when the ring is empty. */
+static bool hidq_take_newest(HidQueue *q, HidWriteJob *job) {
+    bool got = false;
+    while (spsc_pop(&q->ring, job)) got = true;
+    return got;
+}
+
+static void hidq_thread(void *param) {
+    HidQueue *q = param;
+    ftrace_thread(q->name);
+    INS_THREAD(q->name);
+
+    HidWriteJob job;
+    while (atomic_load_explicit(&q->running, memory_order_acquire)) {
+        if (hidq_take_newest(q, &job)) hidq_write(q, &job);
+        else plat_event_wait(&q->wake, HIDQ_IDLE_WAIT_MS);
+    }
+
+    if (hidq_take_newest(q, &job)) hidq_write(q, &job);
+}
+
+bool hid_queue_start(HidQueue *q, WootingHID *hid, int profile_idx,
+                     HidMetrics *metrics, const char *name) {
+    q->hid = hid;
+    q->profile_idx = profile_idx;
+    q->metrics = metrics;
+    q->sent_count = 0;
+    snprintf(q->name, sizeof(q->name), "%s", name);
+    spsc_init(&q->ring, q->slots, HIDQ_RING_SIZE, sizeof(HidWriteJob));
+    atomic_init(&q->dropped, 0);
+    atomic_init(&q->running, false);
+    q->abandoned = false;
+
+    if (!plat_event_init(&q->wake)) return false;
+    atomic_store(&q->running, true);
+    if (!plat_thread_start(&q->thread, hidq_thread, q, PLAT_PRIO_NORMAL)) {
+        atomic_store(&q->running, false);
+        plat_event_destroy(&q->wake);
+        printf("[HID] Failed to start %s writer thread.\n", q->name);
+        return false;
+    }
+    return true;
+}
+
+bool hid_queue_push(HidQueue *q, const HidWriteJob *job) {
+    if (!spsc_push(&q->ring, job)) {
+        atomic_fetch_add_explicit(&q->dropped, 1, memory_order_relaxed);
+        return false;
+    }
+    plat_event_signal(&q->wake);
+    return true;
+}
+
+bool hid_queue_stop(HidQueue *q) {
+    if (!atomic_exchange(&q->running, false)) return !q->abandoned;
+    plat_event_signal(&q->wake);
+    if (!plat_thread_join(&q->thread, 3000)) {
+        /* Stuck in a report: it still waits on the event and owns the handle */
+        q->abandoned = true;
+        return false;
+    }
+    plat_event_destroy(&q->wake);
+    return true;
+}
@@ -0,0 +1,73 @@
+/*
+ * hid_queue.h - Per-keyboard HID writer thread
+ *
+ * The sampling loop hands a keyboard's new AP/RT targets to that
+ * keyboard's writer through a lock-free ring and moves on. The writer owns
+ * the HID handle and does the blocking reports and ack reads, so a slow or
+ * unplugged board never stalls sampling of the others. Targets that pile
+ * up during a write are coalesced: only the newest is sent.
+ *
+ * Jobs carry every adaptive key; the writer diffs them against what the
+ * board already has and sends the changed keys of each command as one
+ * batched report, or nothing when a command has no changes.
+ */
+
+#ifndef HID_QUEUE_H
+#define HID_QUEUE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "platform.h"
+#include "spsc_ring.h"
+#include "hid_writer.h"
+#include "metrics.h"
+
+#define HIDQ_RING_SIZE  16       /* power of two */
+#define HIDQ_MAX_KEYS   WOOTING_MAX_KEYS  /* keys per write batch */
+
+/* One AP + RT update for a set of keys */
+typedef struct {
+    int64_t ticks;               /* plat_ticks() when queued */
+    uint64_t frame;              /* sampler frame, for the frame trace */
+    int count;
+    KeySetting ap[HIDQ_MAX_KEYS];
+    KeySetting rt[HIDQ_MAX_KEYS];
+} HidWriteJob;
+
+typedef struct {
+    WootingHID *hid;
+    int profile_idx;
+    char name[16];               /* writer thread's trace / instrument name */
+    HidMetrics *metrics;         /* optional */
+    KeySetting sent_ap[HIDQ_MAX_KEYS];  /* writer side: what the board has */
+    KeySetting sent_rt[HIDQ_MAX_KEYS];
+    int sent_count;              /* 0 = unknown, send everything */
+    SpscRing ring;
+    HidWriteJob slots[HIDQ_RING_SIZE];
+    PlatEvent wake;
+    PlatThread thread;
+    atomic_bool running;
+    atomic_uint dropped;         /* jobs refused by a full ring */
+    bool abandoned;              /* writer outlived hid_queue_stop() */
+} HidQueue;
+
+/*
+ * Start the writer thread for an opened, handshaken keyboard. The queue
+ * does not own `hid`: close it after hid_queue_stop().
+ */
+bool hid_queue_start(HidQueue *q, WootingHID *hid, int profile_idx,
+                     HidMetrics *metrics, const char *name);
+
+/* Sampler side: a handful of stores and a wake-up. False = ring full. */
+bool hid_queue_push(HidQueue *q, const HidWriteJob *job);
+
+/*
+ * Write whatever is still queued, then stop the thread. Safe to call on a
+ * queue that never started, and more than once. False when the writer did
+ * not exit in time: it still uses the queue and `hid`, so neither may be
+ * reused, closed or freed.
+ */
+bool hid_queue_stop(HidQueue *q);
+
+#endif /* HID_QUEUE_H */
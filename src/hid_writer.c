@@ -10,7 +10,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <windows.h>
+#include <stdatomic.h>
+#include "platform.h"
+#include "frame_trace.h"
+#include "instrument.h"
 #include <hidapi/hidapi.h>
 
 /* Wooting vendor ID */
@@ -24,6 +27,10 @@
 #define MAGIC_0  0xD1
 #define MAGIC_1  0xDA
 
+/* Ack polling: short reads until the firmware answers or the deadline */
+#define ACK_POLL_MS     1
+#define ACK_TIMEOUT_MS  100
+
 /* Handshake secret */
 #define HANDSHAKE_BYTE  0x01
 #define HANDSHAKE_MAGIC 0x7A45465E
@@ -40,9 +47,28 @@ static const int REPORT_SIZES[] = {
 };
 #define NUM_REPORT_SIZES 7
 
+/* Firmware capabilities learned at handshake, kept in the device cache */
+#define CAP_FEATURE_HANDSHAKE  0x01   /* feature-report handshake answers 0x88 */
+#define CAP_DATA_HANDSHAKE     0x02   /* needs the data-report handshake */
+
+/* Device cache: a few boards, most recently opened first */
+#define CACHE_MAX_ENTRIES  8
+#define CACHE_SERIAL_LEN   64
+#define CACHE_PATH_LEN     512
+
+typedef struct {
+    char serial[CACHE_SERIAL_LEN];
+    unsigned vid, pid, release;
+    int iface;
+    unsigned caps;
+    char path[CACHE_PATH_LEN];
+} CacheEntry;
+
 struct WootingHID {
     hid_device *handle;
     int active_profile;
+    CacheEntry id;              /* identity + caps, as cached */
+    char cache_path[CACHE_PATH_LEN];  /* "" = no cache */
 };
 
 /* ---------- helpers ---------- */
@@ -67,6 +93,36 @@ static uint16_t encode_key_entry(uint8_t firmware_val, uint8_t row, uint8_t col)
     return (uint16_t)((firmware_val << 8) | idx);
 }
 
+/* 60HE matrix by HID usage (ANSI). Row 0 (F-row) and the nav cluster
+ * don't exist on this board; Esc sits where ` is on full-size boards. */
+static const struct { uint8_t usage, row, col; } KEY_MATRIX[WOOTING_MAX_KEYS] = {
+    { 0x29, 1, 0 },  { 0x1E, 1, 1 },  { 0x1F, 1, 2 },  { 0x20, 1, 3 },  { 0x21, 1, 4 },
+    { 0x22, 1, 5 },  { 0x23, 1, 6 },  { 0x24, 1, 7 },  { 0x25, 1, 8 },  { 0x26, 1, 9 },
+    { 0x27, 1, 10 }, { 0x2D, 1, 11 }, { 0x2E, 1, 12 }, { 0x2A, 1, 13 },
+    { 0x2B, 2, 0 },  { 0x14, 2, 1 },  { 0x1A, 2, 2 },  { 0x08, 2, 3 },  { 0x15, 2, 4 },
+    { 0x17, 2, 5 },  { 0x1C, 2, 6 },  { 0x18, 2, 7 },  { 0x0C, 2, 8 },  { 0x12, 2, 9 },
+    { 0x13, 2, 10 }, { 0x2F, 2, 11 }, { 0x30, 2, 12 }, { 0x31, 2, 13 },
+    { 0x39, 3, 0 },  { 0x04, 3, 1 },  { 0x16, 3, 2 },  { 0x07, 3, 3 },  { 0x09, 3, 4 },
+    { 0x0A, 3, 5 },  { 0x0B, 3, 6 },  { 0x0D, 3, 7 },  { 0x0E, 3, 8 },  { 0x0F, 3, 9 },
+    { 0x33, 3, 10 }, { 0x34, 3, 11 }, { 0x28, 3, 13 },
+    { 0xE1, 4, 0 },  { 0x1D, 4, 2 },  { 0x1B, 4, 3 },  { 0x06, 4, 4 },  { 0x19, 4, 5 },
+    { 0x05, 4, 6 },  { 0x11, 4, 7 },  { 0x10, 4, 8 },  { 0x36, 4, 9 },  { 0x37, 4, 10 },
+    { 0x38, 4, 11 }, { 0xE5, 4, 13 },
+    { 0xE0, 5, 0 },  { 0xE3, 5, 1 },  { 0xE2, 5, 2 },  { 0x2C, 5, 6 },  { 0xE6, 5, 10 },
+    { 0xE7, 5, 11 }, { 0x65, 5, 12 }, { 0xE4, 5, 13 },
+};
+
+bool wooting_key_position(uint8_t usage, uint8_t *row, uint8_t *col) {
+    for (int i = 0; i < WOOTING_MAX_KEYS; i++) {
+        if (KEY_MATRIX[i].usage == usage) {
+            *row = KEY_MATRIX[i].row;
+            *col = KEY_MATRIX[i].col;
+            return true;
+        }
+    }
+    return false;
+}
+
 /* Encode a uint16 as protobuf varint, return bytes written */
 static int encode_varint(uint8_t *buf, uint32_t value) {
     int i = 0;
@@ -173,6 +229,39 @@ static int read_input_response(WootingHID *dev, uint8_t *body, int body_size, in
     return parse_response(buf, ret, 1, body, body_size, body_len);
 }
 
+static const char *status_name(int status) {
+    switch (status) {
+    case STATUS_SUCCESS:     return "ok";
+    case STATUS_BUSY:        return "busy";
+    case STATUS_UNSUPPORTED: return "unsupported";
+    case -1:                 return "no ack";
+    default:                 return "unknown";
+    }
+}
+
+/*
+ * Poll input reports for the ack to `cmd`, ACK_POLL_MS at a time, for up
+ * to timeout_ms. Reports for other commands are skipped and "busy" keeps
+ * waiting. Returns the status byte, or -1 if nothing conclusive arrived.
+ */
+static int wait_ack(WootingHID *dev, uint8_t cmd, int timeout_ms) {
+    uint8_t buf[2048];
+    uint32_t start = plat_ms();
+    int status = -1;
+
+    do {
+        int ret = hid_read_timeout(dev->handle, buf, sizeof(buf), ACK_POLL_MS);
+        if (ret < 0) return -1;
+        if (ret < 4 || buf[3] != cmd) continue;
+
+        /* [rid, D1, DA, cmd_echo, status, ...] as in read_input_response */
+        status = parse_response(buf, ret, 1, NULL, 0, NULL);
+        if (status >= 0 && status != STATUS_BUSY) return status;
+    } while ((int)(plat_ms() - start) < timeout_ms);
+
+    return status == STATUS_BUSY ? STATUS_BUSY : -1;
+}
+
 /*
  * Send a data report (protoWithOptions format).
  * Format: [report_id, magic(2), cmd, options, bodylen_le(2), protobuf..., padding]
@@ -198,20 +287,33 @@ static bool send_data(WootingHID *dev, uint8_t cmd, uint8_t options,
     buf[6] = (uint8_t)((proto_len >> 8) & 0xFF);
     memcpy(buf + 7, proto, proto_len);
 
+    int64_t t0 = ftrace_on() ? plat_ticks() : 0;
+    INS_TIME_BEGIN(ins_t);
     int ret = hid_write(dev->handle, buf, buf_size);
+    INS_TIME_END(IT_HID_WRITE, ins_t);
     free(buf);
+    int64_t t1 = ftrace_on() ? plat_ticks() : 0;
+    if (ftrace_on()) ftrace_span(FT_HID_WRITE, t0, t1, cmd);
+    INS_ADD(IC_HID_REPORTS, 1);
+    INS_ADD(IC_HID_BYTES, buf_size);
 
     if (ret < 0) {
+        INS_ADD(IC_HID_FAILURES, 1);
         fprintf(stderr, "[HID] send_data failed: %ls\n", hid_error(dev->handle));
         return false;
     }
 
     /* Delay after write - shorter for RAM-only writes */
     bool is_save = (options & 1);
-    Sleep(is_save ? 50 : 5);
+    INS_TIME_BEGIN(ins_ack);
+    plat_sleep_ms(is_save ? 50 : 5);
 
     /* Flush any response */
-    { uint8_t tmp[2048]; hid_read_timeout(dev->handle, tmp, sizeof(tmp), is_save ? 50 : 5); }
+    uint8_t tmp[2048];
+    int got = hid_read_timeout(dev->handle, tmp, sizeof(tmp), is_save ? 50 : 5);
+    if (ftrace_on()) ftrace_span(FT_HID_ACK, t1, plat_ticks(), got > 0 ? got : 0);
+    INS_TIME_END(IT_HID_ACK, ins_ack);
+    if (got > 0) INS_ADD(IC_HID_ACKS, 1);
 
     return true;
 }
@@ -250,22 +352,199 @@ static int build_partial_proto(uint8_t *buf, int buf_size,
     return pos;
 }
 
-/* ---------- public API ---------- */
+/* ---------- device cache ---------- */
 
-WootingHID *wooting_hid_open(void) {
-    if (hid_init() != 0) {
-        fprintf(stderr, "[HID] hid_init() failed\n");
-        return NULL;
+/*
+ * Text file, one line per board:
+ *   serial <TAB> vid <TAB> pid <TAB> release <TAB> iface <TAB> caps <TAB> path
+ * Anything unparsable is skipped; a missing or stale cache only costs the
+ * enumeration it was meant to save.
+ */
+static int cache_load(const char *file, CacheEntry *e, int max) {
+    FILE *f = fopen(file, "r");
+    if (!f) return 0;
+
+    char line[CACHE_SERIAL_LEN + CACHE_PATH_LEN + 64];
+    int n = 0;
+    while (n < max && fgets(line, sizeof(line), f)) {
+        if (line[0] == '#') continue;
+        line[strcspn(line, "\r\n")] = 0;
+
+        char *field[7];
+        int nf = 0;
+        for (char *p = line; nf < 7; nf++) {
+            field[nf] = p;
+            char *tab = strchr(p, '\t');
+            if (!tab) { nf++; break; }
+            *tab = 0;
+            p = tab + 1;
+        }
+        if (nf != 7 || !field[0][0] || !field[6][0]) continue;
+
+        CacheEntry *c = &e[n];
+        snprintf(c->serial, sizeof(c->serial), "%s", field[0]);
+        c->vid = (unsigned)strtoul(field[1], NULL, 16);
+        c->pid = (unsigned)strtoul(field[2], NULL, 16);
+        c->release = (unsigned)strtoul(field[3], NULL, 16);
+        c->iface = atoi(field[4]);
+        c->caps = (unsigned)strtoul(field[5], NULL, 16);
+        snprintf(c->path, sizeof(c->path), "%s", field[6]);
+        n++;
+    }
+    fclose(f);
+    return n;
+}
+
+static void cache_write_entry(FILE *f, const CacheEntry *e) {
+    fprintf(f, "%s\t%04X\t%04X\t%04X\t%d\t%X\t%s\n",
+            e->serial, e->vid, e->pid, e->release, e->iface, e->caps, e->path);
+}
+
+static bool cache_entry_equal(const CacheEntry *a, const CacheEntry *b) {
+    return strcmp(a->serial, b->serial) == 0 && strcmp(a->path, b->path) == 0 &&
+           a->vid == b->vid && a->pid == b->pid && a->release == b->release &&
+           a->iface == b->iface && a->caps == b->caps;
+}
+
+/* Put `id` first, keep the other boards behind it. No-op if already there. */
+static void cache_store(const char *file, const CacheEntry *id) {
+    if (!file[0] || !id->serial[0]) return;
+
+    CacheEntry old[CACHE_MAX_ENTRIES];
+    int n = cache_load(file, old, CACHE_MAX_ENTRIES);
+    if (n > 0 && cache_entry_equal(&old[0], id)) return;
+
+    FILE *f = fopen(file, "w");
+    if (!f) return;
+    fprintf(f, "# wooting-aim device cache: serial vid pid release iface caps path\n");
+    cache_write_entry(f, id);
+    int kept = 1;
+    for (int i = 0; i < n && kept < CACHE_MAX_ENTRIES; i++) {
+        if (strcmp(old[i].serial, id->serial) == 0) continue;
+        cache_write_entry(f, &old[i]);
+        kept++;
+    }
+    fclose(f);
+}
+
+/*
+ * Serial as the cache keys boards: printable ASCII, anything else as '?',
+ * so it reads the same in every locale and never holds a tab. False (and
+ * "") when it is empty or does not fit.
+ */
+static bool serial_key(const wchar_t *w, char *out, size_t size) {
+    size_t n = 0;
+    for (; w && w[n]; n++) {
+        if (n + 1 >= size) {
+            out[0] = 0;
+            return false;
+        }
+        out[n] = w[n] > 0x20 && w[n] < 0x7F ? (char)w[n] : '?';
     }
+    out[n] = 0;
+    return n > 0;
+}
+
+/*
+ * Open a cached path and check it is still that board's vendor interface.
+ * The serial catches a different keyboard on a reused path; where hidapi
+ * can report it, the usage page catches a different interface of the same
+ * one (hidraw numbers shift after a USB reset).
+ */
+static hid_device *cache_try(const CacheEntry *c) {
+    hid_device *h = hid_open_path(c->path);
+    if (!h) return NULL;
+
+    /* One spare wchar: a serial hidapi had to cut short fails serial_key */
+    wchar_t wserial[CACHE_SERIAL_LEN + 1];
+    char serial[CACHE_SERIAL_LEN];
+    if (hid_get_serial_number_string(h, wserial, CACHE_SERIAL_LEN + 1) != 0) goto stale;
+    if (!serial_key(wserial, serial, sizeof(serial))) goto stale;
+    if (strcmp(serial, c->serial) != 0) goto stale;
+
+#if defined(HID_API_VERSION) && defined(HID_API_MAKE_VERSION)
+#if HID_API_VERSION >= HID_API_MAKE_VERSION(0, 13, 0)
+    struct hid_device_info *info = hid_get_device_info(h);
+    if (!info || info->usage_page != V3_USAGE_PAGE) goto stale;
+#endif
+#endif
+    return h;
+
+stale:
+    hid_close(h);
+    return NULL;
+}
+
+/* SipHash-1-3 with zero keys: Rust's DefaultHasher, which the SDK uses */
+#define SIP_ROTL(x, b) (uint64_t)(((x) << (b)) | ((x) >> (64 - (b))))
+#define SIP_ROUND(v0, v1, v2, v3) do {                                   \
+    v0 += v1; v1 = SIP_ROTL(v1, 13); v1 ^= v0; v0 = SIP_ROTL(v0, 32); \
+    v2 += v3; v3 = SIP_ROTL(v3, 16); v3 ^= v2;                         \
+    v0 += v3; v3 = SIP_ROTL(v3, 21); v3 ^= v0;                         \
+    v2 += v1; v1 = SIP_ROTL(v1, 17); v1 ^= v2; v2 = SIP_ROTL(v2, 32); \
+} while (0)
+
+static uint64_t siphash13(const uint8_t *in, size_t len) {
+    uint64_t v0 = 0x736f6d6570736575ULL, v1 = 0x646f72616e646f6dULL;
+    uint64_t v2 = 0x6c7967656e657261ULL, v3 = 0x7465646279746573ULL;
+    uint64_t b = (uint64_t)len << 56;
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t m = 0;
+        for (int k = 0; k < 8; k++) m |= (uint64_t)in[i + k] << (8 * k);
+        v3 ^= m;
+        SIP_ROUND(v0, v1, v2, v3);
+        v0 ^= m;
+    }
+    for (int k = 0; i + k < len; k++) b |= (uint64_t)in[i + k] << (8 * k);
+    v3 ^= b;
+    SIP_ROUND(v0, v1, v2, v3);
+    v0 ^= b;
+    v2 ^= 0xFF;
+    for (int r = 0; r < 3; r++) SIP_ROUND(v0, v1, v2, v3);
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+uint64_t wooting_device_id(uint16_t vid, uint16_t pid, const char *serial) {
+    /* vid.hash(), pid.hash(), serial.hash(): LE u16s, the bytes, 0xFF */
+    uint8_t buf[4 + CACHE_SERIAL_LEN + 1];
+    size_t n = strlen(serial);
+    if (n > CACHE_SERIAL_LEN) n = CACHE_SERIAL_LEN;
+    buf[0] = (uint8_t)vid;
+    buf[1] = (uint8_t)(vid >> 8);
+    buf[2] = (uint8_t)pid;
+    buf[3] = (uint8_t)(pid >> 8);
+    memcpy(buf + 4, serial, n);
+    buf[4 + n] = 0xFF;
+    return siphash13(buf, 4 + n + 1);
+}
 
-    /* Enumerate Wooting devices, find the one with vendor usage page */
+/* Board filter for wooting_hid_open_match(): the SDK's device ID, 0 = any */
+typedef struct {
+    uint64_t device_id;
+} Match;
+
+static bool match_ok(const Match *m, unsigned vid, unsigned pid, const char *serial) {
+    return !m->device_id || wooting_device_id((uint16_t)vid, (uint16_t)pid, serial) == m->device_id;
+}
+
+/* Full enumeration: first matching Wooting interface on the vendor usage page */
+static hid_device *enumerate_open(const Match *m, CacheEntry *id) {
     struct hid_device_info *devs = hid_enumerate(WOOTING_VID, 0);
     struct hid_device_info *cur = devs;
-    char *path = NULL;
+    bool found = false;
 
     while (cur) {
-        if (cur->usage_page == V3_USAGE_PAGE) {
-            path = _strdup(cur->path);
+        char serial[CACHE_SERIAL_LEN];
+        serial_key(cur->serial_number, serial, sizeof(serial));
+        if (cur->usage_page == V3_USAGE_PAGE && match_ok(m, cur->vendor_id, cur->product_id, serial)) {
+            found = true;
+            snprintf(id->serial, sizeof(id->serial), "%s", serial);
+            id->vid = cur->vendor_id;
+            id->pid = cur->product_id;
+            id->release = cur->release_number;
+            id->iface = cur->interface_number;
+            snprintf(id->path, sizeof(id->path), "%s", cur->path);
             printf("[HID] Found: %ls (VID:%04X PID:%04X) usage_page:0x%04X iface:%d\n",
                    cur->product_string, cur->vendor_id, cur->product_id,
                    cur->usage_page, cur->interface_number);
@@ -275,19 +554,66 @@ WootingHID *wooting_hid_open(void) {
     }
     hid_free_enumeration(devs);
 
-    if (!path) {
-        fprintf(stderr, "[HID] No Wooting device found with usage page 0x%04X\n",
-                V3_USAGE_PAGE);
+    if (!found) {
+        if (m->device_id)
+            fprintf(stderr, "[HID] No Wooting device with a serial matching SDK device %016llX\n",
+                    (unsigned long long)m->device_id);
+        else
+            fprintf(stderr, "[HID] No Wooting device found with usage page 0x%04X\n",
+                    V3_USAGE_PAGE);
         return NULL;
     }
 
-    hid_device *handle = hid_open_path(path);
-    free(path);
-
-    if (!handle) {
+    hid_device *handle = hid_open_path(id->path);
+    if (!handle)
         fprintf(stderr, "[HID] hid_open_path() failed: %ls\n", hid_error(NULL));
+    return handle;
+}
+
+/* ---------- public API ---------- */
+
+/* Open handles; hidapi is torn down when the last one closes */
+static atomic_int g_hid_users;
+
+WootingHID *wooting_hid_open(const char *cache_path) {
+    return wooting_hid_open_match(cache_path, 0);
+}
+
+WootingHID *wooting_hid_open_match(const char *cache_path, uint64_t device_id) {
+    if (hid_init() != 0) {
+        fprintf(stderr, "[HID] hid_init() failed\n");
         return NULL;
     }
+    Match m = { device_id };
+
+    CacheEntry id = {0};
+    hid_device *handle = NULL;
+
+    /* Cached boards first: one open + a serial read instead of enumerating */
+    if (cache_path && cache_path[0]) {
+        CacheEntry cached[CACHE_MAX_ENTRIES];
+        int n = cache_load(cache_path, cached, CACHE_MAX_ENTRIES);
+        for (int i = 0; i < n && !handle; i++) {
+            if (!match_ok(&m, cached[i].vid, cached[i].pid, cached[i].serial)) continue;
+            handle = cache_try(&cached[i]);
+            if (handle) {
+                id = cached[i];
+                printf("[HID] Cached: %s (VID:%04X PID:%04X) iface:%d\n",
+                       id.serial, id.vid, id.pid, id.iface);
+            }
+        }
+        if (n > 0 && !handle)
+            printf("[HID] Device cache stale, enumerating.\n");
+    }
+
+    if (!handle) {
+        handle = enumerate_open(&m, &id);
+        if (!handle) {
+            if (atomic_load(&g_hid_users) == 0) hid_exit();
+            return NULL;
+        }
+    }
+    atomic_fetch_add(&g_hid_users, 1);
 
     /* Set non-blocking mode (matches Python implementation) */
     hid_set_nonblocking(handle, 1);
@@ -295,6 +621,9 @@ WootingHID *wooting_hid_open(void) {
     WootingHID *dev = calloc(1, sizeof(WootingHID));
     dev->handle = handle;
     dev->active_profile = -1;
+    dev->id = id;
+    if (cache_path) snprintf(dev->cache_path, sizeof(dev->cache_path), "%s", cache_path);
+    cache_store(dev->cache_path, &dev->id);
 
     printf("[HID] Device opened (non-blocking)\n");
     return dev;
@@ -304,7 +633,19 @@ void wooting_hid_close(WootingHID *dev) {
     if (!dev) return;
     if (dev->handle) hid_close(dev->handle);
     free(dev);
-    hid_exit();
+    if (atomic_fetch_sub(&g_hid_users, 1) == 1) hid_exit();
+}
+
+const char *wooting_hid_serial(const WootingHID *dev) {
+    return dev ? dev->id.serial : "";
+}
+
+uint64_t wooting_hid_device_id(const WootingHID *dev) {
+    return dev ? wooting_device_id(dev->id.vid, dev->id.pid, dev->id.serial) : 0;
+}
+
+uint16_t wooting_hid_product_id(const WootingHID *dev) {
+    return dev ? (uint16_t)dev->id.pid : 0;
 }
 
 bool wooting_hid_handshake(WootingHID *dev) {
@@ -312,14 +653,19 @@ bool wooting_hid_handshake(WootingHID *dev) {
 
     /*
      * Send handshake via feature report (simpler, more reliable).
-     * Then also send via data report as some firmware versions need it.
+     * Fall back to a data report, which some firmware versions need; the
+     * device cache remembers which one worked for the next open.
      */
 
-    /* Method 1: Feature report handshake */
-    bool ok = send_command(dev, CMD_HANDSHAKE, HANDSHAKE_MAGIC);
-    if (ok) {
+    /* Method 1: Feature report handshake, unless this board is known not
+     * to answer it (device cache) */
+    bool data_only = (dev->id.caps & CAP_DATA_HANDSHAKE) &&
+                     !(dev->id.caps & CAP_FEATURE_HANDSHAKE);
+    if (!data_only && send_command(dev, CMD_HANDSHAKE, HANDSHAKE_MAGIC)) {
         int status = read_feature_response(dev, NULL, 0, NULL);
         if (status == STATUS_SUCCESS) {
+            dev->id.caps = CAP_FEATURE_HANDSHAKE;
+            cache_store(dev->cache_path, &dev->id);
             printf("[HID] Handshake OK (feature report)\n");
             return true;
         }
@@ -352,14 +698,18 @@ bool wooting_hid_handshake(WootingHID *dev) {
         return false;
     }
 
-    /* Wait and flush reads (matches Python: sleep(0.05) + _flush_read()) */
-    Sleep(50);
-    {
-        uint8_t tmp[2048];
-        while (hid_read_timeout(dev->handle, tmp, sizeof(tmp), 50) > 0) {}
+    /* Done as soon as the firmware acks, instead of sleep(0.05) + flush */
+    int status = wait_ack(dev, CMD_HANDSHAKE, ACK_TIMEOUT_MS);
+    if (status != STATUS_SUCCESS && status != -1) {
+        fprintf(stderr, "[HID] Handshake rejected: %s (0x%02X)\n", status_name(status), status);
+        return false;
     }
 
-    printf("[HID] Handshake OK\n");
+    /* Only an ack proves the data path is the one to use: without one the
+     * board may just have been busy, so the next open probes both again */
+    dev->id.caps = status == STATUS_SUCCESS ? CAP_DATA_HANDSHAKE : 0;
+    cache_store(dev->cache_path, &dev->id);
+    printf("[HID] Handshake OK%s\n", status == -1 ? " (no ack)" : "");
     return true;
 }
 
@@ -371,8 +721,14 @@ bool wooting_hid_activate_profile(WootingHID *dev, int profile_idx) {
         fprintf(stderr, "[HID] Activate profile %d send failed\n", profile_idx);
         return false;
     }
-    Sleep(50);
-    { uint8_t tmp[2048]; while (hid_read_timeout(dev->handle, tmp, sizeof(tmp), 50) > 0) {} }
+    /* The ack normally arrives within a couple of ms; older firmware that
+     * doesn't ack is treated as before, as activated */
+    int status = wait_ack(dev, CMD_ACTIVATE_PROFILE, ACK_TIMEOUT_MS);
+    if (status != STATUS_SUCCESS && status != -1) {
+        fprintf(stderr, "[HID] Activate profile %d: %s (0x%02X)\n",
+                profile_idx, status_name(status), status);
+        return false;
+    }
 
     /* NOTE: Skip RELOAD for RAM writes - reload resets RAM back to flash defaults.
      * Python write_keys uses activate_profile(reload=False). */
@@ -419,7 +775,7 @@ bool wooting_hid_save_to_flash(WootingHID *dev) {
     if (!send_command(dev, CMD_SAVE_PROFILE, 0))
         return false;
 
-    Sleep(200);
+    plat_sleep_ms(200);
     { uint8_t tmp[2048]; while (hid_read_timeout(dev->handle, tmp, sizeof(tmp), 50) > 0) {} }
 
     printf("[HID] Save to flash sent\n");
@@ -21,6 +21,9 @@
 #define KEY_D_ROW 3
 #define KEY_D_COL 3
 
+/* Analog keys on the 60HE matrix (rows 1-5) */
+#define WOOTING_MAX_KEYS 61
+
 /* Report commands */
 #define CMD_ACTUATION       21
 #define CMD_RAPID_TRIGGER   25
@@ -48,9 +51,42 @@ typedef struct {
 
 /*
  * Open connection to Wooting keyboard via vendor HID interface.
+ * cache_path: device cache file (serial, path, interface, handshake caps).
+ * Cached boards are opened directly and validated by serial; enumeration
+ * only runs when none of them answers. NULL = always enumerate.
  * Returns NULL on failure.
  */
-WootingHID *wooting_hid_open(void);
+WootingHID *wooting_hid_open(const char *cache_path);
+
+/*
+ * Open one particular board when several are connected: the one whose
+ * VID, PID and serial hash to `device_id`, the Analog SDK's ID for it
+ * (0 = any). A board whose serial matches no SDK device is not opened.
+ * Handles may be opened and closed independently; hidapi is shut down
+ * with the last one.
+ */
+WootingHID *wooting_hid_open_match(const char *cache_path, uint64_t device_id);
+
+/*
+ * The Analog SDK's device ID for a board: Rust's DefaultHasher
+ * (SipHash-1-3, zero keys) over the VID, PID and serial number.
+ */
+uint64_t wooting_device_id(uint16_t vid, uint16_t pid, const char *serial);
+
+/* Serial number of the opened board ("" if it reports none). */
+const char *wooting_hid_serial(const WootingHID *dev);
+
+/* Analog SDK device ID of the opened board. */
+uint64_t wooting_hid_device_id(const WootingHID *dev);
+
+/* USB product ID of the opened board. */
+uint16_t wooting_hid_product_id(const WootingHID *dev);
+
+/*
+ * Matrix position of the key with HID usage `usage` on the 60HE.
+ * Returns false for usages that are not on its matrix.
+ */
+bool wooting_key_position(uint8_t usage, uint8_t *row, uint8_t *col);
 
 /*
  * Close connection and free resources.
@@ -71,7 +107,8 @@ bool wooting_hid_activate_profile(WootingHID *dev, int profile_idx);
 
 /*
  * Write actuation points for specific keys (RAM only, no flash save).
- * keys: array of KeySetting, count: number of entries.
+ * keys: array of KeySetting, count: number of entries. All of them go in
+ * one report; 61 keys fit report 3, larger batches move up to report 6.
  * profile_idx: 0-3.
  * Returns true on success.
  */
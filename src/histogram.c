@@ -0,0 +1,90 @@
+/*
+ * histogram.c - Log-bucketed (HDR-style) counter-strafe timing histograms
+ *
+ * Bucket layout (HIST_SUB_BITS = 4):
+ *   values 0..15 us       -> buckets 0..15 (exact)
+ *   octave [2^e, 2^(e+1)) -> 16 buckets of width 2^(e-4), for e = 4..24
+ */
+
+#include "histogram.h"
+
+const char *const strafe_quality_names[CSQ_COUNT] = { "PERF", "GOOD", "FAST", "LATE" };
+
+StrafeQuality strafe_quality(double ms) {
+    if (ms >= 65 && ms <= 95)  return CSQ_PERF;
+    if (ms >= 60 && ms <= 120) return CSQ_GOOD;
+    if (ms < 60)               return CSQ_FAST;
+    return CSQ_LATE;
+}
+
+static int msb32(uint32_t v) {
+    return 31 - __builtin_clz(v);
+}
+
+int hist_bucket(uint32_t us) {
+    if (us < HIST_SUB) return (int)us;
+    int msb = msb32(us);
+    if (msb > HIST_MAX_EXP) return HIST_BUCKETS - 1;
+    int shift = msb - HIST_SUB_BITS;
+    return HIST_SUB + shift * HIST_SUB + (int)((us >> shift) & (HIST_SUB - 1));
+}
+
+uint32_t hist_bucket_low(int idx) {
+    if (idx < HIST_SUB) return (uint32_t)idx;
+    int shift = (idx - HIST_SUB) / HIST_SUB;
+    int sub = (idx - HIST_SUB) % HIST_SUB;
+    return (uint32_t)(HIST_SUB + sub) << shift;
+}
+
+uint32_t hist_bucket_width(int idx) {
+    if (idx < HIST_SUB) return 1;
+    return 1u << ((idx - HIST_SUB) / HIST_SUB);
+}
+
+void hist_record(Histogram *h, double ms) {
+    uint32_t us = ms <= 0 ? 0 : (ms >= 4.0e6 ? 4000000000u : (uint32_t)(ms * 1000.0));
+    h->counts[hist_bucket(us)]++;
+    h->quality[strafe_quality(ms)]++;
+    if (h->total == 0 || us < h->min_us) h->min_us = us;
+    if (us > h->max_us) h->max_us = us;
+    h->total++;
+    h->sum_us += us;
+}
+
+void hist_merge(Histogram *dst, const Histogram *src) {
+    if (src->total == 0) return;
+    for (int i = 0; i < HIST_BUCKETS; i++) dst->counts[i] += src->counts[i];
+    for (int i = 0; i < CSQ_COUNT; i++) dst->quality[i] += src->quality[i];
+    if (dst->total == 0 || src->min_us < dst->min_us) dst->min_us = src->min_us;
+    if (src->max_us > dst->max_us) dst->max_us = src->max_us;
+    dst->total += src->total;
+    dst->sum_us += src->sum_us;
+}
+
+double hist_percentile(const Histogram *h, double p) {
+    if (h->total == 0) return 0.0;
+    if (p < 0) p = 0;
+    if (p > 100) p = 100;
+
+    /* Rank of the sample at percentile p (1-based, nearest-rank) */
+    uint64_t rank = (uint64_t)(p / 100.0 * (double)h->total + 0.5);
+    if (rank < 1) rank = 1;
+    if (rank >= h->total) return h->max_us / 1000.0;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        seen += h->counts[i];
+        if (seen >= rank) {
+            double mid = hist_bucket_low(i) + (hist_bucket_width(i) - 1) / 2.0;
+            /* Never report outside the observed range */
+            if (mid < h->min_us) mid = h->min_us;
+            if (mid > h->max_us) mid = h->max_us;
+            return mid / 1000.0;
+        }
+    }
+    return h->max_us / 1000.0;
+}
+
+double hist_mean(const Histogram *h) {
+    return h->total ? (double)h->sum_us / (double)h->total / 1000.0 : 0.0;
+}
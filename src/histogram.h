@@ -0,0 +1,68 @@
+/*
+ * histogram.h - Log-bucketed (HDR-style) counter-strafe timing histograms
+ *
+ * Values are recorded in microseconds into 16 linear sub-buckets per
+ * power of two, so any percentile is within 6.25% of the true sample,
+ * at a fixed ~1.4 KB per histogram and O(1) per recorded value.
+ * Also tracks the PERF/GOOD/FAST/LATE counter-strafe quality split.
+ */
+
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdint.h>
+
+#define HIST_SUB_BITS  4
+#define HIST_SUB       (1 << HIST_SUB_BITS)   /* sub-buckets per octave */
+#define HIST_MAX_EXP   24                     /* top octave: 2^24 us (~16.7 s) */
+#define HIST_BUCKETS   (HIST_SUB + (HIST_MAX_EXP - HIST_SUB_BITS + 1) * HIST_SUB)
+
+/*
+ * Counter-strafe quality classification (CS2ST research):
+ * Perfect: 65-95ms (80ms +/-15ms)
+ * Good: 60-120ms
+ * Late: >120ms, Early: <60ms
+ */
+typedef enum {
+    CSQ_PERF,
+    CSQ_GOOD,
+    CSQ_FAST,
+    CSQ_LATE,
+    CSQ_COUNT
+} StrafeQuality;
+
+extern const char *const strafe_quality_names[CSQ_COUNT];
+
+typedef struct {
+    uint32_t counts[HIST_BUCKETS];
+    uint32_t quality[CSQ_COUNT];
+    uint64_t total;
+    uint64_t sum_us;
+    uint32_t min_us;
+    uint32_t max_us;
+} Histogram;
+
+StrafeQuality strafe_quality(double ms);
+
+/* Bucket index for a value in microseconds (values past the top clamp). */
+int hist_bucket(uint32_t us);
+
+/* Smallest value (us) that maps to bucket `idx`, and the bucket width. */
+uint32_t hist_bucket_low(int idx);
+uint32_t hist_bucket_width(int idx);
+
+/* Record one counter-strafe duration. */
+void hist_record(Histogram *h, double ms);
+
+/* Add all samples of `src` into `dst`. */
+void hist_merge(Histogram *dst, const Histogram *src);
+
+/*
+ * Value (ms) at percentile p (0-100), reported as the midpoint of the
+ * bucket holding that rank. 0 for an empty histogram.
+ */
+double hist_percentile(const Histogram *h, double p);
+
+double hist_mean(const Histogram *h);
+
+#endif /* HISTOGRAM_H */
@@ -0,0 +1,105 @@
+/*
+ * instrument.c - Per-thread counter blocks for WA_INSTRUMENT builds
+ *
+ * Each thread claims a block on first use and is its only writer (relaxed
+ * load + store, as in metrics.h), so counting never shares a cache line
+ * or takes a locked instruction. Empty unless WA_INSTRUMENT is defined.
+ */
+
+#include "instrument.h"
+
+#ifdef WA_INSTRUMENT
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#define INS_MAX_THREADS 8
+
+typedef struct {
+    _Alignas(64) _Atomic uint64_t count[IC_COUNT];
+    _Atomic uint64_t calls[IT_COUNT];
+    _Atomic uint64_t cycles[IT_COUNT];
+    char name[24];
+} InsBlock;
+
+static InsBlock g_blocks[INS_MAX_THREADS];
+static atomic_int g_num_blocks;
+static InsBlock g_overflow;              /* shared by threads past the limit */
+
+static _Thread_local InsBlock *t_block;
+
+static const char *counter_names[IC_COUNT] = {
+    "loop iterations", "novel frames", "idle frames", "axis updates", "transitions",
+    "target updates", "target changes", "writes", "writes deferred", "hid reports",
+    "hid bytes", "hid failures", "hid acks", "gsi requests", "gsi recv retries",
+    "gsi bytes", "gsi empty",
+};
+
+static const char *timer_names[IT_COUNT] = {
+    "frame", "read", "axis", "targets", "write", "hid_write", "hid_ack",
+    "gsi_request", "gsi_parse",
+};
+
+static InsBlock *block(void) {
+    if (t_block) return t_block;
+    int i = atomic_fetch_add(&g_num_blocks, 1);
+    if (i < INS_MAX_THREADS) {
+        t_block = &g_blocks[i];
+        snprintf(t_block->name, sizeof(t_block->name), "thread %u", (unsigned)i);
+    } else {
+        t_block = &g_overflow;
+    }
+    return t_block;
+}
+
+static inline void bump(_Atomic uint64_t *v, uint64_t n) {
+    atomic_store_explicit(v, atomic_load_explicit(v, memory_order_relaxed) + n,
+                          memory_order_relaxed);
+}
+
+void ins_thread(const char *name) {
+    InsBlock *b = block();
+    if (b != &g_overflow) snprintf(b->name, sizeof(b->name), "%s", name);
+}
+
+void ins_add(InsCounter c, uint64_t n) {
+    bump(&block()->count[c], n);
+}
+
+void ins_time(InsTimer t, uint64_t cycles) {
+    InsBlock *b = block();
+    bump(&b->calls[t], 1);
+    bump(&b->cycles[t], cycles);
+}
+
+void ins_report(void) {
+    int n = atomic_load(&g_num_blocks);
+    if (n > INS_MAX_THREADS) n = INS_MAX_THREADS;
+
+    printf("\n=== INSTRUMENTATION (WA_INSTRUMENT) ===\n");
+    for (int i = 0; i < n; i++) {
+        InsBlock *b = &g_blocks[i];
+        printf("[%s]\n", b->name);
+        for (int c = 0; c < IC_COUNT; c++) {
+            uint64_t v = atomic_load_explicit(&b->count[c], memory_order_relaxed);
+            if (v) printf("  %-18s %14llu\n", counter_names[c], (unsigned long long)v);
+        }
+        bool header = false;
+        for (int t = 0; t < IT_COUNT; t++) {
+            uint64_t calls = atomic_load_explicit(&b->calls[t], memory_order_relaxed);
+            uint64_t cyc = atomic_load_explicit(&b->cycles[t], memory_order_relaxed);
+            if (!calls) continue;
+            if (!header) {
+                printf("  %-18s %14s %12s %12s\n", "stage", "calls", "Mcycles", "cycles/call");
+                header = true;
+            }
+            printf("  %-18s %14llu %12.1f %12.0f\n", timer_names[t], (unsigned long long)calls,
+                   (double)cyc / 1e6, (double)cyc / (double)calls);
+        }
+    }
+    if (atomic_load(&g_num_blocks) > INS_MAX_THREADS)
+        printf("(threads past %d share an unreported block)\n", INS_MAX_THREADS);
+}
+
+#endif /* WA_INSTRUMENT */
@@ -0,0 +1,91 @@
+/*
+ * instrument.h - Compile-time counters and stage timers
+ *
+ * Built with -DWA_INSTRUMENT (make INSTRUMENT=1, build.bat instrument) the
+ * INS_* macros count events and cycles into a per-thread, cache-line
+ * aligned block, printed after the session summary. Without it they expand
+ * to nothing: production builds carry no trace of them, so the two builds
+ * can be compared on the same source.
+ *
+ *   INS_THREAD("gsi");             name the calling thread's block
+ *   INS_ADD(IC_HID_BYTES, n);      count
+ *   INS_TIME_BEGIN(t);             cycle stamp into local t
+ *   INS_TIME_END(IT_WRITE, t);     add cycles since t to a stage
+ *   INS_REPORT();                  print every thread's block
+ *
+ * Cycles are the TSC on x86 and plat_ticks() elsewhere.
+ */
+
+#ifndef INSTRUMENT_H
+#define INSTRUMENT_H
+
+#include <stdint.h>
+
+typedef enum {
+    /* sampler */
+    IC_LOOP,                /* main loop iterations */
+    IC_NOVEL,               /* ... whose analog input changed */
+    IC_IDLE,                /* ... spent parked by the idle governor */
+    IC_AXIS_UPDATES,
+    IC_TRANSITIONS,         /* axis state changes */
+    IC_TARGET_UPDATES,
+    IC_TARGET_CHANGES,      /* update_targets produced new AP/RT */
+    IC_WRITES,              /* do_write batches sent */
+    IC_WRITES_DEFERRED,     /* pending write held back by write_interval */
+    IC_HID_REPORTS,         /* output reports written */
+    IC_HID_BYTES,
+    IC_HID_FAILURES,
+    IC_HID_ACKS,            /* reports answered within the read timeout */
+    /* GSI server */
+    IC_GSI_REQUESTS,
+    IC_GSI_RECV_RETRIES,    /* recv calls after the first for one request */
+    IC_GSI_BYTES,
+    IC_GSI_EMPTY,           /* requests without a body */
+    IC_COUNT
+} InsCounter;
+
+typedef enum {
+    IT_FRAME,               /* a full (non-parked) frame */
+    IT_READ,                /* analog reads */
+    IT_AXIS,
+    IT_TARGETS,
+    IT_WRITE,               /* do_write: queue one AP+RT batch */
+    IT_HID_WRITE,           /* hid_write of one report */
+    IT_HID_ACK,             /* settle delay + response read */
+    IT_GSI_REQUEST,         /* accept to parsed */
+    IT_GSI_PARSE,           /* parse_gsi_json */
+    IT_COUNT
+} InsTimer;
+
+#ifdef WA_INSTRUMENT
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static inline uint64_t ins_cycles(void) { return __rdtsc(); }
+#else
+#include "platform.h"
+static inline uint64_t ins_cycles(void) { return (uint64_t)plat_ticks(); }
+#endif
+
+void ins_thread(const char *name);
+void ins_add(InsCounter c, uint64_t n);
+void ins_time(InsTimer t, uint64_t cycles);
+void ins_report(void);
+
+#define INS_THREAD(name)        ins_thread(name)
+#define INS_ADD(c, n)           ins_add((c), (uint64_t)(n))
+#define INS_TIME_BEGIN(v)       uint64_t v = ins_cycles()
+#define INS_TIME_END(t, v)      ins_time((t), ins_cycles() - (v))
+#define INS_REPORT()            ins_report()
+
+#else
+
+#define INS_THREAD(name)        ((void)0)
+#define INS_ADD(c, n)           ((void)0)
+#define INS_TIME_BEGIN(v)       ((void)0)
+#define INS_TIME_END(t, v)      ((void)0)
+#define INS_REPORT()            ((void)0)
+
+#endif
+
+#endif /* INSTRUMENT_H */
@@ -22,22 +22,38 @@
  *   - Auto-start with CS2 (--watch mode)
  */
 
-/* winsock2 must come before windows.h */
-#include <winsock2.h>
-#include <ws2tcpip.h>
-#include <windows.h>
+#include "platform.h"
 
 #include <stdio.h>
+#include <stdarg.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <string.h>
 #include <stdlib.h>
 #include <math.h>
 #include <time.h>
-#include <tlhelp32.h>
 #include "../include/wooting-analog-sdk.h"
 #include "hid_writer.h"
-
+#include "hid_queue.h"
+#include "stats_log.h"
+#include "stats_store.h"
+#include "histogram.h"
+#include "config.h"
+#include "spsc_ring.h"
+#include "telemetry.h"
+#include "telemetry_shm.h"
+#include "metrics.h"
+#include "control.h"
+#include "trace_file.h"
+#include "proc_watch.h"
+#include "thread_place.h"
+#include "frame_trace.h"
+#include "instrument.h"
+#include "gsi.h"
+
+#ifdef _WIN32
 #pragma comment(lib, "ws2_32.lib")
+#endif
 
 /* HID Usage IDs */
 #define HID_W     0x1A
@@ -46,27 +62,29 @@
 #define HID_D     0x07
 #define HID_LCTRL 0xE0
 
-/* Key indices for per-key arrays */
+/* Key indices for per-key arrays: movement keys, then adaptive_keys */
 #define K_W 0
 #define K_A 1
 #define K_S 2
 #define K_D 3
+#define K_EXTRA  4
+#define MAX_KEYS WOOTING_MAX_KEYS
+
+/* One read_full_buffer call returns at most this many changed keys */
+#define ANALOG_BUFFER_LEN 64
 
 #define DEAD_ZONE   0.01f
 #define PROFILE_IDX 0
 
 #define GSI_PORT    58732
-#define GSI_BUF_SIZE 8192
+
+#define HID_CACHE_PATH "wooting-aim-device.cache"
 
 /* Jiggle peek detection */
 #define JIGGLE_WINDOW_MS   300.0   /* max time between counter-strafes to count as jiggle */
 #define JIGGLE_MIN_COUNT   2       /* min counter-strafes in window to trigger jiggle mode */
 #define JIGGLE_PREARM_MS   300.0   /* how long jiggle mode persists after last counter-strafe */
 
-/* Counter-strafe phase decay (based on CS2 mechanics research) */
-#define PHASE_ULTRA_MS     80.0    /* ultra-aggressive phase - matches AK counter-strafe to 34% */
-#define PHASE_DECAY_MS     200.0   /* total decay window (after ultra, linearly relax) */
-
 /* Velocity-aware scaling */
 #define VEL_AGGRO_ZONE     0.50f   /* above 50% of threshold: scale toward more aggressive */
 #define VEL_MIN_AP_FACTOR  0.5f    /* at peak velocity, AP = weapon_ap * this factor */
@@ -74,20 +92,6 @@
 /* ================================================================
  * WEAPON CATEGORIES
  * ================================================================ */
-typedef enum {
-    WCAT_RIFLE,
-    WCAT_AWP,
-    WCAT_PISTOL,
-    WCAT_SMG,
-    WCAT_KNIFE,
-    WCAT_OTHER,
-    WCAT_COUNT
-} WeaponCategory;
-
-static const char *wcat_names[] = {
-    "RIFLE", "AWP", "PISTOL", "SMG", "KNIFE", "OTHER"
-};
-
 static WeaponCategory categorize_weapon_type(const char *type) {
     if (!type[0]) return WCAT_OTHER;
     if (strcmp(type, "Rifle") == 0 || strcmp(type, "Machine Gun") == 0)
@@ -133,152 +137,280 @@ static float weapon_max_speed(const char *name) {
 }
 
 /* ================================================================
- * CONFIG
+ * NOTICES (other threads -> renderer)
  * ================================================================ */
-typedef struct {
-    float ap;
-    float rt;
-} WeaponProfile;
+/*
+ * Once the renderer owns the console, threads other than the sampler
+ * (config watcher, control channel, device thread) hand it whole lines
+ * here instead of printing over the status line. Producers serialize on
+ * the lock, the renderer pops without it. Before the renderer starts,
+ * after it stops, or with the ring full, lines go straight to stdout.
+ */
+#define NOTICE_RING_SIZE 32      /* power of two */
+#define NOTICE_LEN       320
 
 typedef struct {
-    /* Base settings (used when GSI not connected) */
-    float ap_normal;
-    float ap_aggro;
-    float rt_normal;
-    float rt_aggro;
-    float write_interval_ms;
-    float predict_threshold;
-    float predict_min_peak;
-    float crouch_rt_factor;
-    int   ws_adaptive;
-    int   stats_enabled;
-
-    /* Weapon profiles (override ap_aggro/rt_aggro when GSI active) */
-    WeaponProfile weapon[WCAT_COUNT];
-
-    /* GSI */
-    int gsi_enabled;
-    int gsi_port;
+    char text[NOTICE_LEN];
+} Notice;
 
-    /* Velocity estimation */
-    int vel_enabled;
-
-    /* v0.7 features */
-    int   jiggle_enabled;    /* jiggle peek detection */
-    int   vel_scale_enabled; /* velocity-aware AP scaling */
-    int   phase_decay;       /* counter-strafe phase decay */
-    float poll_rate_hz;      /* target poll rate (0=unlimited) */
-} Config;
-
-static Config g_cfg = {
-    .ap_normal         = 1.2f,
-    .ap_aggro          = 0.4f,   /* Changed from 0.1 based on research */
-    .rt_normal         = 1.0f,
-    .rt_aggro          = 0.1f,
-    .write_interval_ms = 50.0f,
-    .predict_threshold = 0.70f,
-    .predict_min_peak  = 0.30f,
-    .crouch_rt_factor  = 0.5f,
-    .ws_adaptive       = 0,
-    .stats_enabled     = 1,
-
-    .weapon = {
-        [WCAT_RIFLE]  = { 0.4f, 0.1f },
-        [WCAT_AWP]    = { 0.8f, 0.4f },
-        [WCAT_PISTOL] = { 0.3f, 0.1f },
-        [WCAT_SMG]    = { 0.5f, 0.2f },
-        [WCAT_KNIFE]  = { 1.5f, 1.0f },
-        [WCAT_OTHER]  = { 1.0f, 0.5f },
-    },
-
-    .gsi_enabled = 1,
-    .gsi_port    = GSI_PORT,
-    .vel_enabled = 1,
-
-    .jiggle_enabled    = 1,
-    .vel_scale_enabled = 1,
-    .phase_decay       = 1,
-    .poll_rate_hz      = 8000.0f,  /* 8kHz matches keyboard polling rate */
-};
+static SpscRing g_notices;
+static Notice g_notice_slots[NOTICE_RING_SIZE];
+static PlatMutex g_notice_lock;
+static bool g_notices_queued;    /* renderer running; under g_notice_lock */
+
+static void notices_init(void) {
+    plat_mutex_init(&g_notice_lock);
+    spsc_init(&g_notices, g_notice_slots, NOTICE_RING_SIZE, sizeof(Notice));
+}
+
+/* One line, without its newline */
+static void notice(const char *fmt, ...) {
+    Notice n;
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(n.text, sizeof(n.text), fmt, ap);
+    va_end(ap);
+
+    plat_mutex_lock(&g_notice_lock);
+    bool queued = g_notices_queued && spsc_push(&g_notices, &n);
+    plat_mutex_unlock(&g_notice_lock);
+    if (!queued) printf("%s\n", n.text);
+}
+
+static void notice_line(const char *line) {
+    notice("%s", line);
+}
+
+/* Renderer up (true) or about to stop: anything queued before a stop is
+ * printed by its last drain */
+static void notices_route(bool to_renderer) {
+    plat_mutex_lock(&g_notice_lock);
+    g_notices_queued = to_renderer;
+    plat_mutex_unlock(&g_notice_lock);
+}
 
+/* ================================================================
+ * CONFIG (schema and parser in config.c)
+ * ================================================================ */
+/*
+ * Active engine config. Immutable once published: the sampling thread swaps
+ * the pointer between frames (config_apply), a reload never edits it in place.
+ * cfg_boot is the startup config and is never freed: CFG_RESTART settings
+ * are read from it, since they are the ones actually in effect.
+ */
+static Config cfg_boot;
+static const Config *_Atomic g_cfg = &cfg_boot;
+static const Config *_Atomic g_cfg_pending;   /* parsed, waiting for the sampler */
+static const Config *_Atomic g_cfg_retired;   /* swapped out, freed on the next swap */
+
+/* --profile or control-channel override, "" = file's profile=. Publishers only. */
+static char g_cfg_profile[CFG_NAME_LEN];
+
+/* Parse + compile. Returns false if the file has errors (already printed). */
+static bool config_build(const char *path, Config *c) {
+    if (config_parse_file(c, path, g_cfg_profile[0] ? g_cfg_profile : NULL) != 0)
+        return false;
+    config_compile(c, (double)plat_tick_freq());
+    return true;
+}
+
+/* Startup load. Invalid files fall back to the defaults. */
 static void config_load(const char *path) {
-    FILE *f = fopen(path, "r");
-    if (!f) {
-        f = fopen(path, "w");
-        if (f) {
-            fprintf(f, "# wooting-aim v0.7 configuration\n\n");
-            fprintf(f, "# Base settings (used when GSI not connected)\n");
-            fprintf(f, "ap_normal=%.1f\n", g_cfg.ap_normal);
-            fprintf(f, "ap_aggro=%.1f\n", g_cfg.ap_aggro);
-            fprintf(f, "rt_normal=%.1f\n", g_cfg.rt_normal);
-            fprintf(f, "rt_aggro=%.1f\n", g_cfg.rt_aggro);
-            fprintf(f, "write_interval_ms=%.0f\n", g_cfg.write_interval_ms);
-            fprintf(f, "predict_threshold=%.2f\n", g_cfg.predict_threshold);
-            fprintf(f, "predict_min_peak=%.2f\n", g_cfg.predict_min_peak);
-            fprintf(f, "crouch_rt_factor=%.2f\n", g_cfg.crouch_rt_factor);
-            fprintf(f, "ws_adaptive=%d\n", g_cfg.ws_adaptive);
-            fprintf(f, "stats_enabled=%d\n\n", g_cfg.stats_enabled);
-            fprintf(f, "# Weapon profiles (AP/RT when counter-strafing, GSI active)\n");
-            fprintf(f, "rifle_ap=%.1f\nrifle_rt=%.1f\n", g_cfg.weapon[WCAT_RIFLE].ap, g_cfg.weapon[WCAT_RIFLE].rt);
-            fprintf(f, "awp_ap=%.1f\nawp_rt=%.1f\n", g_cfg.weapon[WCAT_AWP].ap, g_cfg.weapon[WCAT_AWP].rt);
-            fprintf(f, "pistol_ap=%.1f\npistol_rt=%.1f\n", g_cfg.weapon[WCAT_PISTOL].ap, g_cfg.weapon[WCAT_PISTOL].rt);
-            fprintf(f, "smg_ap=%.1f\nsmg_rt=%.1f\n", g_cfg.weapon[WCAT_SMG].ap, g_cfg.weapon[WCAT_SMG].rt);
-            fprintf(f, "knife_ap=%.1f\nknife_rt=%.1f\n\n", g_cfg.weapon[WCAT_KNIFE].ap, g_cfg.weapon[WCAT_KNIFE].rt);
-            fprintf(f, "# GSI settings\n");
-            fprintf(f, "gsi_enabled=%d\n", g_cfg.gsi_enabled);
-            fprintf(f, "gsi_port=%d\n\n", g_cfg.gsi_port);
-            fprintf(f, "# Velocity estimation\n");
-            fprintf(f, "vel_enabled=%d\n\n", g_cfg.vel_enabled);
-            fprintf(f, "# v0.7 features\n");
-            fprintf(f, "jiggle_enabled=%d\n", g_cfg.jiggle_enabled);
-            fprintf(f, "vel_scale_enabled=%d\n", g_cfg.vel_scale_enabled);
-            fprintf(f, "phase_decay=%d\n", g_cfg.phase_decay);
-            fprintf(f, "poll_rate_hz=%.0f\n", g_cfg.poll_rate_hz);
-            fclose(f);
-            printf("[CFG] Default config created: %s\n", path);
-        }
+    if (config_build(path, &cfg_boot)) {
+        printf("[CFG] Loaded: %s%s%s\n", path,
+               cfg_boot.profile[0] ? "  profile: " : "", cfg_boot.profile);
+    } else {
+        printf("[CFG] Invalid config, using defaults.\n");
+        config_defaults(&cfg_boot);
+        config_compile(&cfg_boot, (double)plat_tick_freq());
+    }
+    g_cfg = &cfg_boot;
+}
+
+/* Config is cache-line aligned, beyond what malloc guarantees */
+static Config *config_alloc(void) {
+    return plat_aligned_alloc(_Alignof(Config), sizeof(Config));
+}
+
+static void config_free(const Config *c) {
+    if (c && c != &cfg_boot) plat_aligned_free((void *)c);
+}
+
+/* Settings bound at startup (sockets, threads, files) */
+static void config_warn_restart(const Config *old, const Config *c) {
+    for (int i = 0; i < config_schema_count; i++) {
+        const CfgField *f = &config_schema[i];
+        if (!(f->flags & CFG_RESTART)) continue;
+        char a[CFG_VALUE_MAX], b[CFG_VALUE_MAX];
+        config_format(old, f, a, sizeof(a));
+        config_format(c, f, b, sizeof(b));
+        if (strcmp(a, b) != 0)
+            notice("[CFG] %s=%s takes effect on restart.", f->key, b);
+    }
+}
+
+/*
+ * Publishers (config watcher, control channel) serialize on this lock; the
+ * sampler never takes it. While it is held neither the active nor the
+ * newest config can be freed: that takes two more swaps, and only
+ * publishers create swaps. Every other thread that reads hot settings
+ * (device thread, cleanup) does so under it, from config_latest().
+ */
+static PlatMutex g_cfg_publish_lock;
+
+/* Newest config, including one the sampler hasn't adopted yet. Hold the lock. */
+static const Config *config_latest(void) {
+    const Config *c = atomic_load(&g_cfg_pending);
+    return c ? c : atomic_load(&g_cfg);
+}
+
+/* Hand a compiled config to the sampler. Hold the lock. */
+static void config_publish(Config *c) {
+    config_free(atomic_exchange(&g_cfg_retired, NULL));
+    /* A config the sampler hasn't picked up yet is simply superseded */
+    config_free(atomic_exchange(&g_cfg_pending, c));
+}
+
+/* Reparse off the hot path and hand the result to the sampler */
+static bool config_reload(const char *path) {
+    Config *c = config_alloc();
+    if (!c) return false;
+    plat_mutex_lock(&g_cfg_publish_lock);
+    if (!config_build(path, c)) {
+        plat_mutex_unlock(&g_cfg_publish_lock);
+        notice("[CFG] Reload rejected, keeping current settings.");
+        config_free(c);
+        return false;
+    }
+    config_warn_restart(config_latest(), c);
+    config_publish(c);
+    notice("[CFG] Reloaded: %s%s%s", path, c->profile[0] ? "  profile: " : "", c->profile);
+    plat_mutex_unlock(&g_cfg_publish_lock);
+    return true;
+}
+
+/* Sampler side, between frames: adopt a pending config if there is one */
+static bool config_apply_pending(void) {
+    const Config *c = atomic_exchange_explicit(&g_cfg_pending, NULL, memory_order_acquire);
+    if (!c) return false;
+    const Config *old = atomic_exchange(&g_cfg, c);
+    config_free(atomic_exchange(&g_cfg_retired, old));
+    return true;
+}
+
+/*
+ * Config watcher: change notifications on the config file's directory
+ * (platform.h), debounced because editors often save in several writes.
+ */
+#define CFG_DEBOUNCE_MS 150
+
+static atomic_bool g_cfg_watch_running;
+static PlatThread g_cfg_watch_thread;
+static char g_cfg_path[PLAT_PATH_MAX] = "wooting-aim.cfg";
+
+static void config_watch_thread(void *param) {
+    (void)param;
+    PlatFileWatch w;
+    if (!plat_file_watch_open(&w, g_cfg_path)) {
+        notice("[CFG] Cannot watch %s for changes.", g_cfg_path);
         return;
     }
 
-    char line[256];
-    while (fgets(line, sizeof(line), f)) {
-        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') continue;
-        char key[64];
-        float val;
-        if (sscanf(line, "%63[^=]=%f", key, &val) == 2) {
-            if      (strcmp(key, "ap_normal") == 0)         g_cfg.ap_normal = val;
-            else if (strcmp(key, "ap_aggro") == 0)          g_cfg.ap_aggro = val;
-            else if (strcmp(key, "rt_normal") == 0)         g_cfg.rt_normal = val;
-            else if (strcmp(key, "rt_aggro") == 0)          g_cfg.rt_aggro = val;
-            else if (strcmp(key, "write_interval_ms") == 0) g_cfg.write_interval_ms = val;
-            else if (strcmp(key, "predict_threshold") == 0) g_cfg.predict_threshold = val;
-            else if (strcmp(key, "predict_min_peak") == 0)  g_cfg.predict_min_peak = val;
-            else if (strcmp(key, "crouch_rt_factor") == 0)  g_cfg.crouch_rt_factor = val;
-            else if (strcmp(key, "ws_adaptive") == 0)       g_cfg.ws_adaptive = (int)val;
-            else if (strcmp(key, "stats_enabled") == 0)     g_cfg.stats_enabled = (int)val;
-            else if (strcmp(key, "rifle_ap") == 0)          g_cfg.weapon[WCAT_RIFLE].ap = val;
-            else if (strcmp(key, "rifle_rt") == 0)          g_cfg.weapon[WCAT_RIFLE].rt = val;
-            else if (strcmp(key, "awp_ap") == 0)            g_cfg.weapon[WCAT_AWP].ap = val;
-            else if (strcmp(key, "awp_rt") == 0)            g_cfg.weapon[WCAT_AWP].rt = val;
-            else if (strcmp(key, "pistol_ap") == 0)         g_cfg.weapon[WCAT_PISTOL].ap = val;
-            else if (strcmp(key, "pistol_rt") == 0)         g_cfg.weapon[WCAT_PISTOL].rt = val;
-            else if (strcmp(key, "smg_ap") == 0)            g_cfg.weapon[WCAT_SMG].ap = val;
-            else if (strcmp(key, "smg_rt") == 0)            g_cfg.weapon[WCAT_SMG].rt = val;
-            else if (strcmp(key, "knife_ap") == 0)          g_cfg.weapon[WCAT_KNIFE].ap = val;
-            else if (strcmp(key, "knife_rt") == 0)          g_cfg.weapon[WCAT_KNIFE].rt = val;
-            else if (strcmp(key, "gsi_enabled") == 0)       g_cfg.gsi_enabled = (int)val;
-            else if (strcmp(key, "gsi_port") == 0)          g_cfg.gsi_port = (int)val;
-            else if (strcmp(key, "vel_enabled") == 0)       g_cfg.vel_enabled = (int)val;
-            else if (strcmp(key, "jiggle_enabled") == 0)    g_cfg.jiggle_enabled = (int)val;
-            else if (strcmp(key, "vel_scale_enabled") == 0) g_cfg.vel_scale_enabled = (int)val;
-            else if (strcmp(key, "phase_decay") == 0)       g_cfg.phase_decay = (int)val;
-            else if (strcmp(key, "poll_rate_hz") == 0)      g_cfg.poll_rate_hz = val;
+    uint32_t pending_since = 0;   /* ms of the first unhandled change, 0 = none */
+    while (atomic_load(&g_cfg_watch_running)) {
+        int r = plat_file_watch_wait(&w, 100);
+        if (r < 0) break;
+        if (r > 0 && !pending_since) pending_since = plat_ms() | 1;
+
+        if (pending_since && plat_ms() - pending_since >= CFG_DEBOUNCE_MS) {
+            pending_since = 0;
+            config_reload(g_cfg_path);
+        }
+    }
+
+    plat_file_watch_close(&w);
+}
+
+static void config_watch_start(void) {
+    atomic_store(&g_cfg_watch_running, true);
+    if (!plat_thread_start(&g_cfg_watch_thread, config_watch_thread, NULL, PLAT_PRIO_BELOW_NORMAL))
+        printf("[CFG] Failed to start config watcher, hot reload disabled.\n");
+}
+
+static void config_watch_stop(void) {
+    atomic_store(&g_cfg_watch_running, false);
+    plat_thread_join(&g_cfg_watch_thread, 1000);
+}
+
+/* ================================================================
+ * KEY LAYOUT (movement keys + adaptive_keys, bound at startup)
+ * ================================================================ */
+typedef struct {
+    uint8_t usage;               /* HID usage: index into the analog buffer */
+    uint8_t row, col;            /* matrix position for AP/RT writes */
+} KeyPos;
+
+/* [K_W..K_D] forward/left/back/right, then adaptive_keys. WASD until keys_init() */
+static KeyPos g_keys[MAX_KEYS] = {
+    { HID_W, KEY_W_ROW, KEY_W_COL }, { HID_A, KEY_A_ROW, KEY_A_COL },
+    { HID_S, KEY_S_ROW, KEY_S_COL }, { HID_D, KEY_D_ROW, KEY_D_COL },
+};
+static int g_key_count = K_EXTRA;
+static uint8_t g_key_crouch = HID_LCTRL;
+
+static bool key_add(uint8_t usage) {
+    for (int i = 0; i < g_key_count; i++)
+        if (g_keys[i].usage == usage) return false;
+    KeyPos *k = &g_keys[g_key_count];
+    if (g_key_count == MAX_KEYS || !wooting_key_position(usage, &k->row, &k->col))
+        return false;
+    k->usage = usage;
+    g_key_count++;
+    return true;
+}
+
+static void keys_init(void) {
+    const uint8_t move[K_EXTRA] = { g_cfg->key_forward, g_cfg->key_left,
+                                    g_cfg->key_back, g_cfg->key_right };
+    g_key_count = 0;
+    for (int i = 0; i < K_EXTRA; i++) {
+        if (!key_add(move[i])) {
+            printf("[KEY] Movement keys must be four different keys, using WASD.\n");
+            const uint8_t wasd[K_EXTRA] = { HID_W, HID_A, HID_S, HID_D };
+            g_key_count = 0;
+            for (int j = 0; j < K_EXTRA; j++) key_add(wasd[j]);
+            break;
         }
     }
-    fclose(f);
-    printf("[CFG] Loaded: %s\n", path);
+    for (int i = 0; i < g_cfg->adaptive_keys.count; i++)
+        key_add(g_cfg->adaptive_keys.usage[i]);   /* movement keys are already in */
+    g_key_crouch = g_cfg->key_crouch;
+
+    printf("[KEY] Move: %s %s %s %s  Crouch: %s  Adaptive extras: %d\n",
+           config_key_name(g_keys[K_W].usage), config_key_name(g_keys[K_A].usage),
+           config_key_name(g_keys[K_S].usage), config_key_name(g_keys[K_D].usage),
+           config_key_name(g_key_crouch), g_key_count - K_EXTRA);
+}
+
+/* Normal AP/RT for every adaptive key (restore). Returns the key count. */
+static int keys_normal(KeySetting *ap, KeySetting *rt) {
+    plat_mutex_lock(&g_cfg_publish_lock);
+    float ap_normal = config_latest()->ap_normal;
+    float rt_normal = config_latest()->rt_normal;
+    plat_mutex_unlock(&g_cfg_publish_lock);
+
+    for (int i = 0; i < g_key_count; i++) {
+        ap[i] = (KeySetting){ g_keys[i].row, g_keys[i].col, ap_normal };
+        rt[i] = (KeySetting){ g_keys[i].row, g_keys[i].col, rt_normal };
+    }
+    return g_key_count;
 }
 
+/* ================================================================
+ * METRICS (per-thread counters, see metrics.h)
+ * ================================================================ */
+static Metrics g_metrics;
+
 /* ================================================================
  * GSI - GAME STATE INTEGRATION
  * ================================================================ */
@@ -287,267 +419,149 @@ typedef struct {
     char weapon_type[32];
     WeaponCategory weapon_cat;
     float weapon_speed;
+    uint8_t weapon_id;     /* stats_weapon_id() */
     char round_phase[16];  /* "live", "freezetime", "over" */
     int health;
     bool connected;
-    LARGE_INTEGER last_update;
-    CRITICAL_SECTION lock;
+    int64_t last_update;
+    PlatMutex lock;
 } GSIState;
 
 static GSIState g_gsi = {0};
 
-/* Extract a JSON string value near a specific position.
- * Searches for "key" and extracts the quoted value after it. */
-static bool json_extract_str(const char *json, const char *start, const char *end,
-                              const char *key, char *buf, int buf_size) {
-    buf[0] = '\0';
-    const char *k = start;
-    while ((k = strstr(k, key)) != NULL && k < end) {
-        k += strlen(key);
-        /* skip whitespace, colon, whitespace */
-        while (k < end && (*k == ' ' || *k == '\t' || *k == ':')) k++;
-        if (k < end && *k == '"') {
-            k++;
-            int i = 0;
-            while (k < end && *k != '"' && i < buf_size - 1) {
-                buf[i++] = *k++;
-            }
-            buf[i] = '\0';
-            return true;
-        }
-        break;
-    }
-    return false;
-}
-
-static int json_extract_int(const char *json, const char *start, const char *end,
-                             const char *key) {
-    const char *k = strstr(start, key);
-    if (!k || k >= end) return -1;
-    k += strlen(key);
-    while (k < end && (*k == ' ' || *k == '\t' || *k == ':')) k++;
-    return atoi(k);
-}
+_Static_assert(sizeof(g_gsi.weapon_name) == sizeof(((GsiUpdate *)0)->weapon_name) &&
+               sizeof(g_gsi.weapon_type) == sizeof(((GsiUpdate *)0)->weapon_type) &&
+               sizeof(g_gsi.round_phase) == sizeof(((GsiUpdate *)0)->round_phase),
+               "GSI strings are copied whole");
 
+/* Parse one GSI body and fold it into g_gsi */
 static void parse_gsi_json(const char *json, int len) {
-    char weapon_name[64] = {0};
-    char weapon_type[32] = {0};
-    char round_phase[16] = {0};
-    int health = -1;
-
-    /* Find round phase */
-    const char *round_section = strstr(json, "\"round\"");
-    if (round_section) {
-        const char *phase_end = round_section + 200;
-        if (phase_end > json + len) phase_end = json + len;
-        json_extract_str(json, round_section, phase_end, "\"phase\"", round_phase, sizeof(round_phase));
-    }
-
-    /* Find player health */
-    const char *state_section = strstr(json, "\"state\"");
-    if (state_section) {
-        /* Only look at player.state, not weapon state */
-        const char *health_area = state_section + 200;
-        if (health_area > json + len) health_area = json + len;
-        health = json_extract_int(json, state_section, health_area, "\"health\"");
-    }
-
-    /* Find active weapon: search for "state": "active" in weapons section */
-    const char *weapons = strstr(json, "\"weapons\"");
-    if (weapons) {
-        const char *active = weapons;
-        while ((active = strstr(active, "\"active\"")) != NULL) {
-            /* Check that this is preceded by "state" */
-            const char *check = (active > weapons + 30) ? active - 30 : weapons;
-            if (!strstr(check, "\"state\"")) {
-                active++;
-                continue;
-            }
-
-            /* Find the enclosing {} block */
-            const char *block_start = active;
-            int brace = 0;
-            while (block_start > weapons) {
-                block_start--;
-                if (*block_start == '}') brace++;
-                if (*block_start == '{') {
-                    if (brace == 0) break;
-                    brace--;
-                }
-            }
-
-            /* Find block end */
-            const char *block_end = active + 200;
-            if (block_end > json + len) block_end = json + len;
-
-            json_extract_str(json, block_start, block_end, "\"name\"", weapon_name, sizeof(weapon_name));
-            json_extract_str(json, block_start, block_end, "\"type\"", weapon_type, sizeof(weapon_type));
-            break;
-        }
-    }
+    GsiUpdate u;
+    gsi_parse(json, len, &u);
 
     /* Update shared state */
-    EnterCriticalSection(&g_gsi.lock);
-    if (weapon_name[0]) {
-        strncpy(g_gsi.weapon_name, weapon_name, sizeof(g_gsi.weapon_name) - 1);
-        strncpy(g_gsi.weapon_type, weapon_type, sizeof(g_gsi.weapon_type) - 1);
-        g_gsi.weapon_cat = categorize_weapon_type(weapon_type);
-        g_gsi.weapon_speed = weapon_max_speed(weapon_name);
-    }
-    if (round_phase[0])
-        strncpy(g_gsi.round_phase, round_phase, sizeof(g_gsi.round_phase) - 1);
-    if (health >= 0) g_gsi.health = health;
+    plat_mutex_lock(&g_gsi.lock);
+    if (u.weapon_name[0]) {
+        /* Same-size, NUL-terminated arrays (gsi_parse) */
+        memcpy(g_gsi.weapon_name, u.weapon_name, sizeof(g_gsi.weapon_name));
+        memcpy(g_gsi.weapon_type, u.weapon_type, sizeof(g_gsi.weapon_type));
+        g_gsi.weapon_cat = categorize_weapon_type(u.weapon_type);
+        g_gsi.weapon_speed = weapon_max_speed(u.weapon_name);
+        g_gsi.weapon_id = stats_weapon_id(u.weapon_name);
+    }
+    if (u.round_phase[0])
+        memcpy(g_gsi.round_phase, u.round_phase, sizeof(g_gsi.round_phase));
+    if (u.health >= 0) g_gsi.health = u.health;
     g_gsi.connected = true;
-    QueryPerformanceCounter(&g_gsi.last_update);
-    LeaveCriticalSection(&g_gsi.lock);
+    g_gsi.last_update = plat_ticks();
+    plat_mutex_unlock(&g_gsi.lock);
 }
 
 /* GSI HTTP server thread */
 static volatile bool g_gsi_running = true;
 
-static DWORD WINAPI gsi_thread(LPVOID param) {
+static void gsi_thread(void *param) {
     (void)param;
+    ftrace_thread("gsi");
+    INS_THREAD("gsi");
 
-    SOCKET server_sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
-    if (server_sock == INVALID_SOCKET) {
-        printf("[GSI] Socket creation failed: %d\n", WSAGetLastError());
-        return 1;
-    }
-
-    int opt = 1;
-    setsockopt(server_sock, SOL_SOCKET, SO_REUSEADDR, (const char *)&opt, sizeof(opt));
+    PlatSocket server_sock = plat_listen_loopback(cfg_boot.gsi_port, 5, "[GSI]");
+    if (server_sock == PLAT_INVALID_SOCKET) return;
 
-    struct sockaddr_in addr;
-    addr.sin_family = AF_INET;
-    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
-    addr.sin_port = htons((u_short)g_cfg.gsi_port);
-
-    if (bind(server_sock, (struct sockaddr *)&addr, sizeof(addr)) == SOCKET_ERROR) {
-        printf("[GSI] Bind failed on port %d: %d\n", g_cfg.gsi_port, WSAGetLastError());
-        closesocket(server_sock);
-        return 1;
-    }
-
-    if (listen(server_sock, 5) == SOCKET_ERROR) {
-        printf("[GSI] Listen failed: %d\n", WSAGetLastError());
-        closesocket(server_sock);
-        return 1;
-    }
-
-    printf("[GSI] Server listening on 127.0.0.1:%d\n", g_cfg.gsi_port);
-
-    /* Set non-blocking for graceful shutdown */
-    u_long nonblock = 1;
-    ioctlsocket(server_sock, FIONBIO, &nonblock);
+    printf("[GSI] Server listening on 127.0.0.1:%d\n", cfg_boot.gsi_port);
 
     while (g_gsi_running) {
-        fd_set readfds;
-        FD_ZERO(&readfds);
-        FD_SET(server_sock, &readfds);
-        struct timeval tv = {0, 500000}; /* 500ms timeout */
+        /* 500ms timeout for graceful shutdown */
+        if (plat_socket_wait(server_sock, 500) <= 0) continue;
 
-        int sel = select(0, &readfds, NULL, NULL, &tv);
-        if (sel <= 0) continue;
+        PlatSocket client = accept(server_sock, NULL, NULL);
+        if (client == PLAT_INVALID_SOCKET) continue;
 
-        SOCKET client = accept(server_sock, NULL, NULL);
-        if (client == INVALID_SOCKET) continue;
+        int64_t req_start = plat_ticks();
+        INS_TIME_BEGIN(ins_req);
+        INS_ADD(IC_GSI_REQUESTS, 1);
 
         /* Read HTTP request */
         char buf[GSI_BUF_SIZE];
         int total = 0;
-        int content_length = 0;
-        char *body = NULL;
+        int body_len = -1;
+        const char *body = NULL;
+        bool complete = false;
 
-        /* Set client to blocking with timeout */
-        u_long blocking = 0;
-        ioctlsocket(client, FIONBIO, &blocking);
-        int timeout_ms = 2000;
-        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, (const char *)&timeout_ms, sizeof(timeout_ms));
+        /* Blocking reads with a timeout */
+        plat_socket_recv_timeout(client, 2000);
 
-        /* Read headers + body */
+        /* Read headers + body; a body that outgrows buf is parsed as far as it got */
         while (total < GSI_BUF_SIZE - 1) {
+            if (total > 0) INS_ADD(IC_GSI_RECV_RETRIES, 1);
             int n = recv(client, buf + total, GSI_BUF_SIZE - 1 - total, 0);
             if (n <= 0) break;
             total += n;
-            buf[total] = '\0';
-
-            /* Check if we have full headers */
-            if (!body) {
-                body = strstr(buf, "\r\n\r\n");
-                if (body) {
-                    body += 4;
-                    /* Extract Content-Length */
-                    const char *cl = strstr(buf, "Content-Length:");
-                    if (!cl) cl = strstr(buf, "content-length:");
-                    if (cl) {
-                        cl += 15;
-                        while (*cl == ' ') cl++;
-                        content_length = atoi(cl);
-                    }
-                }
-            }
-
-            /* Check if we have the full body */
-            if (body && content_length > 0) {
-                int body_received = total - (int)(body - buf);
-                if (body_received >= content_length) break;
-            }
+            INS_ADD(IC_GSI_BYTES, n);
+            body_len = gsi_http_body(buf, total, &body, &complete);
+            if (complete) break;
         }
 
         /* Send 200 OK */
         const char *resp = "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n";
         send(client, resp, (int)strlen(resp), 0);
-        closesocket(client);
+        plat_socket_close(client);
 
         /* Parse the body */
-        if (body && content_length > 0) {
-            parse_gsi_json(body, content_length);
+        if (body_len > 0) {
+            INS_TIME_BEGIN(ins_parse);
+            parse_gsi_json(body, body_len);
+            INS_TIME_END(IT_GSI_PARSE, ins_parse);
+            INS_TIME_END(IT_GSI_REQUEST, ins_req);
+
+            int64_t req_end = plat_ticks();
+            if (ftrace_on()) ftrace_span(FT_GSI, req_start, req_end, 0);
+            metric_add(&g_metrics.gsi.updates, 1);
+            metric_observe(&g_metrics.gsi.request_latency, &metric_bounds_gsi,
+                           (uint64_t)((req_end - req_start) * 1000000 / plat_tick_freq()));
+        } else {
+            metric_add(&g_metrics.gsi.empty_requests, 1);
+            INS_ADD(IC_GSI_EMPTY, 1);
         }
     }
 
-    closesocket(server_sock);
-    return 0;
+    plat_socket_close(server_sock);
 }
 
 /* Create GSI config file in CS2's cfg directory */
 static void create_gsi_config(void) {
-    /* Try to find Steam path from registry */
-    char steam_path[MAX_PATH] = {0};
-    HKEY key;
-    bool found_steam = false;
-
-    if (RegOpenKeyExA(HKEY_CURRENT_USER, "Software\\Valve\\Steam", 0,
-                      KEY_READ, &key) == ERROR_SUCCESS) {
-        DWORD size = sizeof(steam_path);
-        DWORD type;
-        if (RegQueryValueExA(key, "SteamPath", NULL, &type,
-                             (LPBYTE)steam_path, &size) == ERROR_SUCCESS) {
-            found_steam = true;
-            for (int i = 0; steam_path[i]; i++)
-                if (steam_path[i] == '/') steam_path[i] = '\\';
-        }
-        RegCloseKey(key);
-    }
+    /* Steam path from the registry (~/.steam on Linux) */
+    char steam_path[PLAT_PATH_MAX] = {0};
+    bool found_steam = plat_steam_dir(steam_path, sizeof(steam_path));
 
     /* Build cfg path */
-    const char *suffix = "\\steamapps\\common\\Counter-Strike Global Offensive\\game\\csgo\\cfg";
-    char cfg_dir[MAX_PATH];
+    const char *suffix = PLAT_SEP "steamapps" PLAT_SEP "common" PLAT_SEP
+                         "Counter-Strike Global Offensive" PLAT_SEP "game" PLAT_SEP "csgo" PLAT_SEP "cfg";
+    char cfg_dir[PLAT_PATH_MAX];
 
     /* Try Steam path first, then common locations */
     const char *try_bases[4];
     int try_count = 0;
     if (found_steam) try_bases[try_count++] = steam_path;
+#ifdef _WIN32
     try_bases[try_count++] = "C:\\Program Files (x86)\\Steam";
     try_bases[try_count++] = "D:\\Steam";
     try_bases[try_count++] = "D:\\SteamLibrary";
+#endif
 
     for (int i = 0; i < try_count; i++) {
-        snprintf(cfg_dir, sizeof(cfg_dir), "%s%s", try_bases[i], suffix);
-        if (GetFileAttributesA(cfg_dir) != INVALID_FILE_ATTRIBUTES) {
-            char filepath[MAX_PATH];
-            snprintf(filepath, sizeof(filepath), "%s\\gamestate_integration_wooting_aim.cfg", cfg_dir);
+        int n = snprintf(cfg_dir, sizeof(cfg_dir), "%s%s", try_bases[i], suffix);
+        if (n < 0 || n >= (int)sizeof(cfg_dir)) continue;
+        if (plat_path_exists(cfg_dir)) {
+            char filepath[PLAT_PATH_MAX];
+            n = snprintf(filepath, sizeof(filepath), "%s" PLAT_SEP "gamestate_integration_wooting_aim.cfg",
+                         cfg_dir);
+            if (n < 0 || n >= (int)sizeof(filepath)) {
+                printf("[GSI] CS2 cfg path too long, create the config manually:\n[GSI]   %s\n", cfg_dir);
+                return;
+            }
 
-            if (GetFileAttributesA(filepath) != INVALID_FILE_ATTRIBUTES) {
+            if (plat_path_exists(filepath)) {
                 printf("[GSI] Config exists: %s\n", filepath);
                 return;
             }
@@ -555,7 +569,7 @@ static void create_gsi_config(void) {
             FILE *f = fopen(filepath, "w");
             if (f) {
                 fprintf(f, "\"wooting-aim\"\n{\n");
-                fprintf(f, "    \"uri\" \"http://127.0.0.1:%d\"\n", g_cfg.gsi_port);
+                fprintf(f, "    \"uri\" \"http://127.0.0.1:%d\"\n", cfg_boot.gsi_port);
                 fprintf(f, "    \"timeout\" \"2.0\"\n");
                 fprintf(f, "    \"buffer\" \"0.0\"\n");
                 fprintf(f, "    \"throttle\" \"0.0\"\n");
@@ -578,32 +592,7 @@ static void create_gsi_config(void) {
     printf("[GSI] Create gamestate_integration_wooting_aim.cfg manually in:\n");
     printf("[GSI]   <Steam>/steamapps/common/Counter-Strike Global Offensive/game/csgo/cfg/\n");
     printf("[GSI] Content:\n");
-    printf("[GSI]   \"wooting-aim\" { \"uri\" \"http://127.0.0.1:%d\" ... }\n", g_cfg.gsi_port);
-}
-
-/* ================================================================
- * TIMER RESOLUTION (Windows NT)
- * ================================================================ */
-typedef LONG (NTAPI *NtSetTimerResolution_t)(ULONG, BOOLEAN, PULONG);
-static NtSetTimerResolution_t g_NtSetTimerResolution = NULL;
-
-static void set_timer_resolution(void) {
-    HMODULE ntdll = GetModuleHandleA("ntdll.dll");
-    if (!ntdll) return;
-    g_NtSetTimerResolution = (NtSetTimerResolution_t)
-        GetProcAddress(ntdll, "NtSetTimerResolution");
-    if (!g_NtSetTimerResolution) return;
-
-    ULONG current = 0;
-    g_NtSetTimerResolution(5000, TRUE, &current); /* 5000 * 100ns = 0.5ms */
-    printf("[SYS] Timer resolution: 0.5ms (was %.1fms)\n", current / 10000.0);
-}
-
-static void restore_timer_resolution(void) {
-    if (g_NtSetTimerResolution) {
-        ULONG current;
-        g_NtSetTimerResolution(5000, FALSE, &current);
-    }
+    printf("[GSI]   \"wooting-aim\" { \"uri\" \"http://127.0.0.1:%d\" ... }\n", cfg_boot.gsi_port);
 }
 
 /* ================================================================
@@ -616,7 +605,7 @@ static void restore_timer_resolution(void) {
 typedef struct {
     float vel;       /* estimated velocity (units/s) */
     float max_speed; /* current weapon max speed */
-    LARGE_INTEGER last_update;
+    int64_t last_update;
 } VelEstimator;
 
 /*
@@ -630,10 +619,10 @@ typedef struct {
  * Per-tick fixed decel (below stopspeed): 80 * 5.2 * 0.015625 = 6.5 u/s
  */
 static void vel_update(VelEstimator *ve, float pos_analog, float neg_analog,
-                        float max_speed, LARGE_INTEGER now, double freq) {
+                        float max_speed, int64_t now, double freq) {
     ve->max_speed = max_speed;
 
-    double elapsed = (double)(now.QuadPart - ve->last_update.QuadPart) / freq;
+    double elapsed = (double)(now - ve->last_update) / freq;
     if (elapsed <= 0 || elapsed > 0.1) {
         ve->last_update = now;
         return;
@@ -680,65 +669,190 @@ static void vel_update(VelEstimator *ve, float pos_analog, float neg_analog,
 /* ================================================================
  * GLOBAL CLEANUP
  * ================================================================ */
-/* Forward declarations for cleanup */
-typedef struct { FILE *file; } Stats;
-static void stats_close(Stats *st);
-
 static volatile bool g_running = true;
+static atomic_bool g_sampling;          /* sampler loop running: sessions in use */
+static PlatEvent g_cleanup_done;        /* restore_and_cleanup has finished */
 static WootingHID *g_hid = NULL;
 static bool g_adaptive = false;
-static HANDLE g_gsi_thread = NULL;
+static PlatThread g_gsi_thread;
+static Stats g_stats_log;      /* one store for every keyboard, the sampler its only producer */
 static Stats *g_stats = NULL;  /* for cleanup on Ctrl+C */
 
+/* --watch: CS2 start/exit (proc_watch.c) */
+static ProcWatch g_proc;
+static volatile bool g_cs2_closed = false;
+
+/* Called from the watcher thread the moment CS2 exits */
+static void on_cs2_exit(void *user) {
+    (void)user;
+    g_cs2_closed = true;
+    g_running = false;
+}
+
+/* Sampler -> renderer: latest snapshot + transition lines */
+#define EVENT_RING_SIZE 64       /* power of two */
+static TelemetrySeqlock g_telem;
+static SpscRing g_events;
+static TelemetryEvent g_event_slots[EVENT_RING_SIZE];
+static atomic_uint g_events_dropped;
+static atomic_bool g_render_running;
+static atomic_bool g_render_go;          /* set once thread placement is reported */
+static PlatThread g_render_thread;
+
+/* Sampler -> external overlays (shared memory, novel frames only) */
+static TelemetryShm g_shm;
+static TelemetryFrame g_shm_last;
+
+/*
+ * Thread placement: the sampler gets sampler_cpus / sampler_priority /
+ * MMCSS; every other thread keeps its own priority and runs on aux_cpus,
+ * minus sampler_cpus when isolate_sampler is set.
+ */
+static uint64_t aux_cpu_mask(void) {
+    uint64_t m = cfg_boot.aux_cpus;
+    if (cfg_boot.isolate_sampler && cfg_boot.sampler_cpus) {
+        if (!m) m = thread_cpus_available();
+        m &= ~cfg_boot.sampler_cpus;
+    }
+    return m;
+}
+
+static void place_aux(const PlatThread *t) {
+    ThreadPlacement p = { aux_cpu_mask(), THREAD_PRIO_DEFAULT, false, false };
+    if (t && t->started && p.cpus) thread_place(t, &p);
+}
+
+/* t = NULL reports the calling thread */
+static void report_placement(const char *role, const PlatThread *t) {
+    char buf[160];
+    thread_place_report(t, buf, sizeof(buf));
+    printf("[CPU] %-8s %s\n", role, buf);
+}
+
+/*
+ * Trace recorder: a reader of our own telemetry ring that saves every frame
+ * to a .watrace file. The sampler is unaware of it, so recording costs the
+ * hot path nothing. Started and stopped from the control channel.
+ */
+#define TRACE_POLL_MS 10         /* ring holds 4096 frames: ample headroom */
+
+static TraceFile g_trace;
+static char g_trace_path[PLAT_PATH_MAX];
+static atomic_bool g_trace_running;
+static PlatThread g_trace_thread;
+
+static void trace_thread(void *param) {
+    (void)param;
+    TelemetryCursor cur;
+    TelemetryFrame f;
+    telemetry_cursor_init(&g_shm, &cur);
+    for (;;) {
+        bool stop = !atomic_load(&g_trace_running);
+        while (telemetry_shm_next(&g_shm, &cur, &f))
+            if (!trace_write(&g_trace, &f)) stop = true;
+        if (stop) break;
+        plat_sleep_ms(TRACE_POLL_MS);
+    }
+    g_trace.hdr.lost = (uint32_t)cur.lost;
+}
+
+static bool trace_record_start(const char *path) {
+    if (!g_shm.hdr || g_trace_thread.started) return false;
+    if (!trace_create(&g_trace, path, g_shm.hdr->tick_freq)) return false;
+    snprintf(g_trace_path, sizeof(g_trace_path), "%s", path);
+    atomic_store(&g_trace_running, true);
+    if (!plat_thread_start(&g_trace_thread, trace_thread, NULL, PLAT_PRIO_BELOW_NORMAL)) {
+        trace_close(&g_trace);
+        return false;
+    }
+    place_aux(&g_trace_thread);
+    return true;
+}
+
+/* Returns false if nothing was recording */
+static bool trace_record_stop(void) {
+    if (!g_trace_thread.started) return false;
+    atomic_store(&g_trace_running, false);
+    plat_thread_join(&g_trace_thread, -1);
+    trace_close(&g_trace);
+    return true;
+}
+
+static ControlServer g_control;
+
+/* Device sessions (below): stop hot-plug, restore and close every board */
+static void devices_shutdown(void);
+
+/* Stop the renderer; it flushes pending transition lines before exiting */
+static void stop_renderer(void) {
+    notices_route(false);
+    atomic_store(&g_render_running, false);
+    atomic_store(&g_render_go, true);
+    plat_thread_join(&g_render_thread, 1000);
+}
+
+/* Main thread only, once nothing else is sampling; later calls do nothing */
 static void restore_and_cleanup(void) {
+    static atomic_bool done;
+    if (atomic_exchange(&done, true)) return;
+
+    stop_renderer();
+    config_watch_stop();
+    control_stop(&g_control);
+    trace_record_stop();
+    proc_watch_close(&g_proc);
+    devices_shutdown();
+
     if (g_hid && g_adaptive) {
         printf("\n\nRestoring keyboard to normal settings...\n");
-        KeySetting ap[] = {
-            { KEY_W_ROW, KEY_W_COL, g_cfg.ap_normal },
-            { KEY_A_ROW, KEY_A_COL, g_cfg.ap_normal },
-            { KEY_S_ROW, KEY_S_COL, g_cfg.ap_normal },
-            { KEY_D_ROW, KEY_D_COL, g_cfg.ap_normal },
-        };
-        KeySetting rt[] = {
-            { KEY_W_ROW, KEY_W_COL, g_cfg.rt_normal },
-            { KEY_A_ROW, KEY_A_COL, g_cfg.rt_normal },
-            { KEY_S_ROW, KEY_S_COL, g_cfg.rt_normal },
-            { KEY_D_ROW, KEY_D_COL, g_cfg.rt_normal },
-        };
-        wooting_hid_write_actuation(g_hid, PROFILE_IDX, ap, 4, false);
-        wooting_hid_write_rt(g_hid, PROFILE_IDX, rt, 4, false);
+        KeySetting ap[MAX_KEYS], rt[MAX_KEYS];
+        int n = keys_normal(ap, rt);
+        wooting_hid_write_actuation(g_hid, PROFILE_IDX, ap, n, false);
+        wooting_hid_write_rt(g_hid, PROFILE_IDX, rt, n, false);
         printf("Settings restored.\n");
     }
 
     /* Stop GSI server */
     g_gsi_running = false;
-    if (g_gsi_thread) {
-        WaitForSingleObject(g_gsi_thread, 3000);
-        CloseHandle(g_gsi_thread);
-    }
+    plat_thread_join(&g_gsi_thread, 3000);
+
+    metrics_stop(&g_metrics);
+
+    plat_net_cleanup();
 
-    /* Cleanup winsock */
-    WSACleanup();
+    /* The sampler publishes into the ring: unmap it only once its loop has
+     * exited (every caller is past that point, this just keeps it so) */
+    if (!atomic_load(&g_sampling)) telemetry_shm_close(&g_shm);
 
-    /* Flush and close stats file */
+    /* Stop stats writer thread, drain queue, close file */
     if (g_stats) stats_close(g_stats);
 
     /* Restore timer */
-    restore_timer_resolution();
+    plat_timer_resolution_end();
 
-    if (g_hid) wooting_hid_close(g_hid);
+    if (g_hid) {
+        wooting_hid_close(g_hid);
+        g_hid = NULL;
+    }
+    ftrace_finish();
     wooting_analog_uninitialise();
+    thread_place_release();
+    plat_event_signal(&g_cleanup_done);
 }
 
-static BOOL WINAPI console_handler(DWORD event) {
-    if (event == CTRL_CLOSE_EVENT || event == CTRL_C_EVENT ||
-        event == CTRL_BREAK_EVENT || event == CTRL_LOGOFF_EVENT ||
-        event == CTRL_SHUTDOWN_EVENT) {
-        g_running = false;
-        restore_and_cleanup();
-        return TRUE;
-    }
-    return FALSE;
+/*
+ * Ctrl+C / console close / SIGTERM. Only asks everything to stop: the main
+ * thread cleans up on its way out, after the sampler loop has exited. On
+ * Windows the process may be killed once this returns, so wait for that.
+ */
+#define CLEANUP_WAIT_MS 5000
+
+static void on_terminate(void) {
+    g_running = false;
+    proc_watch_cancel(&g_proc);
+#if PLAT_EXIT_AFTER_HANDLER
+    plat_event_wait(&g_cleanup_done, CLEANUP_WAIT_MS);
+#endif
 }
 
 /* ================================================================
@@ -758,20 +872,20 @@ typedef struct {
     AxisState state, prev;
     float pos_peak, neg_peak;
     bool predictive;
-    LARGE_INTEGER counter_start;
+    int64_t counter_start;
     double counter_ms;
-    unsigned long long counter_count;
-    double counter_total_ms;
+    float counter_vel;             /* |axis velocity| when the counter-strafe began */
 
     /* Jiggle peek detection */
-    LARGE_INTEGER jiggle_times[4]; /* timestamps of recent counter-strafes */
+    int64_t jiggle_times[4]; /* timestamps of recent counter-strafes */
     int jiggle_idx;
     bool is_jiggle;                /* true when jiggle pattern detected */
-    LARGE_INTEGER jiggle_last;     /* timestamp of last jiggle detection */
+    int64_t jiggle_last;     /* timestamp of last jiggle detection */
 } Axis;
 
-static void axis_update(Axis *ax, float pos, float neg,
-                         float prev_pos, float prev_neg, double freq) {
+static void axis_update(Axis *ax, const Config *cfg, float pos, float neg,
+                         float prev_pos, float prev_neg, int64_t now, double freq) {
+    INS_TIME_BEGIN(ins_t);
     ax->prev = ax->state;
     ax->predictive = false;
 
@@ -788,52 +902,41 @@ static void axis_update(Axis *ax, float pos, float neg,
     case S_STRAFE_POS:
         if (!pp && !np) { ax->state = S_IDLE; break; }
         if (pos > ax->pos_peak) ax->pos_peak = pos;
-        if (ax->pos_peak > g_cfg.predict_min_peak &&
-            pos < ax->pos_peak * g_cfg.predict_threshold)
+        if (ax->pos_peak > cfg->predict_min_peak &&
+            pos < ax->pos_peak * cfg->predict_threshold)
             ax->predictive = true;
-        if (nr) { ax->state = S_COUNTER_NEG; QueryPerformanceCounter(&ax->counter_start); }
+        if (nr) { ax->state = S_COUNTER_NEG; ax->counter_start = now; }
         break;
 
     case S_STRAFE_NEG:
         if (!pp && !np) { ax->state = S_IDLE; break; }
         if (neg > ax->neg_peak) ax->neg_peak = neg;
-        if (ax->neg_peak > g_cfg.predict_min_peak &&
-            neg < ax->neg_peak * g_cfg.predict_threshold)
+        if (ax->neg_peak > cfg->predict_min_peak &&
+            neg < ax->neg_peak * cfg->predict_threshold)
             ax->predictive = true;
-        if (pr) { ax->state = S_COUNTER_POS; QueryPerformanceCounter(&ax->counter_start); }
+        if (pr) { ax->state = S_COUNTER_POS; ax->counter_start = now; }
         break;
 
     case S_COUNTER_POS:
-    case S_COUNTER_NEG: {
-        LARGE_INTEGER now;
-        QueryPerformanceCounter(&now);
-        ax->counter_ms = (double)(now.QuadPart - ax->counter_start.QuadPart) * 1000.0 / freq;
+    case S_COUNTER_NEG:
+        ax->counter_ms = (double)(now - ax->counter_start) * 1000.0 / freq;
         if (!pp && !np) ax->state = S_IDLE;
         else if (pp && !np) { ax->state = S_STRAFE_POS; ax->pos_peak = pos; }
         else if (np && !pp) { ax->state = S_STRAFE_NEG; ax->neg_peak = neg; }
         break;
     }
-    }
-
-    if (ax->state != ax->prev &&
-        (ax->prev == S_COUNTER_POS || ax->prev == S_COUNTER_NEG)) {
-        ax->counter_count++;
-        ax->counter_total_ms += ax->counter_ms;
-    }
 
     /* Jiggle peek: record counter-strafe entry timestamps */
     if (ax->state != ax->prev &&
         (ax->state == S_COUNTER_POS || ax->state == S_COUNTER_NEG)) {
-        LARGE_INTEGER now;
-        QueryPerformanceCounter(&now);
         ax->jiggle_times[ax->jiggle_idx & 3] = now;
         ax->jiggle_idx = (ax->jiggle_idx + 1) & 0x7FFFFFFF;
 
         /* Check if enough recent counter-strafes within the window */
         int recent = 0;
         for (int i = 0; i < 4; i++) {
-            if (ax->jiggle_times[i].QuadPart == 0) continue;
-            double age = (double)(now.QuadPart - ax->jiggle_times[i].QuadPart) * 1000.0 / freq;
+            if (ax->jiggle_times[i] == 0) continue;
+            double age = (double)(now - ax->jiggle_times[i]) * 1000.0 / freq;
             if (age < JIGGLE_WINDOW_MS) recent++;
         }
         if (recent >= JIGGLE_MIN_COUNT) {
@@ -844,60 +947,13 @@ static void axis_update(Axis *ax, float pos, float neg,
 
     /* Expire jiggle mode */
     if (ax->is_jiggle) {
-        LARGE_INTEGER now;
-        QueryPerformanceCounter(&now);
-        double since_last = (double)(now.QuadPart - ax->jiggle_last.QuadPart) * 1000.0 / freq;
+        double since_last = (double)(now - ax->jiggle_last) * 1000.0 / freq;
         if (since_last > JIGGLE_PREARM_MS) ax->is_jiggle = false;
     }
-}
-
-/* ================================================================
- * STATISTICS
- * ================================================================ */
-static void stats_init(Stats *st, const char *path) {
-    st->file = fopen(path, "a");
-    if (st->file) {
-        fseek(st->file, 0, SEEK_END);
-        if (ftell(st->file) == 0)
-            fprintf(st->file, "timestamp,axis,direction,counter_strafe_ms,weapon\n");
-        printf("[STATS] Logging to: %s\n", path);
-    }
-}
-
-static void stats_log(Stats *st, const char *axis, const char *dir, double ms, const char *weapon) {
-    if (!st->file) return;
-    time_t now = time(NULL);
-    struct tm *t = localtime(&now);
-    fprintf(st->file, "%04d-%02d-%02d %02d:%02d:%02d,%s,%s,%.2f,%s\n",
-            t->tm_year+1900, t->tm_mon+1, t->tm_mday,
-            t->tm_hour, t->tm_min, t->tm_sec, axis, dir, ms, weapon);
-    fflush(st->file);
-}
-
-static void stats_close(Stats *st) {
-    if (st->file) fclose(st->file);
-    st->file = NULL;
-}
-
-/* ================================================================
- * PROCESS DETECTION (for --watch mode)
- * ================================================================ */
-static bool is_process_running(const char *name) {
-    HANDLE snap = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
-    if (snap == INVALID_HANDLE_VALUE) return false;
-
-    PROCESSENTRY32 pe;
-    pe.dwSize = sizeof(pe);
-    bool found = false;
-
-    if (Process32First(snap, &pe)) {
-        do {
-            if (_stricmp(pe.szExeFile, name) == 0) { found = true; break; }
-        } while (Process32Next(snap, &pe));
-    }
 
-    CloseHandle(snap);
-    return found;
+    INS_ADD(IC_AXIS_UPDATES, 1);
+    if (ax->state != ax->prev) INS_ADD(IC_TRANSITIONS, 1);
+    INS_TIME_END(IT_AXIS, ins_t);
 }
 
 /* ================================================================
@@ -911,13 +967,13 @@ typedef struct {
     Axis v;   /* vertical:   S(neg) / W(pos) */
     bool crouching;
 
-    float target_ap[4];
-    float target_rt[4];
-    float current_ap[4];
-    float current_rt[4];
+    float target_ap[MAX_KEYS];     /* [K_W..K_D] movement, then extras */
+    float target_rt[MAX_KEYS];
+    float current_ap[MAX_KEYS];
+    float current_rt[MAX_KEYS];
 
     bool needs_write;
-    LARGE_INTEGER last_write_time;
+    int64_t last_write_time;
     unsigned long long write_count;
     unsigned long long frame;
 
@@ -926,26 +982,34 @@ typedef struct {
     char weapon_name[64];
     char round_phase[16];
     float weapon_speed;
+    uint8_t weapon_id;
     bool gsi_active;
 
     /* Velocity estimation */
     VelEstimator vel_h;
     VelEstimator vel_v;
 
-    Stats stats;
+    /* Counter-strafe timing distributions: [axis][dir 0=neg 1=pos][weapon] */
+    Histogram hist[2][2][WCAT_COUNT];
+    Histogram hist_axis[2];
+    float live_p50, live_p90, live_perf;  /* H axis, refreshed per counter-strafe */
+
+    /* Idle governor */
+    bool idle;                     /* parked: sampling at idle_poll_hz, no engine work */
+    int64_t last_active;           /* QPC ticks of the last frame with a key past the dead zone */
 } AimContext;
 
+_Static_assert(sizeof(((AimContext *)0)->weapon_name) == sizeof(g_gsi.weapon_name) &&
+               sizeof(((AimContext *)0)->round_phase) == sizeof(g_gsi.round_phase),
+               "gsi_snapshot copies the GSI strings whole");
+
 /*
  * Get the base AP/RT for aggressive mode, considering GSI weapon.
  */
-static void get_base_aggro(AimContext *ctx, float *ap, float *rt) {
-    if (ctx->gsi_active && ctx->weapon_cat < WCAT_COUNT) {
-        *ap = g_cfg.weapon[ctx->weapon_cat].ap;
-        *rt = g_cfg.weapon[ctx->weapon_cat].rt;
-    } else {
-        *ap = g_cfg.ap_aggro;
-        *rt = g_cfg.rt_aggro;
-    }
+static void get_base_aggro(const AimContext *ctx, const Config *cfg, float *ap, float *rt) {
+    int idx = (ctx->gsi_active && ctx->weapon_cat < WCAT_COUNT) ? (int)ctx->weapon_cat : WCAT_COUNT;
+    *ap = cfg->aggro[idx].ap;
+    *rt = cfg->aggro[idx].rt;
 }
 
 /*
@@ -966,32 +1030,39 @@ static float vel_scale_ap(float base_ap, float vel_ratio) {
 
 /*
  * Counter-strafe phase decay.
- * In the first PHASE_ULTRA_MS: use minimum AP (0.1mm)
- * Then linearly relax back to base_ap over PHASE_DECAY_MS.
+ * In the first phase_ultra_ms: use minimum AP (0.15mm)
+ * Then linearly relax back to base_ap by phase_decay_ms.
+ * Defaults 80/200 ms: the ultra phase matches an AK counter-strafe to 34%.
  */
-static float phase_decay_ap(float base_ap, double counter_ms) {
+static float phase_decay_ap(const Config *cfg, float base_ap, double counter_ms) {
     /* Min AP = 0.15mm to prevent ghost inputs from lateral stem wobble.
      * Research: sub-0.15mm AP causes phantom triggers from 0.5mm wobble. */
     const float min_ap = 0.15f;
-    if (counter_ms < PHASE_ULTRA_MS) return min_ap;
-    if (counter_ms > PHASE_DECAY_MS) return base_ap;
-    float t = (float)(counter_ms - PHASE_ULTRA_MS) / (float)(PHASE_DECAY_MS - PHASE_ULTRA_MS);
+    if (counter_ms < cfg->phase_ultra_ms) return min_ap;
+    if (counter_ms >= cfg->phase_decay_ms) return base_ap;
+    float t = (float)(counter_ms - cfg->phase_ultra_ms) / (cfg->phase_decay_ms - cfg->phase_ultra_ms);
     return min_ap + t * (base_ap - min_ap);
 }
 
-/*
- * Combine both axes + crouch + weapon into per-key targets.
- */
-static void update_targets(AimContext *ctx) {
-    /* Read GSI state (thread-safe) */
-    EnterCriticalSection(&g_gsi.lock);
+/* Local copy of the GSI state for this frame (thread-safe) */
+static void gsi_snapshot(AimContext *ctx) {
+    plat_mutex_lock(&g_gsi.lock);
     ctx->weapon_cat   = g_gsi.weapon_cat;
-    strncpy(ctx->weapon_name, g_gsi.weapon_name, sizeof(ctx->weapon_name) - 1);
-    strncpy(ctx->round_phase, g_gsi.round_phase, sizeof(ctx->round_phase) - 1);
+    memcpy(ctx->weapon_name, g_gsi.weapon_name, sizeof(ctx->weapon_name));
+    memcpy(ctx->round_phase, g_gsi.round_phase, sizeof(ctx->round_phase));
     ctx->weapon_speed = g_gsi.weapon_speed;
+    ctx->weapon_id    = g_gsi.weapon_id;
     ctx->gsi_active   = g_gsi.connected;
-    LeaveCriticalSection(&g_gsi.lock);
+    plat_mutex_unlock(&g_gsi.lock);
+}
 
+/*
+ * Combine both axes + crouch + weapon into per-key targets. Reads only
+ * ctx, cfg and the key layout, so recorded traces replay through it
+ * (sweep.c).
+ */
+static void update_targets(AimContext *ctx, const Config *cfg) {
+    INS_TIME_BEGIN(ins_t);
     /* During freezetime or when dead: relax to normal */
     bool freezetime = ctx->gsi_active &&
         (strcmp(ctx->round_phase, "freezetime") == 0 ||
@@ -1000,10 +1071,19 @@ static void update_targets(AimContext *ctx) {
     /* If weapon is grenade/C4/other and GSI active, relax */
     bool non_combat = ctx->gsi_active && ctx->weapon_cat == WCAT_OTHER;
 
-    float ap[4], rt[4];
-    for (int i = 0; i < 4; i++) {
-        ap[i] = g_cfg.ap_normal;
-        rt[i] = g_cfg.rt_normal;
+    float ap[MAX_KEYS], rt[MAX_KEYS];
+    for (int i = 0; i < g_key_count; i++) {
+        ap[i] = cfg->ap_normal;
+        rt[i] = cfg->rt_normal;
+    }
+
+    /* Extra keys (jump, walk, utility): one setting for the live round,
+     * grenades in hand included */
+    if (!freezetime) {
+        for (int i = K_EXTRA; i < g_key_count; i++) {
+            ap[i] = cfg->ap_extra;
+            rt[i] = cfg->rt_extra;
+        }
     }
 
     if (freezetime || non_combat) {
@@ -1012,11 +1092,11 @@ static void update_targets(AimContext *ctx) {
     }
 
     float base_ap, base_rt;
-    get_base_aggro(ctx, &base_ap, &base_rt);
+    get_base_aggro(ctx, cfg, &base_ap, &base_rt);
 
     /* Velocity-aware AP scaling */
     float vel_ap = base_ap;
-    if (g_cfg.vel_scale_enabled && g_cfg.vel_enabled) {
+    if (cfg->vel_scale_enabled && cfg->vel_enabled) {
         float total_vel = sqrtf(ctx->vel_h.vel * ctx->vel_h.vel +
                                 ctx->vel_v.vel * ctx->vel_v.vel);
         float max_spd = ctx->weapon_speed > 0 ? ctx->weapon_speed : 225.0f;
@@ -1030,7 +1110,7 @@ static void update_targets(AimContext *ctx) {
     switch (ctx->h.state) {
     case S_IDLE:
         /* Jiggle mode: pre-arm both directions */
-        if (g_cfg.jiggle_enabled && ctx->h.is_jiggle) {
+        if (cfg->jiggle_enabled && ctx->h.is_jiggle) {
             ap[K_A] = vel_ap; rt[K_A] = base_rt;
             ap[K_D] = vel_ap; rt[K_D] = base_rt;
         }
@@ -1038,25 +1118,25 @@ static void update_targets(AimContext *ctx) {
     case S_STRAFE_POS: /* D held */
         rt[K_D] = base_rt;
         ap[K_A] = vel_ap;
-        if (ctx->h.predictive || (g_cfg.jiggle_enabled && ctx->h.is_jiggle))
+        if (ctx->h.predictive || (cfg->jiggle_enabled && ctx->h.is_jiggle))
             rt[K_A] = base_rt;
         break;
     case S_STRAFE_NEG: /* A held */
         rt[K_A] = base_rt;
         ap[K_D] = vel_ap;
-        if (ctx->h.predictive || (g_cfg.jiggle_enabled && ctx->h.is_jiggle))
+        if (ctx->h.predictive || (cfg->jiggle_enabled && ctx->h.is_jiggle))
             rt[K_D] = base_rt;
         break;
     case S_COUNTER_POS: { /* pressing D to counter */
         float c_ap = vel_ap;
-        if (g_cfg.phase_decay) c_ap = phase_decay_ap(vel_ap, ctx->h.counter_ms);
+        if (cfg->phase_decay) c_ap = phase_decay_ap(cfg, vel_ap, ctx->h.counter_ms);
         ap[K_D] = c_ap; rt[K_D] = base_rt;
         rt[K_A] = base_rt;
         break;
     }
     case S_COUNTER_NEG: { /* pressing A to counter */
         float c_ap = vel_ap;
-        if (g_cfg.phase_decay) c_ap = phase_decay_ap(vel_ap, ctx->h.counter_ms);
+        if (cfg->phase_decay) c_ap = phase_decay_ap(cfg, vel_ap, ctx->h.counter_ms);
         ap[K_A] = c_ap; rt[K_A] = base_rt;
         rt[K_D] = base_rt;
         break;
@@ -1064,10 +1144,10 @@ static void update_targets(AimContext *ctx) {
     }
 
     /* Vertical: S=neg(K_S), W=pos(K_W) - only if ws_adaptive enabled */
-    if (g_cfg.ws_adaptive) {
+    if (cfg->ws_adaptive) {
         switch (ctx->v.state) {
         case S_IDLE:
-            if (g_cfg.jiggle_enabled && ctx->v.is_jiggle) {
+            if (cfg->jiggle_enabled && ctx->v.is_jiggle) {
                 ap[K_W] = vel_ap; rt[K_W] = base_rt;
                 ap[K_S] = vel_ap; rt[K_S] = base_rt;
             }
@@ -1075,25 +1155,25 @@ static void update_targets(AimContext *ctx) {
         case S_STRAFE_POS:
             rt[K_W] = base_rt;
             ap[K_S] = vel_ap;
-            if (ctx->v.predictive || (g_cfg.jiggle_enabled && ctx->v.is_jiggle))
+            if (ctx->v.predictive || (cfg->jiggle_enabled && ctx->v.is_jiggle))
                 rt[K_S] = base_rt;
             break;
         case S_STRAFE_NEG:
             rt[K_S] = base_rt;
             ap[K_W] = vel_ap;
-            if (ctx->v.predictive || (g_cfg.jiggle_enabled && ctx->v.is_jiggle))
+            if (ctx->v.predictive || (cfg->jiggle_enabled && ctx->v.is_jiggle))
                 rt[K_W] = base_rt;
             break;
         case S_COUNTER_POS: {
             float c_ap = vel_ap;
-            if (g_cfg.phase_decay) c_ap = phase_decay_ap(vel_ap, ctx->v.counter_ms);
+            if (cfg->phase_decay) c_ap = phase_decay_ap(cfg, vel_ap, ctx->v.counter_ms);
             ap[K_W] = c_ap; rt[K_W] = base_rt;
             rt[K_S] = base_rt;
             break;
         }
         case S_COUNTER_NEG: {
             float c_ap = vel_ap;
-            if (g_cfg.phase_decay) c_ap = phase_decay_ap(vel_ap, ctx->v.counter_ms);
+            if (cfg->phase_decay) c_ap = phase_decay_ap(cfg, vel_ap, ctx->v.counter_ms);
             ap[K_S] = c_ap; rt[K_S] = base_rt;
             rt[K_W] = base_rt;
             break;
@@ -1107,71 +1187,1082 @@ static void update_targets(AimContext *ctx) {
      * Research: crouching = 34% of MaxPlayerSpeed, so you're shootable while moving. */
     if (ctx->crouching) {
         for (int i = 0; i < 4; i++) {
-            float crt = rt[i] * g_cfg.crouch_rt_factor;
+            float crt = rt[i] * cfg->crouch_rt_factor;
             if (crt < base_rt) crt = base_rt;
             rt[i] = crt;
             /* Relax AP slightly when crouching - already near accuracy zone */
-            if (ap[i] < g_cfg.ap_normal) {
-                ap[i] = ap[i] + (g_cfg.ap_normal - ap[i]) * 0.3f;
+            if (ap[i] < cfg->ap_normal) {
+                ap[i] = ap[i] + (cfg->ap_normal - ap[i]) * 0.3f;
             }
         }
     }
 
 check_changed:;
     bool changed = false;
-    for (int i = 0; i < 4; i++) {
+    for (int i = 0; i < g_key_count; i++) {
         if (ap[i] != ctx->target_ap[i] || rt[i] != ctx->target_rt[i]) {
             changed = true; break;
         }
     }
 
     if (changed) {
-        memcpy(ctx->target_ap, ap, sizeof(ap));
-        memcpy(ctx->target_rt, rt, sizeof(rt));
+        memcpy(ctx->target_ap, ap, (size_t)g_key_count * sizeof(float));
+        memcpy(ctx->target_rt, rt, (size_t)g_key_count * sizeof(float));
         ctx->needs_write = true;
+        if (ftrace_on()) ftrace_instant(FT_TARGETS, 0);
     }
-}
 
-static void do_write(AimContext *ctx, WootingHID *hid, double freq) {
-    if (!ctx->needs_write || !hid) return;
+    INS_ADD(IC_TARGET_UPDATES, 1);
+    if (changed) INS_ADD(IC_TARGET_CHANGES, 1);
+    INS_TIME_END(IT_TARGETS, ins_t);
+}
 
-    LARGE_INTEGER now;
-    QueryPerformanceCounter(&now);
-    double elapsed = (double)(now.QuadPart - ctx->last_write_time.QuadPart) * 1000.0 / freq;
-    if (elapsed < g_cfg.write_interval_ms) return;
+/* Hand the new targets to the keyboard's writer thread; never blocks */
+static void do_write(AimContext *ctx, HidQueue *q) {
+    if (!ctx->needs_write || !q) return;
 
-    KeySetting ap[] = {
-        { KEY_W_ROW, KEY_W_COL, ctx->target_ap[K_W] },
-        { KEY_A_ROW, KEY_A_COL, ctx->target_ap[K_A] },
-        { KEY_S_ROW, KEY_S_COL, ctx->target_ap[K_S] },
-        { KEY_D_ROW, KEY_D_COL, ctx->target_ap[K_D] },
-    };
-    KeySetting rt[] = {
-        { KEY_W_ROW, KEY_W_COL, ctx->target_rt[K_W] },
-        { KEY_A_ROW, KEY_A_COL, ctx->target_rt[K_A] },
-        { KEY_S_ROW, KEY_S_COL, ctx->target_rt[K_S] },
-        { KEY_D_ROW, KEY_D_COL, ctx->target_rt[K_D] },
-    };
+    int64_t now = plat_ticks();
+    if (now - ctx->last_write_time < g_cfg->write_interval_ticks) {
+        INS_ADD(IC_WRITES_DEFERRED, 1);
+        return;
+    }
+    if (ftrace_on()) ftrace_span(FT_WRITE, now, -1, 0);
+    INS_TIME_BEGIN(ins_t);
+
+    /* Every adaptive key; the writer sends only what the board lacks */
+    HidWriteJob job;
+    job.ticks = now;
+    job.frame = ctx->frame;
+    job.count = g_key_count;
+    for (int i = 0; i < g_key_count; i++) {
+        job.ap[i] = (KeySetting){ g_keys[i].row, g_keys[i].col, ctx->target_ap[i] };
+        job.rt[i] = (KeySetting){ g_keys[i].row, g_keys[i].col, ctx->target_rt[i] };
+    }
 
-    wooting_hid_write_actuation(hid, PROFILE_IDX, ap, 4, false);
-    wooting_hid_write_rt(hid, PROFILE_IDX, rt, 4, false);
+    /* Ring full: the writer is stuck on this board, try again next frame */
+    if (!hid_queue_push(q, &job)) return;
 
-    memcpy(ctx->current_ap, ctx->target_ap, sizeof(ctx->target_ap));
-    memcpy(ctx->current_rt, ctx->target_rt, sizeof(ctx->target_rt));
+    memcpy(ctx->current_ap, ctx->target_ap, (size_t)g_key_count * sizeof(float));
+    memcpy(ctx->current_rt, ctx->target_rt, (size_t)g_key_count * sizeof(float));
     ctx->needs_write = false;
     ctx->last_write_time = now;
     ctx->write_count++;
+    INS_ADD(IC_WRITES, 1);
+    INS_TIME_END(IT_WRITE, ins_t);
+}
+
+/*
+ * Queue a completed counter-strafe for the stats writer thread.
+ * ax->prev is the COUNTER state that just ended.
+ */
+static void stats_log_counter(AimContext *ctx, const Axis *ax, uint8_t axis,
+                              int64_t ticks) {
+    static const char key_names[4] = { 'W', 'A', 'S', 'D' };
+    bool pos = ax->prev == S_COUNTER_POS;
+    int key = (axis == STATS_AXIS_H) ? (pos ? K_D : K_A) : (pos ? K_W : K_S);
+
+    StatsEvent ev = {
+        .ticks      = ticks,
+        .counter_ms = (float)ax->counter_ms,
+        .vel_start  = ax->counter_vel,
+        .ap_mm      = ctx->current_ap[key],
+        .rt_mm      = ctx->current_rt[key],
+        .axis       = axis,
+        .dir        = (uint8_t)key_names[key],
+        .weapon_id  = ctx->gsi_active ? ctx->weapon_id : 0,
+        .weapon_cat = (uint8_t)(ctx->gsi_active ? ctx->weapon_cat : WCAT_OTHER),
+    };
+    stats_log(&g_stats_log, &ev);
+}
+
+/*
+ * Record a completed counter-strafe into the live histograms. O(1).
+ */
+static void hist_log_counter(AimContext *ctx, const Axis *ax, int axis) {
+    int dir = ax->prev == S_COUNTER_POS ? 1 : 0;
+    int cat = ctx->gsi_active ? ctx->weapon_cat : WCAT_OTHER;
+    hist_record(&ctx->hist[axis][dir][cat], ax->counter_ms);
+    hist_record(&ctx->hist_axis[axis], ax->counter_ms);
+    metric_observe(&g_metrics.sampler.counter_strafe[axis], &metric_bounds_strafe,
+                   (uint64_t)(ax->counter_ms * 1000.0));
+
+    /* Percentiles walk the buckets, so refresh them here, not per frame */
+    if (axis == STATS_AXIS_H) {
+        const Histogram *h = &ctx->hist_axis[axis];
+        ctx->live_p50  = (float)hist_percentile(h, 50);
+        ctx->live_p90  = (float)hist_percentile(h, 90);
+        ctx->live_perf = (float)h->quality[CSQ_PERF] / (float)h->total;
+    }
+}
+
+/*
+ * Queue a state transition line for the renderer. Never blocks: when the
+ * ring is full the line is dropped and counted.
+ */
+static void post_transition(const Axis *ax, int axis) {
+    bool counter = ax->prev == S_COUNTER_POS || ax->prev == S_COUNTER_NEG;
+    TelemetryEvent ev = {
+        .axis    = (uint8_t)axis,
+        .from    = (uint8_t)ax->prev,
+        .to      = (uint8_t)ax->state,
+        .quality = counter ? (uint8_t)strafe_quality(ax->counter_ms) : TELEMETRY_NO_QUALITY,
+        .ms      = counter ? (float)ax->counter_ms : 0.0f,
+    };
+    if (!spsc_push(&g_events, &ev))
+        atomic_fetch_add_explicit(&g_events_dropped, 1, memory_order_relaxed);
+    metric_add(&g_metrics.sampler.transitions[axis][ax->prev][ax->state], 1);
+    if (ftrace_on()) ftrace_instant(FT_TRANSITION, axis << 8 | (int)ax->state);
+}
+
+/* Publish this frame's snapshot for the renderer (seqlock, never blocks) */
+static void publish_telemetry(const AimContext *ctx, int64_t ticks, bool adaptive,
+                              float time_to_accurate_ms) {
+    TelemetryFrame tf;
+    tf.frame = ctx->frame;
+    tf.ticks = ticks;
+    tf.w = ctx->w; tf.a = ctx->a; tf.s = ctx->s; tf.d = ctx->d;
+    tf.ctrl = ctx->ctrl;
+    memcpy(tf.ap, ctx->current_ap, sizeof(tf.ap));
+    memcpy(tf.rt, ctx->current_rt, sizeof(tf.rt));
+
+    float max_spd = ctx->weapon_speed > 0 ? ctx->weapon_speed : 225.0f;
+    tf.vel = sqrtf(ctx->vel_h.vel * ctx->vel_h.vel + ctx->vel_v.vel * ctx->vel_v.vel);
+    tf.vel_threshold = max_spd * 0.34f;
+    tf.time_to_accurate_ms = time_to_accurate_ms;
+
+    tf.h_p50   = ctx->live_p50;
+    tf.h_p90   = ctx->live_p90;
+    tf.h_perf  = ctx->live_perf;
+    tf.h_count = (uint32_t)ctx->hist_axis[STATS_AXIS_H].total;
+    tf.write_count = ctx->write_count;
+
+    tf.h_state = (uint8_t)ctx->h.state;
+    tf.v_state = (uint8_t)ctx->v.state;
+    tf.flags = (ctx->h.predictive ? TF_H_PREDICTIVE : 0) |
+               (ctx->h.is_jiggle  ? TF_H_JIGGLE : 0) |
+               (ctx->v.predictive ? TF_V_PREDICTIVE : 0) |
+               (ctx->v.is_jiggle  ? TF_V_JIGGLE : 0) |
+               (ctx->crouching    ? TF_CROUCH : 0) |
+               (ctx->gsi_active   ? TF_GSI : 0) |
+               (adaptive          ? TF_ADAPTIVE : 0) |
+               (g_cfg->vel_enabled ? TF_VEL : 0);
+    tf.weapon_cat = (uint8_t)ctx->weapon_cat;
+    memcpy(tf.round_phase, ctx->round_phase, sizeof(tf.round_phase));
+    tf.idle = ctx->idle;
+
+    telemetry_publish(&g_telem, &tf);
+
+    /*
+     * The shared ring only gets frames that differ from the last one it got
+     * (inputs, states, AP/RT, velocity); consecutive identical reads at
+     * several MHz would just push overlays' history out of the ring.
+     */
+    if (g_shm.hdr) {
+        size_t from = offsetof(TelemetryFrame, w);
+        size_t len = offsetof(TelemetryFrame, idle) + sizeof(tf.idle) - from;
+        if (memcmp((const char *)&tf + from, (const char *)&g_shm_last + from, len) != 0) {
+            telemetry_shm_publish(&g_shm, &tf);
+            g_shm_last = tf;
+        }
+    }
+}
+
+/*
+ * Idle governor. Parks the loop once nothing is pressed, pending or
+ * pre-armed: for idle_after_ms, or at once outside a live round (menu,
+ * freezetime, round over). Parked frames only read the keys.
+ */
+static bool idle_should_park(const AimContext *ctx, int64_t now, bool hid) {
+    if (g_cfg->idle_after_ticks <= 0) return false;
+    if (ctx->h.state != S_IDLE || ctx->v.state != S_IDLE) return false;
+    if (ctx->h.is_jiggle || ctx->v.is_jiggle) return false;
+    if (ctx->needs_write && hid) return false;    /* relax the keyboard first */
+
+    bool live = !ctx->gsi_active || strcmp(ctx->round_phase, "live") == 0;
+    return !live || now - ctx->last_active >= g_cfg->idle_after_ticks;
+}
+
+/* First frame with input after a park: velocity restarts from rest */
+static void idle_wake(AimContext *ctx, int64_t now) {
+    ctx->idle = false;
+    ctx->vel_h.vel = 0.0f;
+    ctx->vel_v.vel = 0.0f;
+    ctx->vel_h.last_update = now;
+    ctx->vel_v.last_update = now;
 }
 
 /* ================================================================
- * DISPLAY
+ * DEVICE SESSIONS (one engine per connected keyboard)
  * ================================================================ */
+/*
+ * Every analog keyboard the SDK reports gets a slot: its own engine state,
+ * reads through wooting_analog_read_analog_device() and, when tuning, its
+ * own HID handle and writer thread. A key moving on one board therefore
+ * only ever writes to that board.
+ *
+ * Slots are added and removed by the device thread (hot-plug callback plus
+ * a slow rescan); the sampler never waits for it. Removal is a handshake:
+ * the device thread marks a slot CLOSING, the sampler stops using it and
+ * answers RETIRED between frames, and only then is it torn down.
+ */
+#define MAX_DEVICES        METRIC_DEVICES
+#define DEV_RESCAN_MS      1000
+#define DEV_RETIRE_WAIT_MS 1000
+
+/* ABANDONED: its writer never stopped and still owns the slot's queue and
+ * handle, so the slot is never reused */
+enum { SESS_FREE, SESS_LIVE, SESS_CLOSING, SESS_RETIRED, SESS_ABANDONED };
+
+typedef struct {
+    _Atomic int state;
+    WootingAnalog_DeviceID id;
+    uint16_t pid;
+    char name[64];
+    WootingHID *hid;               /* NULL when read-only or the open failed */
+    HidQueue writer;
+    AimContext ctx;
+    float analog[256];             /* by HID usage, kept current by read_full_buffer */
+    int64_t vel_timer;             /* velocity update rate limiter (~1000 Hz) */
+    float time_to_accurate_ms;     /* predicted ms until shootable */
+} DeviceSession;
+
+static DeviceSession g_dev[MAX_DEVICES];
+static bool g_dev_hid;             /* sessions open the keyboard for writing */
+
+/* Sampler-owned totals of sessions already removed */
+static Histogram g_gone_hist[2][2][WCAT_COUNT];
+static Histogram g_gone_hist_axis[2];
+static unsigned long long g_gone_writes;
+
+static PlatThread g_dev_thread;
+static PlatEvent g_dev_wake;
+static atomic_bool g_dev_running;
+
+/* Device thread: the sampler may swap configs meanwhile */
+static void ctx_init(AimContext *ctx) {
+    plat_mutex_lock(&g_cfg_publish_lock);
+    float ap_normal = config_latest()->ap_normal;
+    float rt_normal = config_latest()->rt_normal;
+    plat_mutex_unlock(&g_cfg_publish_lock);
+
+    memset(ctx, 0, sizeof(*ctx));
+    for (int i = 0; i < MAX_KEYS; i++) {
+        ctx->current_ap[i] = ap_normal;
+        ctx->current_rt[i] = rt_normal;
+        ctx->target_ap[i]  = ap_normal;
+        ctx->target_rt[i]  = rt_normal;
+    }
+    ctx->last_write_time = plat_ticks();
+    ctx->vel_h.max_speed = 225.0f;
+    ctx->vel_v.max_speed = 225.0f;
+    ctx->vel_h.last_update = ctx->last_write_time;
+    ctx->vel_v.last_update = ctx->last_write_time;
+    ctx->last_active = ctx->last_write_time;
+}
+
+/* Open, handshake and start the writer for the board behind SDK device `s` */
+static void session_open_hid(DeviceSession *s, int slot) {
+    /* The startup HID phase already opened one board: the session whose
+     * SDK device ID it hashes to takes it over. Boards sharing a PID are
+     * told apart by serial, never by enumeration order */
+    if (g_hid && wooting_hid_device_id(g_hid) == s->id) {
+        s->hid = g_hid;
+        g_hid = NULL;
+    } else {
+        s->hid = wooting_hid_open_match(HID_CACHE_PATH, s->id);
+        if (!s->hid) {
+            notice("[DEV] %s: no HID interface with a matching serial, read-only.", s->name);
+            return;
+        }
+        if (!wooting_hid_handshake(s->hid))
+            notice("[DEV] %s: handshake failed.", s->name);
+        if (!wooting_hid_activate_profile(s->hid, PROFILE_IDX))
+            notice("[DEV] %s: profile activation failed.", s->name);
+    }
+
+    char name[16];
+    snprintf(name, sizeof(name), "hid%d", slot);
+    if (!hid_queue_start(&s->writer, s->hid, PROFILE_IDX, &g_metrics.hid[slot], name)) {
+        wooting_hid_close(s->hid);
+        s->hid = NULL;
+        return;
+    }
+    place_aux(&s->writer.thread);
+}
+
+/* Device thread (or startup, before it runs) */
+static void session_add(const WootingAnalog_DeviceInfo_FFI *info) {
+    int slot = -1;
+    for (int i = 0; i < MAX_DEVICES && slot < 0; i++)
+        if (atomic_load(&g_dev[i].state) == SESS_FREE) slot = i;
+    if (slot < 0) {
+        notice("[DEV] %s ignored: already %d keyboards.", info->device_name, MAX_DEVICES);
+        return;
+    }
+
+    DeviceSession *s = &g_dev[slot];
+    s->id = info->device_id;
+    s->pid = info->product_id;
+    snprintf(s->name, sizeof(s->name), "%s", info->device_name ? info->device_name : "?");
+    s->hid = NULL;
+    ctx_init(&s->ctx);
+    memset(s->analog, 0, sizeof(s->analog));
+    s->vel_timer = s->ctx.last_write_time;
+    s->time_to_accurate_ms = 0.0f;
+
+    if (g_dev_hid) session_open_hid(s, slot);
+    notice("[DEV] + %s (PID:%04X) slot %d%s%s", s->name, s->pid, slot,
+           s->hid ? " serial " : "", s->hid ? wooting_hid_serial(s->hid) : "");
+
+    atomic_store_explicit(&s->state, SESS_LIVE, memory_order_release);
+}
+
+/* Restore normal AP/RT on a board we are letting go of */
+static bool session_restore(DeviceSession *s) {
+    KeySetting ap[MAX_KEYS], rt[MAX_KEYS];
+    int n = keys_normal(ap, rt);
+    bool ok = wooting_hid_write_actuation(s->hid, PROFILE_IDX, ap, n, false);
+    return wooting_hid_write_rt(s->hid, PROFILE_IDX, rt, n, false) && ok;
+}
+
+/*
+ * Take a session away from the sampler and tear it down. In adaptive mode
+ * normal AP/RT are written first, on shutdown and on unplug alike: a board
+ * the SDK lost but whose vendor interface still answers gets its defaults
+ * back, one that is physically gone just fails the write.
+ */
+static void session_remove(DeviceSession *s, bool unplugged) {
+    int expect = SESS_LIVE;
+    if (!atomic_compare_exchange_strong(&s->state, &expect, SESS_CLOSING)) return;
+
+    /* The sampler answers between frames; once its loop has exited nobody
+     * answers, but nobody uses the session either */
+    uint32_t start = plat_ms();
+    while (atomic_load_explicit(&s->state, memory_order_acquire) != SESS_RETIRED &&
+           atomic_load(&g_sampling) && plat_ms() - start < DEV_RETIRE_WAIT_MS)
+        plat_sleep_ms(1);
+
+    bool restored = false;
+    if (s->hid) {
+        if (!hid_queue_stop(&s->writer)) {
+            notice("[DEV] %s: writer stuck, slot %d abandoned.", s->name, (int)(s - g_dev));
+            atomic_store_explicit(&s->state, SESS_ABANDONED, memory_order_release);
+            return;
+        }
+        if (g_adaptive) restored = session_restore(s);
+        wooting_hid_close(s->hid);
+        s->hid = NULL;
+    }
+    if (unplugged)
+        notice("[DEV] - %s (slot %d)%s", s->name, (int)(s - g_dev),
+               restored ? ", defaults restored" : "");
+    atomic_store_explicit(&s->state, SESS_FREE, memory_order_release);
+}
+
+/* Match sessions to the SDK's device list: add new boards, drop gone ones */
+static void devices_rescan(void) {
+    WootingAnalog_DeviceInfo_FFI *info[MAX_DEVICES];
+    int n = wooting_analog_get_connected_devices_info(info, MAX_DEVICES);
+    if (n < 0) n = 0;
+
+    /* info[] stays valid until the next call, so copy what we keep */
+    WootingAnalog_DeviceInfo_FFI found[MAX_DEVICES];
+    char names[MAX_DEVICES][64];
+    for (int i = 0; i < n; i++) {
+        found[i] = *info[i];
+        snprintf(names[i], sizeof(names[i]), "%s", info[i]->device_name ? info[i]->device_name : "?");
+        found[i].device_name = names[i];
+    }
+
+    for (int d = 0; d < MAX_DEVICES; d++) {
+        if (atomic_load(&g_dev[d].state) != SESS_LIVE) continue;
+        bool present = false;
+        for (int i = 0; i < n; i++) present |= found[i].device_id == g_dev[d].id;
+        if (!present) session_remove(&g_dev[d], true);
+    }
+    for (int i = 0; i < n; i++) {
+        bool known = false;
+        for (int d = 0; d < MAX_DEVICES; d++) {
+            int st = atomic_load(&g_dev[d].state);
+            known |= st != SESS_FREE && st != SESS_ABANDONED && g_dev[d].id == found[i].device_id;
+        }
+        if (!known) session_add(&found[i]);
+    }
+}
+
+/* SDK callback thread: just wake the device thread */
+static void devices_on_event(WootingAnalog_DeviceEventType type,
+                             WootingAnalog_DeviceInfo_FFI *info) {
+    (void)type;
+    (void)info;
+    plat_event_signal(&g_dev_wake);
+}
+
+static void devices_thread(void *param) {
+    (void)param;
+    while (atomic_load(&g_dev_running)) {
+        plat_event_wait(&g_dev_wake, DEV_RESCAN_MS);
+        if (atomic_load(&g_dev_running)) devices_rescan();
+    }
+}
+
+/* First scan inline (the loop starts with every board), then hot-plug */
+static void devices_start(bool hid) {
+    g_dev_hid = hid;
+    devices_rescan();
+
+    if (!plat_event_init(&g_dev_wake)) return;
+    atomic_store(&g_dev_running, true);
+    if (!plat_thread_start(&g_dev_thread, devices_thread, NULL, PLAT_PRIO_BELOW_NORMAL)) {
+        atomic_store(&g_dev_running, false);
+        printf("[DEV] Failed to start device thread, hot-plug disabled.\n");
+        return;
+    }
+    wooting_analog_set_device_event_cb(devices_on_event);
+}
+
+static void devices_shutdown(void) {
+    if (atomic_exchange(&g_dev_running, false)) {
+        wooting_analog_clear_device_event_cb();
+        plat_event_signal(&g_dev_wake);
+        plat_thread_join(&g_dev_thread, 3000);
+    }
+    for (int d = 0; d < MAX_DEVICES; d++) session_remove(&g_dev[d], false);
+}
+
+/* Sampler, between frames: fold a removed session's totals in and let go */
+static void session_retire(DeviceSession *s) {
+    for (int a = 0; a < 2; a++) {
+        hist_merge(&g_gone_hist_axis[a], &s->ctx.hist_axis[a]);
+        for (int d = 0; d < 2; d++)
+            for (int c = 0; c < WCAT_COUNT; c++)
+                hist_merge(&g_gone_hist[a][d][c], &s->ctx.hist[a][d][c]);
+    }
+    g_gone_writes += s->ctx.write_count;
+    atomic_store_explicit(&s->state, SESS_RETIRED, memory_order_release);
+}
+
+/* Sampler only: distributions over every keyboard this run */
+static void hist_collect(Histogram hist[2][2][WCAT_COUNT], Histogram hist_axis[2],
+                         unsigned long long *writes) {
+    memcpy(hist, g_gone_hist, sizeof(g_gone_hist));
+    memcpy(hist_axis, g_gone_hist_axis, sizeof(g_gone_hist_axis));
+    *writes = g_gone_writes;
+    for (int i = 0; i < MAX_DEVICES; i++) {
+        const AimContext *ctx = &g_dev[i].ctx;
+        if (atomic_load_explicit(&g_dev[i].state, memory_order_acquire) != SESS_LIVE) continue;
+        for (int a = 0; a < 2; a++) {
+            hist_merge(&hist_axis[a], &ctx->hist_axis[a]);
+            for (int d = 0; d < 2; d++)
+                for (int c = 0; c < WCAT_COUNT; c++)
+                    hist_merge(&hist[a][d][c], &ctx->hist[a][d][c]);
+        }
+        *writes += ctx->write_count;
+    }
+}
+
+/*
+ * One frame of one keyboard: read, state machines, velocity, targets,
+ * queue a write. Returns true when the session is parked and stayed so.
+ */
+static bool session_frame(DeviceSession *s, uint64_t frame, int64_t loop_start,
+                          bool adaptive, double freq) {
+    AimContext *ctx = &s->ctx;
+    const Config *cfg = g_cfg;     /* one load: a swap lands between frames */
+    ctx->frame = frame;
+    INS_TIME_BEGIN(ins_frame);
+
+    /* Save previous values */
+    ctx->prev_w = ctx->w; ctx->prev_a = ctx->a;
+    ctx->prev_s = ctx->s; ctx->prev_d = ctx->d;
+    float prev_ctrl = ctx->ctrl;
+
+    /* Read analog values: one call for the whole board. The SDK returns
+     * pressed keys, plus each released key once with 0. */
+    INS_TIME_BEGIN(ins_read);
+    unsigned short codes[ANALOG_BUFFER_LEN];
+    float values[ANALOG_BUFFER_LEN];
+    int n = wooting_analog_read_full_buffer_device(codes, values, ANALOG_BUFFER_LEN, s->id);
+    if (n < 0) {
+        memset(s->analog, 0, sizeof(s->analog));
+        n = 0;
+    }
+    for (int i = 0; i < n; i++)
+        if (codes[i] < 256) s->analog[codes[i]] = values[i];
+    ctx->w = s->analog[g_keys[K_W].usage];
+    ctx->a = s->analog[g_keys[K_A].usage];
+    ctx->s = s->analog[g_keys[K_S].usage];
+    ctx->d = s->analog[g_keys[K_D].usage];
+    ctx->ctrl = s->analog[g_key_crouch];
+    INS_TIME_END(IT_READ, ins_read);
+    int64_t read_end = ftrace_on() ? plat_ticks() : 0;
+
+    if (ctx->w < 0) ctx->w = 0;
+    if (ctx->a < 0) ctx->a = 0;
+    if (ctx->s < 0) ctx->s = 0;
+    if (ctx->d < 0) ctx->d = 0;
+    if (ctx->ctrl < 0) ctx->ctrl = 0;
+
+    ctx->crouching = ctx->ctrl > DEAD_ZONE;
+
+    bool novel = ctx->w != ctx->prev_w || ctx->a != ctx->prev_a || ctx->s != ctx->prev_s ||
+                 ctx->d != ctx->prev_d || ctx->ctrl != prev_ctrl;
+    if (novel) {
+        metric_add(&g_metrics.sampler.novel_frames, 1);
+        INS_ADD(IC_NOVEL, 1);
+    }
+
+    /* Frame trace: spans only for frames whose input changed; writes
+     * and acks of a later frame still record under that frame */
+    bool traced = novel && ftrace_on();
+    if (traced) ftrace_span(FT_ACQUIRE, loop_start, read_end, 0);
+
+    bool active = ctx->w > DEAD_ZONE || ctx->a > DEAD_ZONE || ctx->s > DEAD_ZONE ||
+                  ctx->d > DEAD_ZONE || ctx->crouching;
+    for (int i = K_EXTRA; i < g_key_count && !active; i++)
+        active = s->analog[g_keys[i].usage] > DEAD_ZONE;
+    if (active) ctx->last_active = loop_start;
+
+    /* Parked: sample only. A key past the dead zone runs this same
+     * frame through the full pipeline. */
+    if (ctx->idle) {
+        if (!active) {
+            INS_ADD(IC_IDLE, 1);
+            return true;
+        }
+        idle_wake(ctx, loop_start);
+        s->vel_timer = loop_start;
+        s->time_to_accurate_ms = 0.0f;
+    }
+
+    /* Update both axes */
+    axis_update(&ctx->h, cfg, ctx->d, ctx->a, ctx->prev_d, ctx->prev_a, loop_start, freq);
+    axis_update(&ctx->v, cfg, ctx->w, ctx->s, ctx->prev_w, ctx->prev_s, loop_start, freq);
+
+    /* Remember entry velocity of each counter-strafe for the stats store */
+    if (ctx->h.state != ctx->h.prev &&
+        (ctx->h.state == S_COUNTER_POS || ctx->h.state == S_COUNTER_NEG))
+        ctx->h.counter_vel = fabsf(ctx->vel_h.vel);
+    if (ctx->v.state != ctx->v.prev &&
+        (ctx->v.state == S_COUNTER_POS || ctx->v.state == S_COUNTER_NEG))
+        ctx->v.counter_vel = fabsf(ctx->vel_v.vel);
+
+    /* Velocity estimation (~1000 Hz update rate) */
+    if (cfg->vel_enabled) {
+        double vel_elapsed = (double)(loop_start - s->vel_timer) * 1000.0 / freq;
+        if (vel_elapsed >= 1.0) {
+            float max_spd = ctx->weapon_speed > 0 ? ctx->weapon_speed : 225.0f;
+            vel_update(&ctx->vel_h, ctx->d, ctx->a, max_spd, loop_start, freq);
+            vel_update(&ctx->vel_v, ctx->w, ctx->s, max_spd, loop_start, freq);
+            s->vel_timer = loop_start;
+
+            /* Predict time to accuracy threshold (Source 2 discrete model) */
+            float total_v = sqrtf(ctx->vel_h.vel * ctx->vel_h.vel +
+                                  ctx->vel_v.vel * ctx->vel_v.vel);
+            float threshold = max_spd * 0.34f;
+            bool is_counter = (ctx->h.state == S_COUNTER_POS || ctx->h.state == S_COUNTER_NEG ||
+                               ctx->v.state == S_COUNTER_POS || ctx->v.state == S_COUNTER_NEG);
+            if (total_v <= threshold) {
+                s->time_to_accurate_ms = 0.0f;
+            } else {
+                /* Iterate discrete model: k=0.91875, accel=~18.48/tick */
+                float v = total_v;
+                float accel_per_tick = SV_ACCELERATE * (1.0f/64.0f) * max_spd;
+                int ticks = 0;
+                while (v > threshold && ticks < 100) {
+                    if (v >= SV_STOPSPEED) v *= 0.91875f;
+                    else v -= 6.5f;
+                    if (is_counter) v -= accel_per_tick;
+                    if (v < 0) v = 0;
+                    ticks++;
+                }
+                s->time_to_accurate_ms = ticks * 15.625f;
+            }
+        }
+    }
+
+    /* Queue state transitions, rate completed counter-strafes */
+    if (ctx->h.state != ctx->h.prev) {
+        if (ctx->h.prev == S_COUNTER_POS || ctx->h.prev == S_COUNTER_NEG) {
+            hist_log_counter(ctx, &ctx->h, STATS_AXIS_H);
+            if (cfg->stats_enabled)
+                stats_log_counter(ctx, &ctx->h, STATS_AXIS_H, loop_start);
+        }
+        post_transition(&ctx->h, STATS_AXIS_H);
+    }
+    if (ctx->v.state != ctx->v.prev) {
+        if (ctx->v.prev == S_COUNTER_POS || ctx->v.prev == S_COUNTER_NEG) {
+            hist_log_counter(ctx, &ctx->v, STATS_AXIS_V);
+            if (cfg->stats_enabled)
+                stats_log_counter(ctx, &ctx->v, STATS_AXIS_V, loop_start);
+        }
+        post_transition(&ctx->v, STATS_AXIS_V);
+    }
+
+    /* Adaptive tuning: this board's targets go to this board's writer */
+    if (adaptive && s->hid) {
+        gsi_snapshot(ctx);
+        update_targets(ctx, cfg);
+        do_write(ctx, &s->writer);
+    }
+
+    if (traced) ftrace_span(FT_FRAME, loop_start, plat_ticks(), 0);
+    INS_TIME_END(IT_FRAME, ins_frame);
+
+    if (!active && idle_should_park(ctx, loop_start, s->hid != NULL)) {
+        ctx->idle = true;
+        metric_add(&g_metrics.sampler.idle_entries, 1);
+    }
+    return false;
+}
+
+/* ================================================================
+ * DISPLAY (renderer thread; the main loop never touches stdout)
+ * ================================================================ */
+#define RENDER_POLL_MS    20
+#define RENDER_STATUS_MS  500
+
 static void print_bar(const char *label, float val) {
     int bars = (int)(val * 20.0f);
     printf(" %s:", label);
     for (int i = 0; i < 20; i++) putchar(i < bars ? '#' : '.');
 }
 
+static void print_transition(const TelemetryEvent *ev) {
+    static const char *axis_label[2] = { "H", "V" };
+    if (ev->quality != TELEMETRY_NO_QUALITY) {
+        printf("\n[%s] %s->%s (%.1fms %s)", axis_label[ev->axis & 1],
+               axis_names[ev->from], axis_names[ev->to], ev->ms,
+               strafe_quality_names[ev->quality]);
+    } else {
+        printf("\n[%s] %s->%s", axis_label[ev->axis & 1],
+               axis_names[ev->from], axis_names[ev->to]);
+    }
+}
+
+static void print_status(const TelemetryFrame *tf, double hz) {
+    if (tf->idle)
+        printf("\r[idle %.0fHz]", hz);
+    else
+        printf("\r[%.1fM]", hz / 1000000.0);
+    print_bar("A", tf->a);
+    print_bar("D", tf->d);
+    printf(" [H:%s%s%s V:%s%s%s%s]",
+           axis_names[tf->h_state],
+           (tf->flags & TF_H_PREDICTIVE) ? "*" : "",
+           (tf->flags & TF_H_JIGGLE) ? "J" : "",
+           axis_names[tf->v_state],
+           (tf->flags & TF_V_PREDICTIVE) ? "*" : "",
+           (tf->flags & TF_V_JIGGLE) ? "J" : "",
+           (tf->flags & TF_CROUCH) ? " C" : "");
+
+    /* GSI info */
+    if (tf->flags & TF_GSI) {
+        printf(" %s/%s", wcat_names[tf->weapon_cat],
+               tf->round_phase[0] ? tf->round_phase : "?");
+    } else {
+        printf(" noGSI");
+    }
+
+    if (tf->flags & TF_ADAPTIVE) {
+        printf(" A:%.1f/%.1f D:%.1f/%.1f",
+               tf->ap[K_A], tf->rt[K_A], tf->ap[K_D], tf->rt[K_D]);
+    }
+
+    /* Velocity estimation + time-to-accurate */
+    if (tf->flags & TF_VEL) {
+        if (tf->vel < tf->vel_threshold)
+            printf(" v:%.0fOK", tf->vel);
+        else
+            printf(" v:%.0f>%.0fms", tf->vel, tf->time_to_accurate_ms);
+    }
+
+    printf(" #%llu", (unsigned long long)tf->write_count);
+
+    /* Live counter-strafe distribution (H axis) */
+    if (tf->h_count > 0) {
+        printf(" p50:%.0f p90:%.0f PERF:%.0f%%",
+               tf->h_p50, tf->h_p90, 100.0f * tf->h_perf);
+    }
+
+    printf("   ");
+}
+
+static void drain_transitions(void) {
+    static unsigned reported;
+    TelemetryEvent ev;
+    while (spsc_pop(&g_events, &ev)) print_transition(&ev);
+    Notice n;
+    while (spsc_pop(&g_notices, &n)) printf("\n%s", n.text);
+    unsigned dropped = atomic_load_explicit(&g_events_dropped, memory_order_relaxed);
+    if (dropped != reported) {
+        printf("\n[UI] %u transition lines dropped", dropped - reported);
+        reported = dropped;
+    }
+}
+
+/*
+ * Renderer: prints queued transitions as they arrive and the status line
+ * every RENDER_STATUS_MS from the latest published snapshot. Loop rate is
+ * derived from the frame counter and QPC ticks carried in the snapshot.
+ */
+static void render_thread(void *param) {
+    (void)param;
+    while (!atomic_load(&g_render_go)) plat_sleep_ms(1);
+
+    TelemetryFrame tf;
+    uint64_t last_frame = 0;
+    int64_t last_ticks = 0;
+    uint32_t last_status = plat_ms();
+
+    while (atomic_load(&g_render_running)) {
+        drain_transitions();
+
+        uint32_t now = plat_ms();
+        if (now - last_status >= RENDER_STATUS_MS && telemetry_read(&g_telem, &tf)) {
+            double hz = 0;
+            if (last_ticks && tf.ticks > last_ticks)
+                hz = (double)(tf.frame - last_frame) * (double)plat_tick_freq() /
+                     (double)(tf.ticks - last_ticks);
+            last_frame = tf.frame;
+            last_ticks = tf.ticks;
+            last_status = now;
+            print_status(&tf, hz);
+        }
+        fflush(stdout);
+        plat_sleep_ms(RENDER_POLL_MS);
+    }
+
+    drain_transitions();
+    fflush(stdout);
+}
+
+static void format_hist_row(ControlReply *r, const char *label, const Histogram *h) {
+    control_printf(r, "  %-16s %6llu  avg:%6.1f  p50:%6.1f  p90:%6.1f  p99:%6.1f ms ",
+                   label, (unsigned long long)h->total, hist_mean(h),
+                   hist_percentile(h, 50), hist_percentile(h, 90), hist_percentile(h, 99));
+    for (int q = 0; q < CSQ_COUNT; q++)
+        control_printf(r, " %s:%3.0f%%", strafe_quality_names[q],
+                       100.0 * h->quality[q] / (double)h->total);
+    control_printf(r, "\n");
+}
+
+/* Counter-strafe distributions: per axis, then per counter key + weapon */
+static void format_hist_summary(ControlReply *r, const Histogram hist[2][2][WCAT_COUNT],
+                                const Histogram hist_axis[2]) {
+    static const char *axis_label[2] = { "H", "V" };
+    static const char dir_key[2][2] = { { 'A', 'D' }, { 'S', 'W' } };
+
+    for (int a = 0; a < 2; a++) {
+        if (hist_axis[a].total == 0) continue;
+        char label[32];
+        snprintf(label, sizeof(label), "%s counter-strafes", axis_label[a]);
+        format_hist_row(r, label, &hist_axis[a]);
+        for (int d = 0; d < 2; d++) {
+            for (int c = 0; c < WCAT_COUNT; c++) {
+                const Histogram *h = &hist[a][d][c];
+                if (h->total == 0) continue;
+                snprintf(label, sizeof(label), "  %c %s", dir_key[a][d], wcat_names[c]);
+                format_hist_row(r, label, h);
+            }
+        }
+    }
+}
+
+/* Sampler (or after it stopped): every keyboard's counter-strafes + writes */
+static void print_hist_summary(void) {
+    static char buf[CONTROL_REPLY_MAX];
+    static Histogram hist[2][2][WCAT_COUNT], hist_axis[2];
+    unsigned long long writes;
+    ControlReply r = { buf, sizeof(buf), 0, false };
+    buf[0] = '\0';
+    hist_collect(hist, hist_axis, &writes);
+    format_hist_summary(&r, hist, hist_axis);
+    fputs(buf, stdout);
+    printf("HID writes: %llu\n", writes);
+}
+
+/* ================================================================
+ * CONTROL CHANNEL (transport in control.c)
+ * ================================================================ */
+/*
+ * "hist" needs the sampler's histograms. The control thread raises a
+ * request; the sampler copies them between frames (one relaxed load per
+ * frame otherwise) and flags the copy done. No lock on either side.
+ */
+#define HIST_IDLE       0
+#define HIST_REQUESTED  1
+#define HIST_COPIED     2
+#define HIST_WAIT_MS    500
+
+static atomic_int g_hist_req;
+static Histogram g_hist_snap[2][2][WCAT_COUNT];
+static Histogram g_hist_snap_axis[2];
+
+/* Sampler side */
+static void hist_snapshot(void) {
+    unsigned long long writes;
+    hist_collect(g_hist_snap, g_hist_snap_axis, &writes);
+    atomic_store_explicit(&g_hist_req, HIST_COPIED, memory_order_release);
+}
+
+static void ctl_hist(ControlReply *r) {
+    atomic_store(&g_hist_req, HIST_REQUESTED);
+    uint32_t start = plat_ms();
+    while (atomic_load_explicit(&g_hist_req, memory_order_acquire) != HIST_COPIED) {
+        if (plat_ms() - start > HIST_WAIT_MS) {
+            atomic_store(&g_hist_req, HIST_IDLE);
+            control_printf(r, "ERR sampler not running\n");
+            return;
+        }
+        plat_sleep_ms(1);
+    }
+    format_hist_summary(r, g_hist_snap, g_hist_snap_axis);
+    atomic_store(&g_hist_req, HIST_IDLE);
+    control_printf(r, "OK\n");
+}
+
+static void ctl_set(ControlReply *r, const char *key, const char *value) {
+    const CfgField *f = config_find(key);
+    if (!f) {
+        control_printf(r, "ERR unknown key '%s'\n", key);
+        return;
+    }
+    if (f->flags & CFG_RESTART) {
+        control_printf(r, "ERR %s is bound at startup; edit the config file and restart\n", key);
+        return;
+    }
+    if (f->type == CFG_NAME) {
+        control_printf(r, "ERR use: profile NAME\n");
+        return;
+    }
+
+    Config *c = config_alloc();
+    if (!c) {
+        control_printf(r, "ERR out of memory\n");
+        return;
+    }
+    char err[160], val[64];
+    plat_mutex_lock(&g_cfg_publish_lock);
+    *c = *config_latest();
+    if (!config_set(c, key, value, err, sizeof(err))) {
+        plat_mutex_unlock(&g_cfg_publish_lock);
+        config_free(c);
+        control_printf(r, "ERR %s\n", err);
+        return;
+    }
+    config_compile(c, (double)plat_tick_freq());
+    config_format(c, f, val, sizeof(val));
+    config_publish(c);
+    plat_mutex_unlock(&g_cfg_publish_lock);
+
+    notice("[CTL] %s=%s", key, val);
+    control_printf(r, "%s=%s\nOK\n", key, val);
+}
+
+static void ctl_profile(ControlReply *r, const char *name) {
+    plat_mutex_lock(&g_cfg_publish_lock);
+    if (!name) {
+        control_printf(r, "profile=%s\nOK\n", config_latest()->profile);
+        plat_mutex_unlock(&g_cfg_publish_lock);
+        return;
+    }
+    char old[CFG_NAME_LEN];
+    memcpy(old, g_cfg_profile, sizeof(old));
+    /* "-" goes back to whatever profile= the file selects */
+    snprintf(g_cfg_profile, sizeof(g_cfg_profile), "%s", strcmp(name, "-") == 0 ? "" : name);
+    plat_mutex_unlock(&g_cfg_publish_lock);
+
+    if (config_reload(g_cfg_path)) {
+        control_printf(r, "OK\n");
+    } else {
+        plat_mutex_lock(&g_cfg_publish_lock);
+        memcpy(g_cfg_profile, old, sizeof(old));
+        plat_mutex_unlock(&g_cfg_publish_lock);
+        control_printf(r, "ERR profile rejected, see the console\n");
+    }
+}
+
+static void ctl_record(ControlReply *r, const char *what, const char *path) {
+    if (!what) {
+        if (g_trace_thread.started) control_printf(r, "recording %s\n", g_trace_path);
+        control_printf(r, "OK\n");
+    } else if (strcmp(what, "start") == 0) {
+        char name[PLAT_PATH_MAX];
+        if (!path) {
+            time_t now = time(NULL);
+            strftime(name, sizeof(name), "wooting-aim-%Y%m%d-%H%M%S.watrace", localtime(&now));
+            path = name;
+        }
+        if (!g_shm.hdr)
+            control_printf(r, "ERR recording needs telemetry_shm=1\n");
+        else if (g_trace_thread.started)
+            control_printf(r, "ERR already recording %s\n", g_trace_path);
+        else if (!trace_record_start(path))
+            control_printf(r, "ERR cannot create %s\n", path);
+        else {
+            notice("[CTL] Recording to %s", path);
+            control_printf(r, "recording %s\nOK\n", path);
+        }
+    } else if (strcmp(what, "stop") == 0) {
+        if (!trace_record_stop()) {
+            control_printf(r, "ERR not recording\n");
+            return;
+        }
+        notice("[CTL] Recorded %llu frames to %s",
+               (unsigned long long)g_trace.hdr.frames, g_trace_path);
+        control_printf(r, "%s frames=%llu lost=%u\nOK\n", g_trace_path,
+                       (unsigned long long)g_trace.hdr.frames, g_trace.hdr.lost);
+    } else {
+        control_printf(r, "ERR use: record start [PATH] | record stop\n");
+    }
+}
+
+/* Runs on the control thread, one line at a time */
+static void control_command(char *line, ControlReply *r) {
+    char *argv[4] = {0};
+    int argc = 0;
+    for (char *p = line; *p && argc < 4; ) {
+        while (*p == ' ' || *p == '\t') *p++ = '\0';
+        if (!*p) break;
+        argv[argc++] = p;
+        while (*p && *p != ' ' && *p != '\t') p++;
+    }
+    if (argc == 0) return;
+    const char *cmd = argv[0];
+
+    if (strcmp(cmd, "get") == 0 && argc == 2) {
+        const CfgField *f = config_find(argv[1]);
+        if (!f) {
+            control_printf(r, "ERR unknown key '%s'\n", argv[1]);
+            return;
+        }
+        char val[CFG_VALUE_MAX];
+        plat_mutex_lock(&g_cfg_publish_lock);
+        config_format(config_latest(), f, val, sizeof(val));
+        plat_mutex_unlock(&g_cfg_publish_lock);
+        control_printf(r, "%s=%s\nOK\n", f->key, val);
+    } else if (strcmp(cmd, "set") == 0 && argc == 3) {
+        ctl_set(r, argv[1], argv[2]);
+    } else if (strcmp(cmd, "list") == 0 && argc == 1) {
+        char val[CFG_VALUE_MAX];
+        plat_mutex_lock(&g_cfg_publish_lock);
+        const Config *c = config_latest();
+        for (int i = 0; i < config_schema_count; i++) {
+            config_format(c, &config_schema[i], val, sizeof(val));
+            control_printf(r, "%s=%s\n", config_schema[i].key, val);
+        }
+        plat_mutex_unlock(&g_cfg_publish_lock);
+        control_printf(r, "OK\n");
+    } else if (strcmp(cmd, "profile") == 0 && argc <= 2) {
+        ctl_profile(r, argv[1]);
+    } else if (strcmp(cmd, "reload") == 0 && argc == 1) {
+        control_printf(r, config_reload(g_cfg_path) ? "OK\n" : "ERR reload rejected, see the console\n");
+    } else if (strcmp(cmd, "hist") == 0 && argc == 1) {
+        ctl_hist(r);
+    } else if (strcmp(cmd, "record") == 0 && argc <= 3) {
+        ctl_record(r, argv[1], argv[2]);
+    } else if (strcmp(cmd, "help") == 0) {
+        control_printf(r, "get KEY | set KEY VALUE | list | profile [NAME|-] | reload\n"
+                          "hist | record start [PATH] | record stop | record\n"
+                          "(set lasts until the config file is next saved or reloaded)\nOK\n");
+    } else {
+        control_printf(r, "ERR unknown command, try help\n");
+    }
+}
+
+/* ================================================================
+ * STARTUP (independent bring-up steps, run concurrently)
+ * ================================================================ */
+/*
+ * GSI setup probes the registry and the file system, SDK init enumerates
+ * analog devices and the HID phase opens the vendor interface and waits on
+ * the firmware. None needs another, so each gets a thread and the loop
+ * starts once all have joined: bring-up costs the slowest step, not the sum.
+ */
+typedef struct {
+    const char *name;
+    bool (*run)(void);
+    PlatThread thread;
+    int64_t start, end;
+    bool ok;
+} StartupPhase;
+
+static int g_sdk_devices;      /* wooting_analog_initialise() result */
+
+static bool startup_gsi(void) {
+    create_gsi_config();
+    if (!plat_thread_start(&g_gsi_thread, gsi_thread, NULL, PLAT_PRIO_NORMAL)) {
+        printf("[GSI] Failed to start server thread.\n");
+        return false;
+    }
+    return true;
+}
+
+static bool startup_sdk(void) {
+    printf("Initializing Wooting Analog SDK...\n");
+    g_sdk_devices = wooting_analog_initialise();
+    if (g_sdk_devices < 0) return false;
+
+    WootingAnalog_DeviceInfo_FFI *devices[4];
+    int dev_count = wooting_analog_get_connected_devices_info(devices, 4);
+    printf("SDK initialized. Devices found: %d\n", g_sdk_devices);
+    for (int i = 0; i < dev_count; i++) {
+        printf("  Device %d: %s (%s) VID:%04X PID:%04X\n",
+               i, devices[i]->device_name, devices[i]->manufacturer_name,
+               devices[i]->vendor_id, devices[i]->product_id);
+    }
+    wooting_analog_set_keycode_mode(WootingAnalog_KeycodeType_HID);
+    return true;
+}
+
+static bool startup_hid(void) {
+    printf("Initializing HID writer...\n");
+    WootingHID *hid = wooting_hid_open(HID_CACHE_PATH);
+    if (!hid) {
+        printf("WARNING: HID writer failed to open.\n");
+        return false;
+    }
+    bool ok = true;
+    if (!wooting_hid_handshake(hid)) {
+        printf("WARNING: Handshake failed.\n");
+        ok = false;
+    }
+    if (!wooting_hid_activate_profile(hid, PROFILE_IDX)) {
+        printf("WARNING: Profile activation failed.\n");
+        ok = false;
+    }
+    g_hid = hid;
+    return ok;
+}
+
+static void startup_phase_thread(void *param) {
+    StartupPhase *p = param;
+    p->start = plat_ticks();
+    p->ok = p->run();
+    p->end = plat_ticks();
+}
+
+/* Run every phase on its own thread (inline if one can't start), join all */
+static void startup_run(StartupPhase *ph, int n) {
+    int64_t t0 = plat_ticks();
+    for (int i = 0; i < n; i++)
+        if (!plat_thread_start(&ph[i].thread, startup_phase_thread, &ph[i], PLAT_PRIO_NORMAL))
+            startup_phase_thread(&ph[i]);
+    for (int i = 0; i < n; i++) plat_thread_join(&ph[i].thread, -1);
+    int64_t t1 = plat_ticks();
+
+    double freq = (double)plat_tick_freq();
+    double sum = 0.0;
+    for (int i = 0; i < n; i++) {
+        double ms = (double)(ph[i].end - ph[i].start) * 1000.0 / freq;
+        sum += ms;
+        printf("[START] %-4s %7.1f ms  %s\n", ph[i].name, ms, ph[i].ok ? "ok" : "FAILED");
+    }
+    if (n > 1)
+        printf("[START] all  %7.1f ms  (%.1f ms sequential)\n", (double)(t1 - t0) * 1000.0 / freq, sum);
+}
+
 /* ================================================================
  * MAIN
  * ================================================================ */
@@ -1179,102 +2270,99 @@ int main(int argc, char *argv[]) {
     bool adaptive_mode = false;
     bool watch_mode    = false;
     bool demo_mode     = false;
+    const char *frame_trace_path = NULL;
 
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "--adaptive") == 0) adaptive_mode = true;
         else if (strcmp(argv[i], "--watch") == 0) watch_mode = true;
         else if (strcmp(argv[i], "--demo") == 0) demo_mode = true;
+        else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc)
+            snprintf(g_cfg_profile, sizeof(g_cfg_profile), "%s", argv[++i]);
+        else if (strcmp(argv[i], "--frame-trace") == 0 && i + 1 < argc)
+            frame_trace_path = argv[++i];
     }
 
-    SetConsoleCtrlHandler(console_handler, TRUE);
+    plat_event_init(&g_cleanup_done);
+    plat_on_terminate(on_terminate);
+    INS_THREAD("sampler");
 
     printf("=== wooting-aim v0.7 ===\n\n");
 
+    /* Before any thread starts, so every track gets its name */
+    if (frame_trace_path && ftrace_start(frame_trace_path)) {
+        ftrace_thread("sampler");
+        printf("[TRACE] Frame trace on, written to %s at exit\n", frame_trace_path);
+    }
+
     /* Launch options reminder */
     printf("[TIP] CS2 launch options recomandate: -noreflex -high\n");
     printf("[TIP] NVIDIA Control Panel: Low Latency Mode = Ultra, V-Sync = On\n\n");
 
     /* Timer resolution */
-    set_timer_resolution();
+    double prev_res = plat_timer_resolution_begin();
+    if (prev_res > 0) printf("[SYS] Timer resolution: 0.5ms (was %.1fms)\n", prev_res);
 
-    /* Init winsock */
-    WSADATA wsa;
-    WSAStartup(MAKEWORD(2, 2), &wsa);
+    plat_net_init();
 
     /* Load config */
-    config_load("wooting-aim.cfg");
+    plat_mutex_init(&g_cfg_publish_lock);
+    notices_init();
+    config_set_output(notice_line);
+    config_load(g_cfg_path);
+    config_watch_start();
+    keys_init();
     printf("[CFG] AP:%.1f->%.1f  RT:%.1f->%.1f  Predict:%.0f%%  Crouch:x%.1f\n",
-           g_cfg.ap_normal, g_cfg.ap_aggro,
-           g_cfg.rt_normal, g_cfg.rt_aggro,
-           (1.0f - g_cfg.predict_threshold) * 100.0f,
-           g_cfg.crouch_rt_factor);
+           g_cfg->ap_normal, g_cfg->ap_aggro,
+           g_cfg->rt_normal, g_cfg->rt_aggro,
+           (1.0f - g_cfg->predict_threshold) * 100.0f,
+           g_cfg->crouch_rt_factor);
     printf("[CFG] Weapon profiles: RIFLE(%.1f/%.1f) AWP(%.1f/%.1f) PISTOL(%.1f/%.1f) SMG(%.1f/%.1f) KNIFE(%.1f/%.1f)\n",
-           g_cfg.weapon[WCAT_RIFLE].ap, g_cfg.weapon[WCAT_RIFLE].rt,
-           g_cfg.weapon[WCAT_AWP].ap, g_cfg.weapon[WCAT_AWP].rt,
-           g_cfg.weapon[WCAT_PISTOL].ap, g_cfg.weapon[WCAT_PISTOL].rt,
-           g_cfg.weapon[WCAT_SMG].ap, g_cfg.weapon[WCAT_SMG].rt,
-           g_cfg.weapon[WCAT_KNIFE].ap, g_cfg.weapon[WCAT_KNIFE].rt);
-
-    /* GSI setup */
-    InitializeCriticalSection(&g_gsi.lock);
-    if (g_cfg.gsi_enabled) {
-        create_gsi_config();
-        g_gsi_thread = CreateThread(NULL, 0, gsi_thread, NULL, 0, NULL);
-        if (!g_gsi_thread)
-            printf("[GSI] Failed to start server thread.\n");
-    }
+           g_cfg->weapon[WCAT_RIFLE].ap, g_cfg->weapon[WCAT_RIFLE].rt,
+           g_cfg->weapon[WCAT_AWP].ap, g_cfg->weapon[WCAT_AWP].rt,
+           g_cfg->weapon[WCAT_PISTOL].ap, g_cfg->weapon[WCAT_PISTOL].rt,
+           g_cfg->weapon[WCAT_SMG].ap, g_cfg->weapon[WCAT_SMG].rt,
+           g_cfg->weapon[WCAT_KNIFE].ap, g_cfg->weapon[WCAT_KNIFE].rt);
+
+    /* GSI comes up before --watch waits, so CS2's first POST finds it */
+    plat_mutex_init(&g_gsi.lock);
+    StartupPhase phases[3];
+    int n_phases = 0;
+    if (g_cfg->gsi_enabled)
+        phases[n_phases++] = (StartupPhase){ .name = "gsi", .run = startup_gsi };
 
     /* --- Watch mode: wait for CS2 --- */
     if (watch_mode) {
+        startup_run(phases, n_phases);
+        n_phases = 0;
         printf("\nWaiting for CS2 to start...\n");
-        while (g_running && !is_process_running("cs2.exe")) {
-            Sleep(2000);
-        }
-        if (!g_running) { restore_and_cleanup(); return 0; }
-        printf("CS2 detected! Starting adaptive mode.\n");
-        Sleep(3000);
-        adaptive_mode = true;
-    }
-
-    /* --- SDK init --- */
-    if (!demo_mode) {
-        printf("\nInitializing Wooting Analog SDK...\n");
-        int ret = wooting_analog_initialise();
-        if (ret < 0) {
-            printf("ERROR: SDK init failed (code %d)\n", ret);
-            printf("Press Enter to exit...\n");
-            getchar();
+        if (!proc_watch_init(&g_proc, "cs2.exe")) {
+            printf("ERROR: Cannot start process watcher.\n");
             restore_and_cleanup();
             return 1;
         }
-        printf("SDK initialized. Devices found: %d\n", ret);
-
-        WootingAnalog_DeviceInfo_FFI *devices[4];
-        int dev_count = wooting_analog_get_connected_devices_info(devices, 4);
-        for (int i = 0; i < dev_count; i++) {
-            printf("  Device %d: %s (%s) VID:%04X PID:%04X\n",
-                   i, devices[i]->device_name, devices[i]->manufacturer_name,
-                   devices[i]->vendor_id, devices[i]->product_id);
-        }
-        wooting_analog_set_keycode_mode(WootingAnalog_KeycodeType_HID);
+        if (!proc_wait_start(&g_proc)) { restore_and_cleanup(); return 0; }
+        printf("CS2 detected (pid %u)! Starting adaptive mode.\n", g_proc.pid);
+        plat_sleep_ms(3000);
+        adaptive_mode = true;
     }
 
-    /* --- HID writer init --- */
-    WootingHID *hid = NULL;
+    /* --- SDK init + HID writer init, concurrently (and GSI, unless --watch) --- */
     g_adaptive = adaptive_mode;
-    if (adaptive_mode || demo_mode) {
-        printf("\nInitializing HID writer...\n");
-        hid = wooting_hid_open();
-        g_hid = hid;
-        if (!hid) {
-            printf("WARNING: HID writer failed to open.\n");
-        } else {
-            if (!wooting_hid_handshake(hid))
-                printf("WARNING: Handshake failed.\n");
-            if (!wooting_hid_activate_profile(hid, PROFILE_IDX))
-                printf("WARNING: Profile activation failed.\n");
-        }
+    if (!demo_mode)
+        phases[n_phases++] = (StartupPhase){ .name = "sdk", .run = startup_sdk };
+    if (adaptive_mode || demo_mode)
+        phases[n_phases++] = (StartupPhase){ .name = "hid", .run = startup_hid };
+    printf("\n");
+    startup_run(phases, n_phases);
+
+    if (!demo_mode && g_sdk_devices < 0) {
+        printf("ERROR: SDK init failed (code %d)\n", g_sdk_devices);
+        printf("Press Enter to exit...\n");
+        getchar();
+        restore_and_cleanup();
+        return 1;
     }
+    WootingHID *hid = g_hid;
 
     /* --- Demo mode --- */
     if (demo_mode && hid) {
@@ -1294,34 +2382,20 @@ int main(int argc, char *argv[]) {
             printf("\r  D -> AP:%.1fmm RT:%.1fmm [%s]   ",
                    ap_val, rt_val, aggro ? "AGGRO" : "NORMAL");
             fflush(stdout);
-            Sleep(3000);
+            plat_sleep_ms(3000);
         }
         restore_and_cleanup();
         return 0;
     }
 
     /* --- Main loop setup --- */
-    LARGE_INTEGER perf_freq;
-    QueryPerformanceFrequency(&perf_freq);
-    double freq = (double)perf_freq.QuadPart;
-
-    AimContext ctx = {0};
-    for (int i = 0; i < 4; i++) {
-        ctx.current_ap[i] = g_cfg.ap_normal;
-        ctx.current_rt[i] = g_cfg.rt_normal;
-        ctx.target_ap[i]  = g_cfg.ap_normal;
-        ctx.target_rt[i]  = g_cfg.rt_normal;
-    }
-    QueryPerformanceCounter(&ctx.last_write_time);
-    ctx.vel_h.max_speed = 225.0f;
-    ctx.vel_v.max_speed = 225.0f;
-    QueryPerformanceCounter(&ctx.vel_h.last_update);
-    ctx.vel_v.last_update = ctx.vel_h.last_update;
+    double freq = (double)plat_tick_freq();
 
     /* Stats */
-    if (g_cfg.stats_enabled && adaptive_mode) {
-        stats_init(&ctx.stats, "wooting-aim-stats.csv");
-        g_stats = &ctx.stats;
+    if (g_cfg->stats_enabled && adaptive_mode) {
+        stats_init(&g_stats_log, "wooting-aim-stats.bin", "wooting-aim-stats.idx");
+        g_stats = &g_stats_log;
+        g_metrics.stats_dropped = &g_stats_log.dropped;
     }
 
     if (adaptive_mode && hid) {
@@ -1333,212 +2407,126 @@ int main(int argc, char *argv[]) {
         printf("Close this window to stop.\n\n");
     }
 
-    LARGE_INTEGER fps_timer, loop_start, loop_end;
-    QueryPerformanceCounter(&fps_timer);
-    unsigned long long fps_reads = 0;
-    double actual_hz = 0;
-
-    /* Velocity update rate limiter (~1000 Hz) */
-    LARGE_INTEGER vel_timer;
-    QueryPerformanceCounter(&vel_timer);
-    float time_to_accurate_ms = 0.0f;  /* predicted ms until shootable */
+    /* Shared-memory telemetry for overlays */
+    if (g_cfg->telemetry_shm) {
+        if (telemetry_shm_create(&g_shm, (uint64_t)plat_tick_freq()))
+            printf("[SHM] Telemetry ring: %s (%d frames)\n", TELEMETRY_SHM_NAME, TELEMETRY_SHM_SLOTS);
+        else
+            printf("[SHM] Failed to create telemetry ring.\n");
+    }
 
-    while (g_running) {
-        QueryPerformanceCounter(&loop_start);
-
-        /* Save previous values */
-        ctx.prev_w = ctx.w; ctx.prev_a = ctx.a;
-        ctx.prev_s = ctx.s; ctx.prev_d = ctx.d;
-
-        /* Read analog values */
-        ctx.w = wooting_analog_read_analog(HID_W);
-        ctx.a = wooting_analog_read_analog(HID_A);
-        ctx.s = wooting_analog_read_analog(HID_S);
-        ctx.d = wooting_analog_read_analog(HID_D);
-        ctx.ctrl = wooting_analog_read_analog(HID_LCTRL);
-
-        if (ctx.w < 0) ctx.w = 0;
-        if (ctx.a < 0) ctx.a = 0;
-        if (ctx.s < 0) ctx.s = 0;
-        if (ctx.d < 0) ctx.d = 0;
-        if (ctx.ctrl < 0) ctx.ctrl = 0;
-
-        ctx.crouching = ctx.ctrl > DEAD_ZONE;
-
-        /* Update both axes */
-        axis_update(&ctx.h, ctx.d, ctx.a, ctx.prev_d, ctx.prev_a, freq);
-        axis_update(&ctx.v, ctx.w, ctx.s, ctx.prev_w, ctx.prev_s, freq);
-
-        /* Velocity estimation (~1000 Hz update rate) */
-        if (g_cfg.vel_enabled) {
-            double vel_elapsed = (double)(loop_start.QuadPart - vel_timer.QuadPart) * 1000.0 / freq;
-            if (vel_elapsed >= 1.0) {
-                float max_spd = ctx.weapon_speed > 0 ? ctx.weapon_speed : 225.0f;
-                vel_update(&ctx.vel_h, ctx.d, ctx.a, max_spd, loop_start, freq);
-                vel_update(&ctx.vel_v, ctx.w, ctx.s, max_spd, loop_start, freq);
-                vel_timer = loop_start;
-
-                /* Predict time to accuracy threshold (Source 2 discrete model) */
-                float total_v = sqrtf(ctx.vel_h.vel * ctx.vel_h.vel +
-                                      ctx.vel_v.vel * ctx.vel_v.vel);
-                float threshold = max_spd * 0.34f;
-                bool is_counter = (ctx.h.state == S_COUNTER_POS || ctx.h.state == S_COUNTER_NEG ||
-                                   ctx.v.state == S_COUNTER_POS || ctx.v.state == S_COUNTER_NEG);
-                if (total_v <= threshold) {
-                    time_to_accurate_ms = 0.0f;
-                } else {
-                    /* Iterate discrete model: k=0.91875, accel=~18.48/tick */
-                    float v = total_v;
-                    float accel_per_tick = SV_ACCELERATE * (1.0f/64.0f) * max_spd;
-                    int ticks = 0;
-                    while (v > threshold && ticks < 100) {
-                        if (v >= SV_STOPSPEED) v *= 0.91875f;
-                        else v -= 6.5f;
-                        if (is_counter) v -= accel_per_tick;
-                        if (v < 0) v = 0;
-                        ticks++;
-                    }
-                    time_to_accurate_ms = ticks * 15.625f;
-                }
-            }
-        }
+    /* Metrics endpoint (started once all counter owners exist) */
+    g_metrics.ui_dropped = &g_events_dropped;
+    if (g_cfg->metrics_enabled && !metrics_start(&g_metrics, g_cfg->metrics_port))
+        printf("[MET] Failed to start metrics thread.\n");
+
+    /* Control channel (get/set/profile/hist/record from scripts) */
+    if (g_cfg->control_enabled && !control_start(&g_control, control_command))
+        printf("[CTL] Failed to start control thread.\n");
+
+    /* Watch mode: the watcher thread stops the loop when CS2 exits */
+    if (watch_mode && !proc_watch_exit(&g_proc, on_cs2_exit, NULL))
+        printf("[WATCH] Failed to start exit watcher, stop with Ctrl+C.\n");
+
+    /* One session per keyboard (the HID phase's board is taken over), then
+     * hot-plug on the device thread. From here a removal waits for the
+     * sampler to let go of the session. */
+    atomic_store(&g_sampling, true);
+    devices_start(adaptive_mode);
+
+    /* Renderer thread (starts printing once placed, below) */
+    spsc_init(&g_events, g_event_slots, EVENT_RING_SIZE, sizeof(TelemetryEvent));
+    atomic_store(&g_render_running, true);
+    if (!plat_thread_start(&g_render_thread, render_thread, NULL, PLAT_PRIO_BELOW_NORMAL))
+        printf("[UI] Failed to start renderer thread, running without display.\n");
+
+    /* Thread placement, then the report of what the OS actually granted */
+    ThreadPlacement sampler = { g_cfg->sampler_cpus, (ThreadPrio)g_cfg->sampler_priority,
+                                g_cfg->isolate_sampler && aux_cpu_mask(),
+                                g_cfg->sampler_mmcss };
+    thread_place(NULL, &sampler);
+    if (g_cfg->isolate_sampler && g_cfg->sampler_cpus && !aux_cpu_mask())
+        printf("[CPU] sampler_cpus covers every CPU, isolate_sampler ignored.\n");
+    struct { const char *role; const PlatThread *t; } aux[] = {
+        { "gsi",     &g_gsi_thread },
+        { "stats",   g_stats ? &g_stats->thread : NULL },
+        { "metrics", &g_metrics.thread },
+        { "control", &g_control.thread },
+        { "config",  &g_cfg_watch_thread },
+        { "watch",   &g_proc.thread },
+        { "render",  &g_render_thread },
+        { "devices", &g_dev_thread },
+    };
+    for (size_t i = 0; i < sizeof(aux) / sizeof(aux[0]); i++) place_aux(aux[i].t);
 
-        /* Print state transitions */
-        /* Counter-strafe quality classification (CS2ST research):
-         * Perfect: 65-95ms (80ms +/-15ms)
-         * Good: 60-120ms
-         * Late: >120ms, Early: <60ms */
-        if (ctx.h.state != ctx.h.prev) {
-            const char *wname = ctx.gsi_active ? ctx.weapon_name : "";
-            if (ctx.h.prev == S_COUNTER_POS || ctx.h.prev == S_COUNTER_NEG) {
-                const char *q = (ctx.h.counter_ms >= 65 && ctx.h.counter_ms <= 95) ? "PERF" :
-                                (ctx.h.counter_ms >= 60 && ctx.h.counter_ms <= 120) ? "GOOD" :
-                                (ctx.h.counter_ms < 60) ? "FAST" : "LATE";
-                printf("\n[H] %s->%s (%.1fms %s)", axis_names[ctx.h.prev],
-                       axis_names[ctx.h.state], ctx.h.counter_ms, q);
-                if (g_cfg.stats_enabled)
-                    stats_log(&ctx.stats, "H",
-                              ctx.h.prev == S_COUNTER_POS ? "D" : "A",
-                              ctx.h.counter_ms, wname);
-            } else {
-                printf("\n[H] %s->%s", axis_names[ctx.h.prev], axis_names[ctx.h.state]);
-            }
-        }
-        if (ctx.v.state != ctx.v.prev) {
-            const char *wname = ctx.gsi_active ? ctx.weapon_name : "";
-            if (ctx.v.prev == S_COUNTER_POS || ctx.v.prev == S_COUNTER_NEG) {
-                const char *q = (ctx.v.counter_ms >= 65 && ctx.v.counter_ms <= 95) ? "PERF" :
-                                (ctx.v.counter_ms >= 60 && ctx.v.counter_ms <= 120) ? "GOOD" :
-                                (ctx.v.counter_ms < 60) ? "FAST" : "LATE";
-                printf("\n[V] %s->%s (%.1fms %s)", axis_names[ctx.v.prev],
-                       axis_names[ctx.v.state], ctx.v.counter_ms, q);
-                if (g_cfg.stats_enabled)
-                    stats_log(&ctx.stats, "V",
-                              ctx.v.prev == S_COUNTER_POS ? "W" : "S",
-                              ctx.v.counter_ms, wname);
-            } else {
-                printf("\n[V] %s->%s", axis_names[ctx.v.prev], axis_names[ctx.v.state]);
-            }
-        }
+    report_placement("sampler", NULL);
+    for (size_t i = 0; i < sizeof(aux) / sizeof(aux[0]); i++)
+        if (aux[i].t && aux[i].t->started) report_placement(aux[i].role, aux[i].t);
+    for (int i = 0; i < MAX_DEVICES; i++)
+        if (g_dev[i].hid && g_dev[i].writer.thread.started)
+            report_placement(g_dev[i].writer.name, &g_dev[i].writer.thread);
 
-        /* Adaptive tuning */
-        if (adaptive_mode && hid) {
-            update_targets(&ctx);
-            do_write(&ctx, hid, freq);
-        }
+    /* All console output from here on comes from the renderer */
+    if (g_render_thread.started) notices_route(true);
+    atomic_store(&g_render_go, true);
 
-        QueryPerformanceCounter(&loop_end);
-        fps_reads++;
-        ctx.frame++;
+    int64_t loop_start, loop_end;
+    uint64_t frame = 0;
 
-        /* Watch mode: check if CS2 is still running every ~5s */
-        if (watch_mode && (ctx.frame % 25000000) == 0) {
-            if (!is_process_running("cs2.exe")) {
-                printf("\nCS2 closed. Shutting down.\n");
-                g_running = false;
-            }
+    while (g_running) {
+        /* Hot reload: adopt a new config between frames, never mid-frame */
+        config_apply_pending();
+        if (atomic_load_explicit(&g_hist_req, memory_order_relaxed) == HIST_REQUESTED)
+            hist_snapshot();
+
+        loop_start = plat_ticks();
+        INS_ADD(IC_LOOP, 1);
+        metric_add(&g_metrics.sampler.frames, 1);
+        if (ftrace_on()) ftrace_frame(frame);
+
+        /* Every keyboard in turn; the display follows the last one pressed */
+        bool parked = true;
+        DeviceSession *shown = NULL;
+        for (int i = 0; i < MAX_DEVICES; i++) {
+            DeviceSession *s = &g_dev[i];
+            int st = atomic_load_explicit(&s->state, memory_order_acquire);
+            if (st == SESS_CLOSING) session_retire(s);
+            if (st != SESS_LIVE) continue;
+            parked &= session_frame(s, frame, loop_start, adaptive_mode, freq);
+            if (!shown || s->ctx.last_active > shown->ctx.last_active) shown = s;
         }
-
-        /* Display update every 500ms */
-        double fps_elapsed = (double)(loop_end.QuadPart - fps_timer.QuadPart) * 1000.0 / freq;
-        if (fps_elapsed >= 500.0) {
-            actual_hz = (double)fps_reads / (fps_elapsed / 1000.0);
-            fps_reads = 0;
-            fps_timer = loop_end;
-
-            printf("\r[%.1fM]", actual_hz / 1000000.0);
-            print_bar("A", ctx.a);
-            print_bar("D", ctx.d);
-            printf(" [H:%s%s%s V:%s%s%s%s]",
-                   axis_names[ctx.h.state],
-                   ctx.h.predictive ? "*" : "",
-                   ctx.h.is_jiggle ? "J" : "",
-                   axis_names[ctx.v.state],
-                   ctx.v.predictive ? "*" : "",
-                   ctx.v.is_jiggle ? "J" : "",
-                   ctx.crouching ? " C" : "");
-
-            /* GSI info */
-            if (ctx.gsi_active) {
-                printf(" %s/%s", wcat_names[ctx.weapon_cat],
-                       ctx.round_phase[0] ? ctx.round_phase : "?");
-            } else {
-                printf(" noGSI");
-            }
-
-            if (adaptive_mode) {
-                printf(" A:%.1f/%.1f D:%.1f/%.1f",
-                       ctx.current_ap[K_A], ctx.current_rt[K_A],
-                       ctx.current_ap[K_D], ctx.current_rt[K_D]);
-            }
-
-            /* Velocity estimation + time-to-accurate */
-            if (g_cfg.vel_enabled) {
-                float total_vel = sqrtf(ctx.vel_h.vel * ctx.vel_h.vel +
-                                        ctx.vel_v.vel * ctx.vel_v.vel);
-                float max_spd = ctx.weapon_speed > 0 ? ctx.weapon_speed : 225.0f;
-                float threshold = max_spd * 0.34f;
-                if (total_vel < threshold)
-                    printf(" v:%.0fOK", total_vel);
-                else
-                    printf(" v:%.0f>%.0fms", total_vel, time_to_accurate_ms);
-            }
-
-            printf(" #%llu", ctx.write_count);
-
-            /* Stats summary */
-            if (ctx.h.counter_count > 0) {
-                printf(" avg:%.0fms", ctx.h.counter_total_ms / ctx.h.counter_count);
-            }
-
-            printf("   ");
-            fflush(stdout);
+        if (shown)
+            publish_telemetry(&shown->ctx, loop_start, adaptive_mode,
+                              shown->ctx.idle ? 0.0f : shown->time_to_accurate_ms);
+        frame++;
+
+        /* Every board parked, or none connected: sample at idle_poll_hz */
+        if (parked) {
+            plat_sleep_ms(g_cfg->idle_sleep_ms);
+            continue;
         }
 
         /* Poll rate limiter: yield CPU when running faster than target */
-        if (g_cfg.poll_rate_hz > 0) {
-            double target_us = 1000000.0 / g_cfg.poll_rate_hz;
-            QueryPerformanceCounter(&loop_end);
-            double loop_us = (double)(loop_end.QuadPart - loop_start.QuadPart) * 1000000.0 / freq;
-            if (loop_us < target_us) {
+        if (g_cfg->poll_period_ticks > 0) {
+            loop_end = plat_ticks();
+            if (loop_end - loop_start < g_cfg->poll_period_ticks) {
                 /* Yield to reduce CPU from 100% to ~5-15% */
-                SwitchToThread();
+                plat_yield();
             }
         }
     }
+    atomic_store(&g_sampling, false);
+
+    stop_renderer();
+    if (g_cs2_closed) printf("\nCS2 closed. Shutting down.\n");
 
     /* Print session summary */
     printf("\n\n=== SESSION SUMMARY ===\n");
-    if (ctx.h.counter_count > 0)
-        printf("H counter-strafes: %llu  avg: %.1f ms\n",
-               ctx.h.counter_count, ctx.h.counter_total_ms / ctx.h.counter_count);
-    if (ctx.v.counter_count > 0)
-        printf("V counter-strafes: %llu  avg: %.1f ms\n",
-               ctx.v.counter_count, ctx.v.counter_total_ms / ctx.v.counter_count);
-    printf("HID writes: %llu\n", ctx.write_count);
-
-    stats_close(&ctx.stats);
+    print_hist_summary();
+    INS_REPORT();
+
+    stats_close(&g_stats_log);
     restore_and_cleanup();
-    DeleteCriticalSection(&g_gsi.lock);
+    plat_mutex_destroy(&g_gsi.lock);
     return 0;
 }
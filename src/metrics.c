@@ -0,0 +1,236 @@
+/*
+ * metrics.c - Prometheus text rendering and the loopback metrics server
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "metrics.h"
+#include "platform.h"
+
+#define METRICS_BUF_SIZE  32768
+#define METRICS_REQ_SIZE  1024
+
+static const uint32_t strafe_le[] = { 40000, 60000, 65000, 80000, 95000, 120000,
+                                      160000, 250000, 500000, 1000000 };
+static const uint32_t hid_le[]    = { 250, 500, 1000, 2000, 5000, 7500, 10000,
+                                      15000, 25000, 50000, 100000 };
+static const uint32_t gsi_le[]    = { 50, 100, 250, 500, 1000, 2500, 5000,
+                                      10000, 50000, 250000, 1000000 };
+
+#define BOUNDS(a) { a, (int)(sizeof(a) / sizeof(a[0])) }
+const MetricBounds metric_bounds_strafe = BOUNDS(strafe_le);
+const MetricBounds metric_bounds_hid    = BOUNDS(hid_le);
+const MetricBounds metric_bounds_gsi    = BOUNDS(gsi_le);
+
+/* Same order as AxisState in main.c */
+static const char *state_labels[METRIC_STATES] = { "I", "S+", "S-", "C+", "C-" };
+static const char *axis_labels[2] = { "H", "V" };
+
+/* ---------- rendering ---------- */
+
+typedef struct {
+    char *buf;
+    int size;
+    int len;
+} Out;
+
+static void out(Out *o, const char *fmt, ...) {
+    if (o->len >= o->size) return;
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(o->buf + o->len, (size_t)(o->size - o->len), fmt, ap);
+    va_end(ap);
+    if (n > 0) o->len += n;
+    if (o->len > o->size) o->len = o->size;
+}
+
+static uint64_t rd(MetricCounter *c) {
+    return atomic_load_explicit(c, memory_order_relaxed);
+}
+
+static void out_header(Out *o, const char *name, const char *type, const char *help) {
+    out(o, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+/* One histogram series; `labels` is either "" or `key="value",` */
+static void out_hist(Out *o, const char *name, const char *labels,
+                     MetricHist *h, const MetricBounds *b) {
+    uint64_t cum = 0;
+    for (int i = 0; i < b->n; i++) {
+        cum += rd(&h->bucket[i]);
+        out(o, "%s_bucket{%sle=\"%g\"} %llu\n", name, labels,
+            b->le_us[i] / 1e6, (unsigned long long)cum);
+    }
+    cum += rd(&h->bucket[b->n]);
+    out(o, "%s_bucket{%sle=\"+Inf\"} %llu\n", name, labels, (unsigned long long)cum);
+
+    /* Unlabelled series drop the braces entirely */
+    char lab[64] = "";
+    size_t ll = strlen(labels);
+    if (ll) snprintf(lab, sizeof(lab), "{%.*s}", (int)(ll - 1), labels);
+    out(o, "%s_sum%s %.6f\n", name, lab, rd(&h->sum_us) / 1e6);
+    out(o, "%s_count%s %llu\n", name, lab, (unsigned long long)rd(&h->count));
+}
+
+int metrics_render(Metrics *m, char *buf, int size) {
+    Out o = { buf, size, 0 };
+    SamplerMetrics *s = &m->sampler;
+    GsiMetrics *g = &m->gsi;
+
+    uint64_t frames = rd(&s->frames);
+    uint64_t novel = rd(&s->novel_frames);
+
+    out_header(&o, "wooting_aim_frames_total", "counter",
+               "Analog sampling loop iterations, by whether any input changed");
+    out(&o, "wooting_aim_frames_total{kind=\"novel\"} %llu\n", (unsigned long long)novel);
+    out(&o, "wooting_aim_frames_total{kind=\"duplicate\"} %llu\n",
+        (unsigned long long)(frames - novel));
+
+    /* Loop rate since the previous scrape */
+    int64_t now = plat_ticks();
+    double hz = 0;
+    if (m->scrape_ticks && now > m->scrape_ticks)
+        hz = (double)(frames - m->scrape_frames) * (double)plat_tick_freq() /
+             (double)(now - m->scrape_ticks);
+    m->scrape_frames = frames;
+    m->scrape_ticks = now;
+    out_header(&o, "wooting_aim_loop_hz", "gauge",
+               "Sampling loop rate since the previous scrape (0 on the first scrape)");
+    out(&o, "wooting_aim_loop_hz %.0f\n", hz);
+
+    out_header(&o, "wooting_aim_idle_entries_total", "counter",
+               "Times the idle governor parked the sampling loop");
+    out(&o, "wooting_aim_idle_entries_total %llu\n", (unsigned long long)rd(&s->idle_entries));
+
+    out_header(&o, "wooting_aim_hid_writes_total", "counter", "AP/RT HID write batches sent");
+    for (int d = 0; d < METRIC_DEVICES; d++)
+        if (d == 0 || rd(&m->hid[d].latency.count))
+            out(&o, "wooting_aim_hid_writes_total{device=\"%d\"} %llu\n", d,
+                (unsigned long long)rd(&m->hid[d].writes));
+    out_header(&o, "wooting_aim_hid_write_failures_total", "counter",
+               "HID write batches with at least one failed report");
+    for (int d = 0; d < METRIC_DEVICES; d++)
+        if (d == 0 || rd(&m->hid[d].latency.count))
+            out(&o, "wooting_aim_hid_write_failures_total{device=\"%d\"} %llu\n", d,
+                (unsigned long long)rd(&m->hid[d].failures));
+    out_header(&o, "wooting_aim_hid_write_seconds", "histogram",
+               "Duration of one AP+RT HID write batch");
+    for (int d = 0; d < METRIC_DEVICES; d++) {
+        if (d > 0 && !rd(&m->hid[d].latency.count)) continue;
+        char labels[16];
+        snprintf(labels, sizeof(labels), "device=\"%d\",", d);
+        out_hist(&o, "wooting_aim_hid_write_seconds", labels, &m->hid[d].latency, &metric_bounds_hid);
+    }
+
+    out_header(&o, "wooting_aim_axis_transitions_total", "counter", "Axis state machine transitions");
+    for (int a = 0; a < 2; a++)
+        for (int f = 0; f < METRIC_STATES; f++)
+            for (int t = 0; t < METRIC_STATES; t++) {
+                uint64_t v = rd(&s->transitions[a][f][t]);
+                if (v == 0) continue;
+                out(&o, "wooting_aim_axis_transitions_total{axis=\"%s\",from=\"%s\",to=\"%s\"} %llu\n",
+                    axis_labels[a], state_labels[f], state_labels[t], (unsigned long long)v);
+            }
+
+    out_header(&o, "wooting_aim_counter_strafe_seconds", "histogram", "Counter-strafe durations");
+    for (int a = 0; a < 2; a++) {
+        char labels[16];
+        snprintf(labels, sizeof(labels), "axis=\"%s\",", axis_labels[a]);
+        out_hist(&o, "wooting_aim_counter_strafe_seconds", labels,
+                 &s->counter_strafe[a], &metric_bounds_strafe);
+    }
+
+    out_header(&o, "wooting_aim_gsi_updates_total", "counter", "CS2 GSI updates received");
+    out(&o, "wooting_aim_gsi_updates_total %llu\n", (unsigned long long)rd(&g->updates));
+    out_header(&o, "wooting_aim_gsi_empty_requests_total", "counter",
+               "GSI connections without a usable body");
+    out(&o, "wooting_aim_gsi_empty_requests_total %llu\n", (unsigned long long)rd(&g->empty_requests));
+    out_header(&o, "wooting_aim_gsi_request_seconds", "histogram",
+               "GSI request handling time, accept to parsed state");
+    out_hist(&o, "wooting_aim_gsi_request_seconds", "", &g->request_latency, &metric_bounds_gsi);
+
+    if (m->stats_dropped) {
+        out_header(&o, "wooting_aim_stats_dropped_total", "counter",
+                   "Counter-strafe records lost to a full stats queue");
+        out(&o, "wooting_aim_stats_dropped_total %u\n", atomic_load(m->stats_dropped));
+    }
+    if (m->ui_dropped) {
+        out_header(&o, "wooting_aim_ui_dropped_total", "counter",
+                   "Console transition lines lost to a full event queue");
+        out(&o, "wooting_aim_ui_dropped_total %u\n", atomic_load(m->ui_dropped));
+    }
+    return o.len;
+}
+
+/* ---------- server ---------- */
+
+static void handle_client(Metrics *m, PlatSocket client, char *body) {
+    char req[METRICS_REQ_SIZE];
+    int total = 0;
+
+    plat_socket_recv_timeout(client, 1000);
+    while (total < METRICS_REQ_SIZE - 1) {
+        int n = recv(client, req + total, METRICS_REQ_SIZE - 1 - total, 0);
+        if (n <= 0) break;
+        total += n;
+        req[total] = '\0';
+        if (strstr(req, "\r\n\r\n")) break;
+    }
+    req[total] = '\0';
+
+    char head[160];
+    int body_len = 0;
+    if (strncmp(req, "GET /metrics ", 13) == 0 || strncmp(req, "GET /metrics?", 13) == 0) {
+        body_len = metrics_render(m, body, METRICS_BUF_SIZE);
+        snprintf(head, sizeof(head),
+                 "HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                 "Content-Length: %d\r\nConnection: close\r\n\r\n", body_len);
+    } else {
+        snprintf(head, sizeof(head),
+                 "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+    }
+
+    send(client, head, (int)strlen(head), 0);
+    int sent = 0;
+    while (sent < body_len) {
+        int n = send(client, body + sent, body_len - sent, 0);
+        if (n <= 0) break;
+        sent += n;
+    }
+}
+
+static void metrics_thread(void *param) {
+    Metrics *m = (Metrics *)param;
+
+    PlatSocket server_sock = plat_listen_loopback(m->port, 4, "[MET]");
+    if (server_sock == PLAT_INVALID_SOCKET) return;
+    printf("[MET] Metrics at http://127.0.0.1:%d/metrics\n", m->port);
+
+    static char body[METRICS_BUF_SIZE];
+    while (atomic_load(&m->running)) {
+        if (plat_socket_wait(server_sock, 500) <= 0) continue;
+
+        PlatSocket client = accept(server_sock, NULL, NULL);
+        if (client == PLAT_INVALID_SOCKET) continue;
+        handle_client(m, client, body);
+        plat_socket_close(client);
+    }
+
+    plat_socket_close(server_sock);
+}
+
+bool metrics_start(Metrics *m, int port) {
+    m->port = port;
+    atomic_store(&m->running, true);
+    if (!plat_thread_start(&m->thread, metrics_thread, m, PLAT_PRIO_BELOW_NORMAL)) {
+        atomic_store(&m->running, false);
+        return false;
+    }
+    return true;
+}
+
+void metrics_stop(Metrics *m) {
+    atomic_store(&m->running, false);
+    plat_thread_join(&m->thread, 2000);
+}
@@ -0,0 +1,112 @@
+/*
+ * metrics.h - Lock-free runtime counters and a loopback /metrics endpoint
+ *
+ * Every counter block has exactly one writing thread (sampler, GSI, one
+ * HID writer per keyboard), which
+ * bumps it with a relaxed load + store: no lock, no locked RMW, just an
+ * add to a cache line that thread already owns. The metrics server thread
+ * reads them relaxed and renders Prometheus text format on request, so a
+ * scrape never stalls or contends with the hot path.
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "platform.h"
+
+#define METRICS_PORT     58733
+#define METRIC_STATES    5     /* AxisState values */
+#define METRIC_DEVICES   4     /* keyboards with their own HID writer */
+#define METRIC_HIST_MAX  12    /* finite buckets per histogram */
+
+typedef _Atomic uint64_t MetricCounter;
+
+/* Non-cumulative bucket counts; the renderer accumulates them. */
+typedef struct {
+    MetricCounter bucket[METRIC_HIST_MAX + 1];   /* last = +Inf */
+    MetricCounter count;
+    MetricCounter sum_us;
+} MetricHist;
+
+/* Bucket upper bounds in microseconds, ascending */
+typedef struct {
+    const uint32_t *le_us;
+    int n;
+} MetricBounds;
+
+extern const MetricBounds metric_bounds_strafe;     /* counter-strafe durations */
+extern const MetricBounds metric_bounds_hid;        /* HID write round trips */
+extern const MetricBounds metric_bounds_gsi;        /* GSI request handling */
+
+/* Owned by the sampling thread */
+typedef struct {
+    _Alignas(64) MetricCounter frames;
+    MetricCounter novel_frames;            /* analog input changed since last read */
+    MetricCounter idle_entries;            /* idle governor parks */
+    MetricCounter transitions[2][METRIC_STATES][METRIC_STATES];   /* [axis][from][to] */
+    MetricHist    counter_strafe[2];       /* [axis] */
+} SamplerMetrics;
+
+/* Owned by one keyboard's HID writer thread (hid_queue.h) */
+typedef struct {
+    _Alignas(64) MetricCounter writes;
+    MetricCounter failures;
+    MetricHist    latency;
+} HidMetrics;
+
+/* Owned by the GSI server thread */
+typedef struct {
+    _Alignas(64) MetricCounter updates;
+    MetricCounter empty_requests;          /* no body / timed out */
+    MetricHist    request_latency;         /* accept -> parsed */
+} GsiMetrics;
+
+typedef struct {
+    SamplerMetrics sampler;
+    GsiMetrics gsi;
+    HidMetrics hid[METRIC_DEVICES];        /* by device slot */
+
+    /* Drop counters owned by other modules (optional) */
+    atomic_uint *stats_dropped;
+    atomic_uint *ui_dropped;
+
+    int port;
+    PlatThread thread;
+    atomic_bool running;
+
+    /* Server thread only: previous scrape, for the loop rate gauge */
+    uint64_t scrape_frames;
+    int64_t  scrape_ticks;
+} Metrics;
+
+/* Single-writer increment: only the owning thread may call these. */
+static inline void metric_add(MetricCounter *c, uint64_t n) {
+    atomic_store_explicit(c, atomic_load_explicit(c, memory_order_relaxed) + n,
+                          memory_order_relaxed);
+}
+
+static inline void metric_observe(MetricHist *h, const MetricBounds *b, uint64_t us) {
+    int i = 0;
+    while (i < b->n && us > b->le_us[i]) i++;
+    metric_add(&h->bucket[i], 1);
+    metric_add(&h->sum_us, us);
+    metric_add(&h->count, 1);
+}
+
+/*
+ * Start the HTTP server thread on 127.0.0.1:port. Serves GET /metrics,
+ * 404 for anything else. Returns false if the thread could not start
+ * (bind errors are reported from the thread, like the GSI server).
+ */
+bool metrics_start(Metrics *m, int port);
+
+/* Stop the server thread. Safe to call when it never started. */
+void metrics_stop(Metrics *m);
+
+/* Render all metrics in Prometheus text format. Returns bytes written. */
+int metrics_render(Metrics *m, char *buf, int size);
+
+#endif /* METRICS_H */
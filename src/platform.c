@@ -0,0 +1,582 @@
+/*
+ * platform.c - Win32 and POSIX implementations of platform.h
+ */
+
+#ifndef _WIN32
+#define _GNU_SOURCE
+#endif
+
+#include "platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <time.h>
+#endif
+
+/* Split "dir/name" (either separator on Windows) */
+static void split_path(const char *path, char *dir, size_t dir_size, const char **name) {
+    const char *slash = strrchr(path, '/');
+#ifdef _WIN32
+    const char *bslash = strrchr(path, '\\');
+    if (bslash && (!slash || bslash > slash)) slash = bslash;
+#endif
+    if (slash) {
+        snprintf(dir, dir_size, "%.*s", slash == path ? 1 : (int)(slash - path), path);
+        *name = slash + 1;
+    } else {
+        snprintf(dir, dir_size, ".");
+        *name = path;
+    }
+}
+
+/* Threads start here so both platforms take a plain void fn(void *) */
+typedef struct {
+    PlatThreadFn fn;
+    void *arg;
+} ThreadStart;
+
+#ifdef _WIN32
+
+/* ---------- clock ---------- */
+
+static int64_t g_qpc_freq;
+
+int64_t plat_ticks(void) {
+    LARGE_INTEGER t;
+    QueryPerformanceCounter(&t);
+    return t.QuadPart;
+}
+
+int64_t plat_tick_freq(void) {
+    if (!g_qpc_freq) {
+        LARGE_INTEGER f;
+        QueryPerformanceFrequency(&f);
+        g_qpc_freq = f.QuadPart;
+    }
+    return g_qpc_freq;
+}
+
+uint32_t plat_ms(void) {
+    return GetTickCount();
+}
+
+void plat_sleep_ms(int ms) {
+    Sleep((DWORD)ms);
+}
+
+void plat_yield(void) {
+    SwitchToThread();
+}
+
+typedef LONG (NTAPI *NtSetTimerResolution_t)(ULONG, BOOLEAN, PULONG);
+static NtSetTimerResolution_t g_NtSetTimerResolution = NULL;
+
+double plat_timer_resolution_begin(void) {
+    HMODULE ntdll = GetModuleHandleA("ntdll.dll");
+    if (!ntdll) return 0;
+    g_NtSetTimerResolution = (NtSetTimerResolution_t)
+        GetProcAddress(ntdll, "NtSetTimerResolution");
+    if (!g_NtSetTimerResolution) return 0;
+
+    ULONG current = 0;
+    g_NtSetTimerResolution(5000, TRUE, &current); /* 5000 * 100ns = 0.5ms */
+    return current / 10000.0;
+}
+
+void plat_timer_resolution_end(void) {
+    if (g_NtSetTimerResolution) {
+        ULONG current;
+        g_NtSetTimerResolution(5000, FALSE, &current);
+    }
+}
+
+/* ---------- memory ---------- */
+
+void *plat_aligned_alloc(size_t align, size_t size) {
+    return _aligned_malloc(size, align);
+}
+
+void plat_aligned_free(void *p) {
+    _aligned_free(p);
+}
+
+/* ---------- threads ---------- */
+
+static DWORD WINAPI thread_entry(LPVOID param) {
+    ThreadStart s = *(ThreadStart *)param;
+    free(param);
+    s.fn(s.arg);
+    return 0;
+}
+
+bool plat_thread_start(PlatThread *t, PlatThreadFn fn, void *arg, PlatPrio prio) {
+    t->started = false;
+    ThreadStart *s = malloc(sizeof(*s));
+    if (!s) return false;
+    s->fn = fn;
+    s->arg = arg;
+    t->handle = CreateThread(NULL, 0, thread_entry, s, 0, NULL);
+    if (!t->handle) {
+        free(s);
+        return false;
+    }
+    if (prio == PLAT_PRIO_BELOW_NORMAL) SetThreadPriority(t->handle, THREAD_PRIORITY_BELOW_NORMAL);
+    else if (prio == PLAT_PRIO_LOWEST)  SetThreadPriority(t->handle, THREAD_PRIORITY_LOWEST);
+    t->started = true;
+    return true;
+}
+
+bool plat_thread_join(PlatThread *t, int timeout_ms) {
+    if (!t->started) return true;
+    bool done = WaitForSingleObject(t->handle, timeout_ms < 0 ? INFINITE : (DWORD)timeout_ms)
+                == WAIT_OBJECT_0;
+    CloseHandle(t->handle);
+    t->handle = NULL;
+    t->started = false;
+    return done;
+}
+
+/* ---------- locks ---------- */
+
+void plat_mutex_init(PlatMutex *m)    { InitializeCriticalSection(m); }
+void plat_mutex_lock(PlatMutex *m)    { EnterCriticalSection(m); }
+void plat_mutex_unlock(PlatMutex *m)  { LeaveCriticalSection(m); }
+void plat_mutex_destroy(PlatMutex *m) { DeleteCriticalSection(m); }
+
+bool plat_event_init(PlatEvent *e) {
+    e->handle = CreateEventA(NULL, FALSE, FALSE, NULL);
+    return e->handle != NULL;
+}
+
+void plat_event_signal(PlatEvent *e) { SetEvent(e->handle); }
+
+bool plat_event_wait(PlatEvent *e, int timeout_ms) {
+    return WaitForSingleObject(e->handle, timeout_ms < 0 ? INFINITE : (DWORD)timeout_ms)
+           == WAIT_OBJECT_0;
+}
+
+void plat_event_destroy(PlatEvent *e) {
+    if (e->handle) CloseHandle(e->handle);
+    e->handle = NULL;
+}
+
+/* ---------- sockets ---------- */
+
+void plat_net_init(void) {
+    WSADATA wsa;
+    WSAStartup(MAKEWORD(2, 2), &wsa);
+}
+
+void plat_net_cleanup(void) {
+    WSACleanup();
+}
+
+int plat_socket_error(void) {
+    return WSAGetLastError();
+}
+
+int plat_socket_wait(PlatSocket s, int timeout_ms) {
+    fd_set readfds;
+    FD_ZERO(&readfds);
+    FD_SET(s, &readfds);
+    struct timeval tv = { timeout_ms / 1000, (timeout_ms % 1000) * 1000 };
+    int r = select(0, &readfds, NULL, NULL, &tv);
+    return r < 0 ? -1 : r > 0;
+}
+
+void plat_socket_recv_timeout(PlatSocket s, int timeout_ms) {
+    DWORD ms = (DWORD)timeout_ms;
+    setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, (const char *)&ms, sizeof(ms));
+}
+
+void plat_socket_close(PlatSocket s) {
+    closesocket(s);
+}
+
+/* ---------- termination ---------- */
+
+static void (*g_terminate_fn)(void);
+
+static BOOL WINAPI console_handler(DWORD event) {
+    if (event == CTRL_CLOSE_EVENT || event == CTRL_C_EVENT ||
+        event == CTRL_BREAK_EVENT || event == CTRL_LOGOFF_EVENT ||
+        event == CTRL_SHUTDOWN_EVENT) {
+        g_terminate_fn();
+        return TRUE;
+    }
+    return FALSE;
+}
+
+void plat_on_terminate(void (*fn)(void)) {
+    g_terminate_fn = fn;
+    SetConsoleCtrlHandler(console_handler, TRUE);
+}
+
+/* ---------- files ---------- */
+
+bool plat_path_exists(const char *path) {
+    return GetFileAttributesA(path) != INVALID_FILE_ATTRIBUTES;
+}
+
+bool plat_file_watch_open(PlatFileWatch *w, const char *path) {
+    char dir[PLAT_PATH_MAX];
+    const char *name;
+    memset(w, 0, sizeof(*w));
+    split_path(path, dir, sizeof(dir), &name);
+    snprintf(w->name, sizeof(w->name), "%s", name);
+
+    w->dir = CreateFileA(dir, FILE_LIST_DIRECTORY,
+                         FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                         NULL, OPEN_EXISTING,
+                         FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+    if (w->dir == INVALID_HANDLE_VALUE) {
+        w->dir = NULL;
+        return false;
+    }
+    w->ov.hEvent = CreateEventA(NULL, TRUE, FALSE, NULL);
+    return true;
+}
+
+int plat_file_watch_wait(PlatFileWatch *w, int timeout_ms) {
+    if (!w->armed) {
+        ResetEvent(w->ov.hEvent);
+        if (!ReadDirectoryChangesW(w->dir, w->buf, sizeof(w->buf), FALSE,
+                                   FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME |
+                                   FILE_NOTIFY_CHANGE_SIZE, NULL, &w->ov, NULL))
+            return -1;
+        w->armed = true;
+    }
+    if (WaitForSingleObject(w->ov.hEvent, (DWORD)timeout_ms) != WAIT_OBJECT_0) return 0;
+
+    DWORD bytes = 0;
+    w->armed = false;
+    /* Overflowed notification buffer: report a change to be safe */
+    if (!GetOverlappedResult(w->dir, &w->ov, &bytes, FALSE) || !bytes) return 1;
+
+    FILE_NOTIFY_INFORMATION *fn = (FILE_NOTIFY_INFORMATION *)w->buf;
+    for (;;) {
+        char fname[PLAT_PATH_MAX];
+        int n = WideCharToMultiByte(CP_UTF8, 0, fn->FileName,
+                                    (int)(fn->FileNameLength / sizeof(WCHAR)),
+                                    fname, sizeof(fname) - 1, NULL, NULL);
+        fname[n > 0 ? n : 0] = '\0';
+        if (_stricmp(fname, w->name) == 0) return 1;
+        if (!fn->NextEntryOffset) break;
+        fn = (FILE_NOTIFY_INFORMATION *)((char *)fn + fn->NextEntryOffset);
+    }
+    return 0;
+}
+
+void plat_file_watch_close(PlatFileWatch *w) {
+    if (!w->dir) return;
+    if (w->armed) {
+        DWORD bytes;
+        CancelIoEx(w->dir, &w->ov);
+        GetOverlappedResult(w->dir, &w->ov, &bytes, TRUE);
+    }
+    CloseHandle(w->ov.hEvent);
+    CloseHandle(w->dir);
+    w->dir = NULL;
+}
+
+bool plat_steam_dir(char *buf, size_t size) {
+    HKEY key;
+    bool found = false;
+    if (RegOpenKeyExA(HKEY_CURRENT_USER, "Software\\Valve\\Steam", 0,
+                      KEY_READ, &key) == ERROR_SUCCESS) {
+        DWORD len = (DWORD)size - 1, type;
+        memset(buf, 0, size);
+        if (RegQueryValueExA(key, "SteamPath", NULL, &type,
+                             (LPBYTE)buf, &len) == ERROR_SUCCESS) {
+            found = true;
+            for (size_t i = 0; buf[i]; i++)
+                if (buf[i] == '/') buf[i] = '\\';
+        }
+        RegCloseKey(key);
+    }
+    return found;
+}
+
+#else /* POSIX */
+
+/* ---------- clock ---------- */
+
+int64_t plat_ticks(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+int64_t plat_tick_freq(void) {
+    return 1000000000;
+}
+
+uint32_t plat_ms(void) {
+    return (uint32_t)(plat_ticks() / 1000000);
+}
+
+void plat_sleep_ms(int ms) {
+    struct timespec ts = { ms / 1000, (long)(ms % 1000) * 1000000 };
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {}
+}
+
+void plat_yield(void) {
+    sched_yield();
+}
+
+double plat_timer_resolution_begin(void) {
+    return 0;
+}
+
+void plat_timer_resolution_end(void) {
+}
+
+/* ---------- memory ---------- */
+
+void *plat_aligned_alloc(size_t align, size_t size) {
+    /* C11 wants the size to be a multiple of the alignment */
+    return aligned_alloc(align, (size + align - 1) & ~(align - 1));
+}
+
+void plat_aligned_free(void *p) {
+    free(p);
+}
+
+/* ---------- threads ---------- */
+
+static void *thread_entry(void *param) {
+    ThreadStart s = *(ThreadStart *)param;
+    free(param);
+    s.fn(s.arg);
+    return NULL;
+}
+
+bool plat_thread_start(PlatThread *t, PlatThreadFn fn, void *arg, PlatPrio prio) {
+    t->started = false;
+    ThreadStart *s = malloc(sizeof(*s));
+    if (!s) return false;
+    s->fn = fn;
+    s->arg = arg;
+    if (pthread_create(&t->id, NULL, thread_entry, s) != 0) {
+        free(s);
+        return false;
+    }
+    /* Background policies need no privileges, unlike a lower nice per thread */
+    struct sched_param sp = { .sched_priority = 0 };
+    if (prio == PLAT_PRIO_BELOW_NORMAL) pthread_setschedparam(t->id, SCHED_BATCH, &sp);
+    else if (prio == PLAT_PRIO_LOWEST)  pthread_setschedparam(t->id, SCHED_IDLE, &sp);
+    t->started = true;
+    return true;
+}
+
+bool plat_thread_join(PlatThread *t, int timeout_ms) {
+    if (!t->started) return true;
+    t->started = false;
+    if (timeout_ms < 0) return pthread_join(t->id, NULL) == 0;
+    struct timespec until;
+    clock_gettime(CLOCK_REALTIME, &until);
+    until.tv_sec += timeout_ms / 1000;
+    until.tv_nsec += (long)(timeout_ms % 1000) * 1000000;
+    if (until.tv_nsec >= 1000000000) { until.tv_sec++; until.tv_nsec -= 1000000000; }
+    if (pthread_timedjoin_np(t->id, NULL, &until) == 0) return true;
+    pthread_detach(t->id);
+    return false;
+}
+
+/* ---------- locks ---------- */
+
+void plat_mutex_init(PlatMutex *m)    { pthread_mutex_init(m, NULL); }
+void plat_mutex_lock(PlatMutex *m)    { pthread_mutex_lock(m); }
+void plat_mutex_unlock(PlatMutex *m)  { pthread_mutex_unlock(m); }
+void plat_mutex_destroy(PlatMutex *m) { pthread_mutex_destroy(m); }
+
+bool plat_event_init(PlatEvent *e) {
+    pthread_condattr_t a;
+    pthread_condattr_init(&a);
+    pthread_condattr_setclock(&a, CLOCK_MONOTONIC);
+    bool ok = pthread_mutex_init(&e->m, NULL) == 0 && pthread_cond_init(&e->c, &a) == 0;
+    pthread_condattr_destroy(&a);
+    e->set = false;
+    return ok;
+}
+
+void plat_event_signal(PlatEvent *e) {
+    pthread_mutex_lock(&e->m);
+    e->set = true;
+    pthread_cond_signal(&e->c);
+    pthread_mutex_unlock(&e->m);
+}
+
+bool plat_event_wait(PlatEvent *e, int timeout_ms) {
+    struct timespec until;
+    clock_gettime(CLOCK_MONOTONIC, &until);
+    until.tv_sec += timeout_ms / 1000;
+    until.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (until.tv_nsec >= 1000000000L) { until.tv_sec++; until.tv_nsec -= 1000000000L; }
+
+    pthread_mutex_lock(&e->m);
+    int r = 0;
+    while (!e->set && r == 0)
+        r = timeout_ms < 0 ? pthread_cond_wait(&e->c, &e->m)
+                           : pthread_cond_timedwait(&e->c, &e->m, &until);
+    bool got = e->set;
+    e->set = false;
+    pthread_mutex_unlock(&e->m);
+    return got;
+}
+
+void plat_event_destroy(PlatEvent *e) {
+    pthread_cond_destroy(&e->c);
+    pthread_mutex_destroy(&e->m);
+}
+
+/* ---------- sockets ---------- */
+
+void plat_net_init(void) {
+    /* A client hanging up mid-reply must not kill the tuner */
+    signal(SIGPIPE, SIG_IGN);
+}
+
+void plat_net_cleanup(void) {
+}
+
+int plat_socket_error(void) {
+    return errno;
+}
+
+int plat_socket_wait(PlatSocket s, int timeout_ms) {
+    struct pollfd p = { s, POLLIN, 0 };
+    int r = poll(&p, 1, timeout_ms);
+    return r < 0 ? (errno == EINTR ? 0 : -1) : r > 0;
+}
+
+void plat_socket_recv_timeout(PlatSocket s, int timeout_ms) {
+    struct timeval tv = { timeout_ms / 1000, (timeout_ms % 1000) * 1000 };
+    setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+}
+
+void plat_socket_close(PlatSocket s) {
+    close(s);
+}
+
+/* ---------- termination ---------- */
+
+static void (*g_terminate_fn)(void);
+
+static void signal_handler(int sig) {
+    (void)sig;
+    g_terminate_fn();
+}
+
+void plat_on_terminate(void (*fn)(void)) {
+    g_terminate_fn = fn;
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = signal_handler;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    sigaction(SIGHUP, &sa, NULL);
+}
+
+/* ---------- files ---------- */
+
+bool plat_path_exists(const char *path) {
+    return access(path, F_OK) == 0;
+}
+
+bool plat_file_watch_open(PlatFileWatch *w, const char *path) {
+    char dir[PLAT_PATH_MAX];
+    const char *name;
+    memset(w, 0, sizeof(*w));
+    split_path(path, dir, sizeof(dir), &name);
+    snprintf(w->name, sizeof(w->name), "%s", name);
+
+    w->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (w->fd < 0) return false;
+    if (inotify_add_watch(w->fd, dir, IN_CLOSE_WRITE | IN_MODIFY | IN_MOVED_TO | IN_CREATE) < 0) {
+        close(w->fd);
+        w->fd = -1;
+        return false;
+    }
+    return true;
+}
+
+int plat_file_watch_wait(PlatFileWatch *w, int timeout_ms) {
+    struct pollfd p = { w->fd, POLLIN, 0 };
+    int r = poll(&p, 1, timeout_ms);
+    if (r < 0) return errno == EINTR ? 0 : -1;
+    if (r == 0) return 0;
+
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    int changed = 0;
+    ssize_t len;
+    while ((len = read(w->fd, buf, sizeof(buf))) > 0) {
+        for (char *p = buf; p < buf + len; ) {
+            struct inotify_event *ev = (struct inotify_event *)p;
+            if ((ev->mask & IN_Q_OVERFLOW) || (ev->len && strcmp(ev->name, w->name) == 0))
+                changed = 1;
+            p += sizeof(*ev) + ev->len;
+        }
+    }
+    return changed;
+}
+
+void plat_file_watch_close(PlatFileWatch *w) {
+    if (w->fd >= 0) close(w->fd);
+    w->fd = -1;
+}
+
+bool plat_steam_dir(char *buf, size_t size) {
+    static const char *const rel[] = {
+        ".steam/steam",
+        ".local/share/Steam",
+        ".var/app/com.valvesoftware.Steam/.local/share/Steam",   /* Flatpak */
+    };
+    const char *home = getenv("HOME");
+    if (!home || !home[0]) return false;
+    for (size_t i = 0; i < sizeof(rel) / sizeof(rel[0]); i++) {
+        snprintf(buf, size, "%s/%s", home, rel[i]);
+        if (plat_path_exists(buf)) return true;
+    }
+    return false;
+}
+
+#endif
+
+/* ---------- shared ---------- */
+
+PlatSocket plat_listen_loopback(int port, int backlog, const char *tag) {
+    PlatSocket s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (s == PLAT_INVALID_SOCKET) {
+        printf("%s Socket creation failed: %d\n", tag, plat_socket_error());
+        return PLAT_INVALID_SOCKET;
+    }
+
+    int opt = 1;
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, (const char *)&opt, sizeof(opt));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    addr.sin_port = htons((unsigned short)port);
+
+    if (bind(s, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(s, backlog) != 0) {
+        printf("%s Cannot listen on 127.0.0.1:%d: %d\n", tag, port, plat_socket_error());
+        plat_socket_close(s);
+        return PLAT_INVALID_SOCKET;
+    }
+    return s;
+}
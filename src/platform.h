@@ -0,0 +1,218 @@
+/*
+ * platform.h - Thin OS layer for the tuner (Win32 / POSIX)
+ *
+ * Monotonic clock, threads, locks, loopback sockets, termination signals,
+ * file change notification and the Steam install lookup: everything the
+ * tuner needs from the OS that isn't standard C. Atomics are C11
+ * <stdatomic.h> on both platforms and need no wrapper here.
+ *
+ * Shared memory (telemetry_shm.c), mapped files (stats_store.c) and the
+ * process watcher (proc_watch.c) keep their own #ifdef branches: each is
+ * the only user of its OS interface.
+ */
+
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+/* winsock2 must come before windows.h */
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windows.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+#define PLAT_PATH_MAX  MAX_PATH
+#define PLAT_SEP       "\\"
+#else
+#define PLAT_PATH_MAX  4096
+#define PLAT_SEP       "/"
+#endif
+
+/* ---------- clock ---------- */
+
+/* Monotonic ticks (QPC / CLOCK_MONOTONIC ns), plat_tick_freq() per second. */
+int64_t plat_ticks(void);
+int64_t plat_tick_freq(void);
+
+/* Monotonic milliseconds for coarse intervals. Wraps; compare differences. */
+uint32_t plat_ms(void);
+
+void plat_sleep_ms(int ms);
+
+/* Give up the rest of the time slice. */
+void plat_yield(void);
+
+/*
+ * Ask for a 0.5 ms scheduler tick for the life of the process (Windows;
+ * Linux timers are already high resolution). Returns the previous tick in
+ * ms, or 0 when there is nothing to change.
+ */
+double plat_timer_resolution_begin(void);
+void plat_timer_resolution_end(void);
+
+/* ---------- memory ---------- */
+
+/* Heap block for a type aligned beyond malloc's guarantee (_Alignas(64)).
+ * align is a power of two; release with plat_aligned_free. */
+void *plat_aligned_alloc(size_t align, size_t size);
+void plat_aligned_free(void *p);
+
+/* ---------- threads ---------- */
+
+typedef void (*PlatThreadFn)(void *arg);
+
+typedef enum {
+    PLAT_PRIO_NORMAL,
+    PLAT_PRIO_BELOW_NORMAL,     /* SCHED_BATCH on Linux */
+    PLAT_PRIO_LOWEST,           /* SCHED_IDLE on Linux */
+} PlatPrio;
+
+typedef struct {
+#ifdef _WIN32
+    void *handle;
+#else
+    pthread_t id;
+#endif
+    bool started;
+} PlatThread;
+
+/* Start fn(arg) on a new thread at prio. */
+bool plat_thread_start(PlatThread *t, PlatThreadFn fn, void *arg, PlatPrio prio);
+
+/*
+ * Wait up to timeout_ms (-1 = forever) for the thread to finish and release
+ * it. A thread still running after the timeout is abandoned (detached) and
+ * false returned: whatever it uses must stay alive. Safe on a thread that
+ * never started.
+ */
+bool plat_thread_join(PlatThread *t, int timeout_ms);
+
+/* ---------- locks ---------- */
+
+#ifdef _WIN32
+typedef CRITICAL_SECTION PlatMutex;
+#else
+typedef pthread_mutex_t PlatMutex;
+#endif
+
+void plat_mutex_init(PlatMutex *m);
+void plat_mutex_lock(PlatMutex *m);
+void plat_mutex_unlock(PlatMutex *m);
+void plat_mutex_destroy(PlatMutex *m);
+
+/* Auto-reset event: one waiter wakes per signal, a signal with no waiter
+ * is kept until the next wait. */
+typedef struct {
+#ifdef _WIN32
+    void *handle;
+#else
+    pthread_mutex_t m;
+    pthread_cond_t c;
+    bool set;
+#endif
+} PlatEvent;
+
+bool plat_event_init(PlatEvent *e);
+void plat_event_signal(PlatEvent *e);
+
+/* true = signalled, false = timed out. */
+bool plat_event_wait(PlatEvent *e, int timeout_ms);
+void plat_event_destroy(PlatEvent *e);
+
+/* ---------- sockets ---------- */
+
+#ifdef _WIN32
+typedef SOCKET PlatSocket;
+#define PLAT_INVALID_SOCKET INVALID_SOCKET
+#else
+typedef int PlatSocket;
+#define PLAT_INVALID_SOCKET (-1)
+#endif
+
+/* Winsock startup / SIGPIPE off. Call once before any socket. */
+void plat_net_init(void);
+void plat_net_cleanup(void);
+
+/* Last socket error code (WSAGetLastError / errno). */
+int plat_socket_error(void);
+
+/*
+ * Bound, listening TCP socket on 127.0.0.1:port, or PLAT_INVALID_SOCKET
+ * (the reason is printed with `tag`, e.g. "[GSI]").
+ */
+PlatSocket plat_listen_loopback(int port, int backlog, const char *tag);
+
+/* 1 = readable (or a pending accept), 0 = timeout, -1 = error. */
+int plat_socket_wait(PlatSocket s, int timeout_ms);
+
+/* Blocking receives give up after timeout_ms. */
+void plat_socket_recv_timeout(PlatSocket s, int timeout_ms);
+
+void plat_socket_close(PlatSocket s);
+
+/* ---------- termination ---------- */
+
+/*
+ * Call fn on Ctrl+C, console close, logoff/shutdown (Windows) or SIGINT,
+ * SIGTERM, SIGHUP (POSIX).
+ *   Windows  fn runs on a console control thread; for close/logoff/shutdown
+ *            the process is killed when it returns, so it must wait for the
+ *            main thread to finish cleaning up.
+ *   POSIX    fn runs in signal context: it may only set flags and call
+ *            async-signal-safe functions. Clean up after the main loop.
+ */
+void plat_on_terminate(void (*fn)(void));
+
+/* True where the process may end as soon as plat_on_terminate's fn returns. */
+#ifdef _WIN32
+#define PLAT_EXIT_AFTER_HANDLER 1
+#else
+#define PLAT_EXIT_AFTER_HANDLER 0
+#endif
+
+/* ---------- files ---------- */
+
+bool plat_path_exists(const char *path);
+
+/*
+ * Change notification for one file, watched through its directory so
+ * editors that save by rename are seen too.
+ */
+typedef struct {
+    char name[PLAT_PATH_MAX];   /* file name within the directory */
+#ifdef _WIN32
+    void *dir;
+    OVERLAPPED ov;
+    DWORD buf[1024];            /* DWORD-aligned, as ReadDirectoryChangesW requires */
+    bool armed;
+#else
+    int fd;                     /* inotify */
+#endif
+} PlatFileWatch;
+
+bool plat_file_watch_open(PlatFileWatch *w, const char *path);
+
+/*
+ * Wait up to timeout_ms. 1 = the file changed (or events were lost, so it
+ * may have), 0 = nothing, -1 = the watch failed.
+ */
+int plat_file_watch_wait(PlatFileWatch *w, int timeout_ms);
+
+void plat_file_watch_close(PlatFileWatch *w);
+
+/* Steam install directory (registry / ~/.steam). */
+bool plat_steam_dir(char *buf, size_t size);
+
+#endif /* PLATFORM_H */
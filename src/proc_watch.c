@@ -0,0 +1,246 @@
+/*
+ * proc_watch.c - Game process start/exit detection
+ */
+
+#include "proc_watch.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <tlhelp32.h>
+#else
+#include <ctype.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <linux/cn_proc.h>
+#include <linux/connector.h>
+#include <linux/netlink.h>
+#endif
+
+#ifdef _WIN32
+
+uint32_t proc_find(const char *name) {
+    HANDLE snap = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+    if (snap == INVALID_HANDLE_VALUE) return 0;
+
+    PROCESSENTRY32 pe;
+    pe.dwSize = sizeof(pe);
+    uint32_t pid = 0;
+
+    if (Process32First(snap, &pe)) {
+        do {
+            if (_stricmp(pe.szExeFile, name) == 0) { pid = pe.th32ProcessID; break; }
+        } while (Process32Next(snap, &pe));
+    }
+
+    CloseHandle(snap);
+    return pid;
+}
+
+bool proc_watch_init(ProcWatch *w, const char *name) {
+    memset(w, 0, sizeof(*w));
+    snprintf(w->name, sizeof(w->name), "%s", name);
+    w->cancel_event = CreateEventA(NULL, TRUE, FALSE, NULL);
+    w->ready = w->cancel_event != NULL;
+    return w->ready;
+}
+
+bool proc_wait_start(ProcWatch *w) {
+    while (!atomic_load(&w->cancelled)) {
+        w->pid = proc_find(w->name);
+        if (w->pid) return true;
+        WaitForSingleObject(w->cancel_event, PROC_POLL_MS);
+    }
+    return false;
+}
+
+static void exit_thread(void *param) {
+    ProcWatch *w = (ProcWatch *)param;
+    if (w->process) {
+        HANDLE h[2] = { w->process, w->cancel_event };
+        if (WaitForMultipleObjects(2, h, FALSE, INFINITE) != WAIT_OBJECT_0) return;
+    } else {
+        /* No SYNCHRONIZE access (e.g. elevated game): poll by pid */
+        while (proc_find(w->name) == w->pid)
+            if (WaitForSingleObject(w->cancel_event, PROC_POLL_MS) == WAIT_OBJECT_0) return;
+    }
+    if (!atomic_load(&w->cancelled)) w->on_exit(w->user);
+}
+
+bool proc_watch_exit(ProcWatch *w, ProcExitFn on_exit, void *user) {
+    w->on_exit = on_exit;
+    w->user = user;
+    w->process = OpenProcess(SYNCHRONIZE, FALSE, w->pid);
+    return plat_thread_start(&w->thread, exit_thread, w, PLAT_PRIO_NORMAL);
+}
+
+void proc_watch_cancel(ProcWatch *w) {
+    if (!w->ready) return;
+    atomic_store(&w->cancelled, true);
+    SetEvent(w->cancel_event);
+}
+
+void proc_watch_close(ProcWatch *w) {
+    if (!w->ready) return;
+    proc_watch_cancel(w);
+    plat_thread_join(&w->thread, 1000);
+    if (w->process) { CloseHandle(w->process); w->process = NULL; }
+    CloseHandle(w->cancel_event);
+    w->cancel_event = NULL;
+    w->ready = false;
+}
+
+#else /* Linux */
+
+/* comm is the executable name truncated to 15 chars; "cs2.exe" also
+ * matches a native "cs2" */
+static bool comm_matches(const char *comm, const char *name) {
+    size_t n = strlen(name);
+    if (strncasecmp(comm, name, 15) == 0) return true;
+    return n > 4 && strcasecmp(name + n - 4, ".exe") == 0 &&
+           strlen(comm) == n - 4 && strncasecmp(comm, name, n - 4) == 0;
+}
+
+static bool pid_matches(uint32_t pid, const char *name) {
+    char path[64], comm[32];
+    snprintf(path, sizeof(path), "/proc/%u/comm", pid);
+    FILE *f = fopen(path, "r");
+    if (!f) return false;
+    bool ok = fgets(comm, sizeof(comm), f) != NULL;
+    fclose(f);
+    if (!ok) return false;
+    comm[strcspn(comm, "\n")] = '\0';
+    return comm_matches(comm, name);
+}
+
+uint32_t proc_find(const char *name) {
+    DIR *d = opendir("/proc");
+    if (!d) return 0;
+    uint32_t pid = 0;
+    struct dirent *e;
+    while (!pid && (e = readdir(d))) {
+        if (!isdigit((unsigned char)e->d_name[0])) continue;
+        uint32_t p = (uint32_t)strtoul(e->d_name, NULL, 10);
+        if (pid_matches(p, name)) pid = p;
+    }
+    closedir(d);
+    return pid;
+}
+
+bool proc_watch_init(ProcWatch *w, const char *name) {
+    memset(w, 0, sizeof(*w));
+    snprintf(w->name, sizeof(w->name), "%s", name);
+    w->pidfd = -1;
+    w->ready = pipe(w->cancel_fd) == 0;
+    return w->ready;
+}
+
+/* Subscribe to exec/exit events. Needs CAP_NET_ADMIN; -1 otherwise. */
+static int proc_connector_open(void) {
+    int fd = socket(PF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+    if (fd < 0) return -1;
+    struct sockaddr_nl sa = { .nl_family = AF_NETLINK, .nl_groups = CN_IDX_PROC,
+                              .nl_pid = (uint32_t)getpid() };
+    if (bind(fd, (struct sockaddr *)&sa, sizeof(sa)) < 0) { close(fd); return -1; }
+
+    struct {
+        struct nlmsghdr nl;
+        struct cn_msg cn;
+        enum proc_cn_mcast_op op;
+    } __attribute__((packed)) msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.nl.nlmsg_len = sizeof(msg);
+    msg.nl.nlmsg_type = NLMSG_DONE;
+    msg.nl.nlmsg_pid = (uint32_t)getpid();
+    msg.cn.id.idx = CN_IDX_PROC;
+    msg.cn.id.val = CN_VAL_PROC;
+    msg.cn.len = sizeof(msg.op);
+    msg.op = PROC_CN_MCAST_LISTEN;
+    if (send(fd, &msg, sizeof(msg), 0) < 0) { close(fd); return -1; }
+    return fd;
+}
+
+/* Drain connector messages; returns a matching exec'd pid, or 0 */
+static uint32_t proc_connector_read(int fd, const char *name) {
+    char buf[4096] __attribute__((aligned(NLMSG_ALIGNTO)));
+    ssize_t len = recv(fd, buf, sizeof(buf), MSG_DONTWAIT);
+    if (len <= 0) return 0;
+    for (struct nlmsghdr *nl = (struct nlmsghdr *)buf; NLMSG_OK(nl, (size_t)len);
+         nl = NLMSG_NEXT(nl, len)) {
+        struct cn_msg *cn = (struct cn_msg *)NLMSG_DATA(nl);
+        struct proc_event *ev = (struct proc_event *)cn->data;
+        if (ev->what != PROC_EVENT_EXEC && ev->what != PROC_EVENT_COMM) continue;
+        /* tgid: COMM events also fire for renamed threads */
+        uint32_t pid = (uint32_t)ev->event_data.exec.process_tgid;
+        if (pid_matches(pid, name)) return pid;
+    }
+    return 0;
+}
+
+bool proc_wait_start(ProcWatch *w) {
+    /* Subscribe before scanning so a start in between is not missed */
+    int cn = proc_connector_open();
+    w->pid = proc_find(w->name);
+    if (w->pid) {
+        if (cn >= 0) close(cn);
+        return true;
+    }
+
+    struct pollfd p[2] = { { w->cancel_fd[0], POLLIN, 0 }, { cn, POLLIN, 0 } };
+    while (!atomic_load(&w->cancelled)) {
+        int r = poll(p, cn >= 0 ? 2 : 1, cn >= 0 ? -1 : PROC_POLL_MS);
+        if (r < 0 && errno != EINTR) break;
+        w->pid = cn >= 0 ? (p[1].revents ? proc_connector_read(cn, w->name) : 0)
+                         : proc_find(w->name);
+        if (w->pid) break;
+    }
+    if (cn >= 0) close(cn);
+    return w->pid != 0;
+}
+
+static void exit_thread(void *param) {
+    ProcWatch *w = (ProcWatch *)param;
+    struct pollfd p[2] = { { w->cancel_fd[0], POLLIN, 0 }, { w->pidfd, POLLIN, 0 } };
+    for (;;) {
+        int r = poll(p, w->pidfd >= 0 ? 2 : 1, w->pidfd >= 0 ? -1 : PROC_POLL_MS);
+        if (atomic_load(&w->cancelled)) return;
+        if (r < 0 && errno != EINTR) return;
+        if (w->pidfd >= 0 ? (r > 0 && p[1].revents) : !pid_matches(w->pid, w->name)) break;
+    }
+    w->on_exit(w->user);
+}
+
+bool proc_watch_exit(ProcWatch *w, ProcExitFn on_exit, void *user) {
+    w->on_exit = on_exit;
+    w->user = user;
+#ifdef SYS_pidfd_open
+    w->pidfd = (int)syscall(SYS_pidfd_open, (pid_t)w->pid, 0);
+#endif
+    return plat_thread_start(&w->thread, exit_thread, w, PLAT_PRIO_NORMAL);
+}
+
+void proc_watch_cancel(ProcWatch *w) {
+    if (!w->ready) return;
+    atomic_store(&w->cancelled, true);
+    char c = 1;
+    ssize_t n = write(w->cancel_fd[1], &c, 1);
+    (void)n;
+}
+
+void proc_watch_close(ProcWatch *w) {
+    if (!w->ready) return;
+    proc_watch_cancel(w);
+    plat_thread_join(&w->thread, -1);
+    if (w->pidfd >= 0) { close(w->pidfd); w->pidfd = -1; }
+    close(w->cancel_fd[0]);
+    close(w->cancel_fd[1]);
+    w->ready = false;
+}
+
+#endif
@@ -0,0 +1,75 @@
+/*
+ * proc_watch.h - Event-driven game process watcher (--watch)
+ *
+ * Start: one scan, then
+ *   Windows  a Toolhelp32 scan every PROC_POLL_MS on the waiting thread
+ *            (user mode has no process-creation event without WMI/ETW)
+ *   Linux    exec events from the netlink proc connector, else a /proc
+ *            scan every PROC_POLL_MS when the connector is not permitted
+ * Exit: a wait on the process itself (process handle / pidfd), reported
+ * from a background thread the moment the process ends; where neither can
+ * be opened, that thread polls for the pid every PROC_POLL_MS instead.
+ *
+ * The sampling loop never polls: the exit thread calls back instead.
+ */
+
+#ifndef PROC_WATCH_H
+#define PROC_WATCH_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "platform.h"
+
+#define PROC_POLL_MS  500
+
+typedef void (*ProcExitFn)(void *user);
+
+typedef struct {
+    char name[64];
+    uint32_t pid;               /* found process, 0 = none */
+    bool ready;                 /* init succeeded */
+    atomic_bool cancelled;
+    ProcExitFn on_exit;
+    void *user;
+    PlatThread thread;
+#ifdef _WIN32
+    void *cancel_event;
+    void *process;
+#else
+    int cancel_fd[2];           /* pipe: a byte wakes every wait */
+    int pidfd;
+#endif
+} ProcWatch;
+
+bool proc_watch_init(ProcWatch *w, const char *name);
+
+/* One scan. Returns the pid of a matching process, or 0. */
+uint32_t proc_find(const char *name);
+
+/*
+ * Block until the process runs (w->pid is set) or proc_watch_cancel() is
+ * called. Returns false when cancelled.
+ */
+bool proc_wait_start(ProcWatch *w);
+
+/*
+ * Call on_exit(user) from a background thread when w->pid exits, unless
+ * proc_watch_cancel() comes first. Requires a successful proc_wait_start().
+ *   Waits on a process handle (Windows, SYNCHRONIZE) or a pidfd (Linux
+ *   5.3+), so the exit is seen at once.
+ *   Without one (elevated game, older kernel, pid already gone) it polls
+ *   every PROC_POLL_MS instead: the Toolhelp snapshot or /proc/<pid>/comm.
+ *   A pid that has already exited is therefore reported on the first poll.
+ * on_exit always runs on the watcher thread, never inside this call.
+ * Returns false only if that thread could not be started.
+ */
+bool proc_watch_exit(ProcWatch *w, ProcExitFn on_exit, void *user);
+
+/* Wake any wait. Safe from a signal / console control handler. */
+void proc_watch_cancel(ProcWatch *w);
+
+/* Cancel, join the exit thread, release handles. */
+void proc_watch_close(ProcWatch *w);
+
+#endif /* PROC_WATCH_H */
@@ -0,0 +1,63 @@
+/*
+ * spsc_ring.h - Lock-free single-producer/single-consumer ring buffer
+ *
+ * Fixed-size records, power-of-two capacity, storage supplied by the caller.
+ * The producer (hot loop) only touches `head`, the consumer (background
+ * thread) only touches `tail`, so neither side ever blocks or takes a lock.
+ * A full ring rejects the push; the caller decides whether to count a drop.
+ */
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#define SPSC_CACHE_LINE 64
+
+typedef struct {
+    _Atomic uint32_t head;      /* next slot to write (producer-owned) */
+    char pad0[SPSC_CACHE_LINE - sizeof(uint32_t)];
+    _Atomic uint32_t tail;      /* next slot to read (consumer-owned) */
+    char pad1[SPSC_CACHE_LINE - sizeof(uint32_t)];
+    uint32_t mask;              /* capacity - 1 */
+    uint32_t elem_size;
+    uint8_t *slots;
+} SpscRing;
+
+/*
+ * Initialize a ring over `slots` (capacity * elem_size bytes).
+ * capacity must be a power of two.
+ */
+static inline void spsc_init(SpscRing *r, void *slots, uint32_t capacity,
+                             uint32_t elem_size) {
+    atomic_init(&r->head, 0);
+    atomic_init(&r->tail, 0);
+    r->mask = capacity - 1;
+    r->elem_size = elem_size;
+    r->slots = (uint8_t *)slots;
+}
+
+/* Producer side. Returns false (record not stored) when the ring is full. */
+static inline bool spsc_push(SpscRing *r, const void *elem) {
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    if (head - tail > r->mask) return false;
+    memcpy(r->slots + (size_t)(head & r->mask) * r->elem_size, elem, r->elem_size);
+    atomic_store_explicit(&r->head, head + 1, memory_order_release);
+    return true;
+}
+
+/* Consumer side. Returns false when the ring is empty. */
+static inline bool spsc_pop(SpscRing *r, void *out) {
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+    if (tail == head) return false;
+    memcpy(out, r->slots + (size_t)(tail & r->mask) * r->elem_size, r->elem_size);
+    atomic_store_explicit(&r->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+#endif /* SPSC_RING_H */
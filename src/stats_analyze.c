@@ -0,0 +1,386 @@
+/*
+ * stats_analyze.c - Parallel analyzer for binary counter-strafe history
+ *
+ * Memory-maps one or more stats files, splits the record arrays into
+ * fixed-size chunks and lets one worker per core pull chunks off a shared
+ * atomic cursor. Each worker aggregates into private histograms (no
+ * locks, no sharing); the main thread merges them and prints a text or
+ * JSON report: overall, per axis/counter key, per weapon, per day, trend.
+ *
+ * Usage: stats-analyze [--json] [--threads N] [file.bin ...]
+ */
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "histogram.h"
+#include "stats_store.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#define DEFAULT_PATH   "wooting-aim-stats.bin"
+#define MAX_FILES      64
+#define MAX_THREADS    64
+#define MAX_DAYS       4096    /* ~11 years of daily buckets */
+#define CHUNK_RECORDS  65536   /* 2 MB of records per work item */
+#define NS_PER_DAY     (86400LL * 1000000000LL)
+#define TREND_MIN_N    20      /* days with fewer strafes don't vote in the trend */
+
+typedef struct {
+    Histogram hist;
+    double vel_sum;
+} Agg;
+
+typedef struct {
+    Agg total;
+    Agg axis[2][2];            /* [axis][dir 0=neg 1=pos] */
+    Agg weapon[256];
+    Agg *day;                  /* [num_days] */
+} Partial;
+
+typedef struct {
+    StatsMap maps[MAX_FILES];
+    int num_files;
+    size_t chunk_start[MAX_FILES + 1];  /* prefix sum of chunks per file */
+    atomic_size_t next_chunk;
+    int64_t day0;              /* local day number of the first day */
+    int num_days;
+    int64_t utc_offset_ns;
+} Job;
+
+static Job g_job;
+
+/* ---------- aggregation ---------- */
+
+static void agg_add(Agg *a, const StatsRecord *r) {
+    hist_record(&a->hist, r->counter_ms);
+    a->vel_sum += r->vel_start;
+}
+
+static void agg_merge(Agg *dst, const Agg *src) {
+    hist_merge(&dst->hist, &src->hist);
+    dst->vel_sum += src->vel_sum;
+}
+
+static int64_t local_day(int64_t ts_ns) {
+    int64_t t = ts_ns + g_job.utc_offset_ns;
+    return t >= 0 ? t / NS_PER_DAY : (t - NS_PER_DAY + 1) / NS_PER_DAY;
+}
+
+static void process_chunk(Partial *p, size_t chunk) {
+    int f = 0;
+    while (chunk >= g_job.chunk_start[f + 1]) f++;
+    const StatsMap *m = &g_job.maps[f];
+    size_t begin = (chunk - g_job.chunk_start[f]) * CHUNK_RECORDS;
+    size_t end = begin + CHUNK_RECORDS;
+    if (end > m->count) end = m->count;
+
+    for (size_t i = begin; i < end; i++) {
+        const StatsRecord *r = &m->rec[i];
+        int axis = r->axis ? 1 : 0;
+        int dir = (r->dir == 'D' || r->dir == 'W') ? 1 : 0;
+        agg_add(&p->total, r);
+        agg_add(&p->axis[axis][dir], r);
+        agg_add(&p->weapon[r->weapon_id], r);
+        int64_t d = local_day(r->ts_ns) - g_job.day0;
+        if (d >= 0 && d < g_job.num_days) agg_add(&p->day[d], r);
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI worker(LPVOID param)
+#else
+static void *worker(void *param)
+#endif
+{
+    Partial *p = (Partial *)param;
+    size_t total = g_job.chunk_start[g_job.num_files];
+    for (;;) {
+        size_t c = atomic_fetch_add_explicit(&g_job.next_chunk, 1, memory_order_relaxed);
+        if (c >= total) break;
+        process_chunk(p, c);
+    }
+    return 0;
+}
+
+static int cpu_count(void) {
+#ifdef _WIN32
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return (int)si.dwNumberOfProcessors;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#endif
+}
+
+static void run_workers(Partial *parts, int n) {
+#ifdef _WIN32
+    HANDLE th[MAX_THREADS];
+    for (int i = 1; i < n; i++) th[i] = CreateThread(NULL, 0, worker, &parts[i], 0, NULL);
+    worker(&parts[0]);
+    for (int i = 1; i < n; i++) {
+        if (!th[i]) continue;
+        WaitForSingleObject(th[i], INFINITE);
+        CloseHandle(th[i]);
+    }
+#else
+    pthread_t th[MAX_THREADS];
+    bool ok[MAX_THREADS] = {0};
+    for (int i = 1; i < n; i++) ok[i] = pthread_create(&th[i], NULL, worker, &parts[i]) == 0;
+    worker(&parts[0]);
+    for (int i = 1; i < n; i++) if (ok[i]) pthread_join(th[i], NULL);
+#endif
+}
+
+static double now_sec(void) {
+#ifdef _WIN32
+    LARGE_INTEGER f, c;
+    QueryPerformanceFrequency(&f);
+    QueryPerformanceCounter(&c);
+    return (double)c.QuadPart / (double)f.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#endif
+}
+
+/* Offset of local time from UTC right now (applied to all days) */
+static int64_t utc_offset_ns(void) {
+    time_t now = time(NULL);
+    struct tm lt = *localtime(&now);
+    struct tm gt = *gmtime(&now);
+    lt.tm_isdst = 0;
+    gt.tm_isdst = 0;
+    return (int64_t)difftime(mktime(&lt), mktime(&gt)) * 1000000000LL;
+}
+
+static void day_string(int64_t day, char *buf, size_t size) {
+    time_t t = (time_t)(day * 86400);
+    struct tm *g = gmtime(&t);
+    snprintf(buf, size, "%04d-%02d-%02d", g->tm_year + 1900, g->tm_mon + 1, g->tm_mday);
+}
+
+/* ---------- trend ---------- */
+
+typedef struct {
+    double p50_slope;          /* ms per day */
+    double perf_slope;         /* PERF share (percentage points) per day */
+    int days;
+} Trend;
+
+/* Least-squares slopes over days with at least TREND_MIN_N strafes */
+static Trend compute_trend(const Agg *days, int n) {
+    Trend t = {0};
+    double sx = 0, sy = 0, sp = 0, sxx = 0, sxy = 0, sxp = 0;
+    for (int d = 0; d < n; d++) {
+        const Histogram *h = &days[d].hist;
+        if (h->total < TREND_MIN_N) continue;
+        double y = hist_percentile(h, 50);
+        double p = 100.0 * h->quality[CSQ_PERF] / (double)h->total;
+        sx += d; sy += y; sp += p;
+        sxx += (double)d * d; sxy += d * y; sxp += d * p;
+        t.days++;
+    }
+    double den = t.days * sxx - sx * sx;
+    if (t.days >= 2 && den != 0) {
+        t.p50_slope = (t.days * sxy - sx * sy) / den;
+        t.perf_slope = (t.days * sxp - sx * sp) / den;
+    }
+    return t;
+}
+
+/* ---------- output ---------- */
+
+static void text_row(const char *label, const Agg *a) {
+    const Histogram *h = &a->hist;
+    printf("  %-14s %8llu  avg:%6.1f  p50:%6.1f  p90:%6.1f  p99:%6.1f  v0:%5.0f ",
+           label, (unsigned long long)h->total, hist_mean(h),
+           hist_percentile(h, 50), hist_percentile(h, 90), hist_percentile(h, 99),
+           a->vel_sum / (double)h->total);
+    for (int q = 0; q < CSQ_COUNT; q++)
+        printf(" %s:%3.0f%%", strafe_quality_names[q], 100.0 * h->quality[q] / (double)h->total);
+    printf("\n");
+}
+
+static void json_row(const char *key, const char *label, const Agg *a, bool last) {
+    const Histogram *h = &a->hist;
+    printf("    {\"%s\": \"%s\", \"count\": %llu, \"mean_ms\": %.2f, \"p50_ms\": %.2f, "
+           "\"p90_ms\": %.2f, \"p99_ms\": %.2f, \"vel_start\": %.1f",
+           key, label, (unsigned long long)h->total, hist_mean(h),
+           hist_percentile(h, 50), hist_percentile(h, 90), hist_percentile(h, 99),
+           a->vel_sum / (double)h->total);
+    for (int q = 0; q < CSQ_COUNT; q++)
+        printf(", \"%s\": %.4f", strafe_quality_names[q], h->quality[q] / (double)h->total);
+    printf("}%s\n", last ? "" : ",");
+}
+
+static const char *axis_key_label(int axis, int dir) {
+    static const char *labels[2][2] = { { "H/A", "H/D" }, { "V/S", "V/W" } };
+    return labels[axis][dir];
+}
+
+static void print_text(const Partial *r, const Trend *t, size_t records,
+                       double secs, int threads) {
+    printf("=== wooting-aim stats analysis ===\n");
+    printf("Files: %d  Records: %zu  Parsed in %.3f s on %d threads (%.0f M records/s)\n\n",
+           g_job.num_files, records, secs, threads, secs > 0 ? records / secs / 1e6 : 0.0);
+    if (r->total.hist.total == 0) { printf("No records.\n"); return; }
+
+    printf("Overall\n");
+    text_row("all", &r->total);
+
+    printf("\nPer axis / counter key\n");
+    for (int a = 0; a < 2; a++)
+        for (int d = 0; d < 2; d++)
+            if (r->axis[a][d].hist.total) text_row(axis_key_label(a, d), &r->axis[a][d]);
+
+    printf("\nPer weapon\n");
+    for (int w = 0; w < 256; w++) {
+        if (!r->weapon[w].hist.total) continue;
+        const char *name = stats_weapon_name((uint8_t)w);
+        text_row(name[0] ? name : "(none)", &r->weapon[w]);
+    }
+
+    printf("\nPer day\n");
+    for (int d = 0; d < g_job.num_days; d++) {
+        if (!r->day[d].hist.total) continue;
+        char label[32];
+        day_string(g_job.day0 + d, label, sizeof(label));
+        text_row(label, &r->day[d]);
+    }
+
+    printf("\nTrend (%d days with >= %d strafes)\n", t->days, TREND_MIN_N);
+    if (t->days >= 2) {
+        printf("  p50: %+.3f ms/day   PERF: %+.3f pts/day\n", t->p50_slope, t->perf_slope);
+    } else {
+        printf("  not enough data\n");
+    }
+}
+
+static void print_json(const Partial *r, const Trend *t, size_t records,
+                       double secs, int threads) {
+    printf("{\n  \"files\": %d, \"records\": %zu, \"parse_seconds\": %.4f, \"threads\": %d,\n",
+           g_job.num_files, records, secs, threads);
+    printf("  \"overall\": [\n");
+    if (r->total.hist.total) json_row("group", "all", &r->total, true);
+    printf("  ],\n  \"axes\": [\n");
+    int n = 0, idx = 0;
+    for (int a = 0; a < 2; a++) for (int d = 0; d < 2; d++) n += r->axis[a][d].hist.total > 0;
+    for (int a = 0; a < 2; a++)
+        for (int d = 0; d < 2; d++)
+            if (r->axis[a][d].hist.total)
+                json_row("key", axis_key_label(a, d), &r->axis[a][d], ++idx == n);
+    printf("  ],\n  \"weapons\": [\n");
+    n = idx = 0;
+    for (int w = 0; w < 256; w++) n += r->weapon[w].hist.total > 0;
+    for (int w = 0; w < 256; w++)
+        if (r->weapon[w].hist.total)
+            json_row("weapon", stats_weapon_name((uint8_t)w), &r->weapon[w], ++idx == n);
+    printf("  ],\n  \"days\": [\n");
+    n = idx = 0;
+    for (int d = 0; d < g_job.num_days; d++) n += r->day[d].hist.total > 0;
+    for (int d = 0; d < g_job.num_days; d++) {
+        if (!r->day[d].hist.total) continue;
+        char label[32];
+        day_string(g_job.day0 + d, label, sizeof(label));
+        json_row("day", label, &r->day[d], ++idx == n);
+    }
+    printf("  ],\n  \"trend\": {\"days\": %d, \"p50_ms_per_day\": %.4f, \"perf_pts_per_day\": %.4f}\n}\n",
+           t->days, t->p50_slope, t->perf_slope);
+}
+
+/* ---------- main ---------- */
+
+int main(int argc, char *argv[]) {
+    const char *paths[MAX_FILES];
+    int num_paths = 0;
+    bool json = false;
+    int threads = cpu_count();
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0) json = true;
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (argv[i][0] == '-') {
+            printf("Usage: stats-analyze [--json] [--threads N] [file.bin ...]\n");
+            return strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        } else if (num_paths < MAX_FILES) paths[num_paths++] = argv[i];
+    }
+    if (num_paths == 0) paths[num_paths++] = DEFAULT_PATH;
+    if (threads < 1) threads = 1;
+    if (threads > MAX_THREADS) threads = MAX_THREADS;
+
+    double t0 = now_sec();
+
+    /* Map inputs, lay out chunks, find the day range from the file ends */
+    g_job.utc_offset_ns = utc_offset_ns();
+    int64_t first_day = INT64_MAX, last_day = INT64_MIN;
+    size_t records = 0;
+    for (int i = 0; i < num_paths; i++) {
+        StatsMap *m = &g_job.maps[g_job.num_files];
+        if (!stats_map_open(m, paths[i])) {
+            fprintf(stderr, "Cannot open stats file: %s\n", paths[i]);
+            continue;
+        }
+        size_t chunks = (m->count + CHUNK_RECORDS - 1) / CHUNK_RECORDS;
+        g_job.chunk_start[g_job.num_files + 1] = g_job.chunk_start[g_job.num_files] + chunks;
+        g_job.num_files++;
+        records += m->count;
+        if (m->count) {
+            int64_t a = local_day(m->rec[0].ts_ns), b = local_day(m->rec[m->count - 1].ts_ns);
+            if (a < first_day) first_day = a;
+            if (b > last_day) last_day = b;
+        }
+    }
+    if (g_job.num_files == 0) return 1;
+
+    if (records) {
+        /* Keep the most recent MAX_DAYS if the history is longer */
+        if (last_day - first_day + 1 > MAX_DAYS) first_day = last_day - MAX_DAYS + 1;
+        g_job.day0 = first_day;
+        g_job.num_days = (int)(last_day - first_day + 1);
+    }
+    atomic_init(&g_job.next_chunk, 0);
+
+    size_t total_chunks = g_job.chunk_start[g_job.num_files];
+    if ((size_t)threads > total_chunks) threads = total_chunks ? (int)total_chunks : 1;
+
+    Partial *parts = calloc((size_t)threads, sizeof(Partial));
+    Agg *days = calloc((size_t)threads * (g_job.num_days ? g_job.num_days : 1), sizeof(Agg));
+    if (!parts || !days) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    for (int i = 0; i < threads; i++) parts[i].day = days + (size_t)i * g_job.num_days;
+
+    run_workers(parts, threads);
+
+    /* Merge into parts[0] */
+    Partial *r = &parts[0];
+    for (int i = 1; i < threads; i++) {
+        const Partial *p = &parts[i];
+        agg_merge(&r->total, &p->total);
+        for (int a = 0; a < 2; a++)
+            for (int d = 0; d < 2; d++) agg_merge(&r->axis[a][d], &p->axis[a][d]);
+        for (int w = 0; w < 256; w++) agg_merge(&r->weapon[w], &p->weapon[w]);
+        for (int d = 0; d < g_job.num_days; d++) agg_merge(&r->day[d], &p->day[d]);
+    }
+    double secs = now_sec() - t0;
+
+    Trend t = compute_trend(r->day, g_job.num_days);
+    if (json) print_json(r, &t, records, secs, threads);
+    else print_text(r, &t, records, secs, threads);
+
+    for (int i = 0; i < g_job.num_files; i++) stats_map_close(&g_job.maps[i]);
+    free(days);
+    free(parts);
+    return 0;
+}
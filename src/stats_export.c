@@ -0,0 +1,164 @@
+/*
+ * stats_export.c - Convert the binary stats store to CSV
+ *
+ * Memory-maps wooting-aim-stats.bin and prints the selected records.
+ * Time ranges are resolved by binary search, sessions via the .idx file,
+ * so exporting one evening out of months of history is instant.
+ *
+ * Usage: stats-export [options] [wooting-aim-stats.bin]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "stats_store.h"
+
+#define DEFAULT_PATH "wooting-aim-stats.bin"
+
+static void usage(void) {
+    printf("Usage: stats-export [options] [file.bin]\n\n");
+    printf("  -o FILE          write CSV to FILE (default: stdout)\n");
+    printf("  --from DATE      records at/after DATE (local time)\n");
+    printf("  --to DATE        records before DATE (local time)\n");
+    printf("  --session N      records of session N only\n");
+    printf("  --sessions       list sessions and exit\n\n");
+    printf("DATE: YYYY-MM-DD or \"YYYY-MM-DD HH:MM:SS\"\n");
+}
+
+/* Parse a local date/time into ns since epoch. Returns false on bad input. */
+static bool parse_date(const char *s, int64_t *out) {
+    struct tm t = {0};
+    int n = sscanf(s, "%d-%d-%d %d:%d:%d", &t.tm_year, &t.tm_mon, &t.tm_mday,
+                   &t.tm_hour, &t.tm_min, &t.tm_sec);
+    if (n != 3 && n != 6) return false;
+    t.tm_year -= 1900;
+    t.tm_mon -= 1;
+    t.tm_isdst = -1;
+    time_t secs = mktime(&t);
+    if (secs == (time_t)-1) return false;
+    *out = (int64_t)secs * 1000000000LL;
+    return true;
+}
+
+/* "YYYY-MM-DD hh:mm:ss.mmm", sized for any int the fields can hold */
+#define TIME_LEN 80
+
+static void format_time(int64_t ns, char *buf, size_t size) {
+    time_t secs = (time_t)(ns / 1000000000LL);
+    int ms = (int)((ns / 1000000LL) % 1000);
+    struct tm *t = localtime(&secs);
+    if (!t) { snprintf(buf, size, "?"); return; }
+    snprintf(buf, size, "%04d-%02d-%02d %02d:%02d:%02d.%03d",
+             t->tm_year + 1900, t->tm_mon + 1, t->tm_mday,
+             t->tm_hour, t->tm_min, t->tm_sec, ms);
+}
+
+/* wooting-aim-stats.bin -> wooting-aim-stats.idx */
+static void index_path(const char *path, char *buf, size_t size) {
+    snprintf(buf, size, "%s", path);
+    char *dot = strrchr(buf, '.');
+    if (dot && strcmp(dot, ".bin") == 0) *dot = '\0';
+    strncat(buf, ".idx", size - strlen(buf) - 1);
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = DEFAULT_PATH;
+    const char *out_path = NULL;
+    int64_t from = INT64_MIN, to = INT64_MAX;
+    long session = -1;
+    bool list_sessions = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) out_path = argv[++i];
+        else if (strcmp(argv[i], "--from") == 0 && i + 1 < argc) {
+            if (!parse_date(argv[++i], &from)) { fprintf(stderr, "Bad date: %s\n", argv[i]); return 1; }
+        } else if (strcmp(argv[i], "--to") == 0 && i + 1 < argc) {
+            if (!parse_date(argv[++i], &to)) { fprintf(stderr, "Bad date: %s\n", argv[i]); return 1; }
+        } else if (strcmp(argv[i], "--session") == 0 && i + 1 < argc) session = atol(argv[++i]);
+        else if (strcmp(argv[i], "--sessions") == 0) list_sessions = true;
+        else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) { usage(); return 0; }
+        else if (argv[i][0] == '-') { usage(); return 1; }
+        else path = argv[i];
+    }
+
+    StatsMap map;
+    if (!stats_map_open(&map, path)) {
+        fprintf(stderr, "Cannot open stats file: %s\n", path);
+        return 1;
+    }
+
+    char idx_path[512];
+    index_path(path, idx_path, sizeof(idx_path));
+    StatsSession *sessions = NULL;
+    size_t num_sessions = stats_index_load(idx_path, &sessions);
+
+    if (list_sessions) {
+        printf("session,start,first_record,records\n");
+        for (size_t i = 0; i < num_sessions; i++) {
+            uint64_t end = (i + 1 < num_sessions) ? sessions[i + 1].first_record : map.count;
+            char ts[TIME_LEN];
+            format_time(sessions[i].start_ns, ts, sizeof(ts));
+            printf("%u,%s,%llu,%llu\n", sessions[i].id, ts,
+                   (unsigned long long)sessions[i].first_record,
+                   (unsigned long long)(end - sessions[i].first_record));
+        }
+        free(sessions);
+        stats_map_close(&map);
+        return 0;
+    }
+
+    /* Resolve the record range: session bounds, then time bounds */
+    size_t begin = 0, end = map.count;
+    if (session >= 0) {
+        if ((size_t)session >= num_sessions) {
+            fprintf(stderr, "No session %ld (%zu sessions in %s)\n", session, num_sessions, idx_path);
+            free(sessions);
+            stats_map_close(&map);
+            return 1;
+        }
+        begin = (size_t)sessions[session].first_record;
+        if ((size_t)session + 1 < num_sessions) end = (size_t)sessions[session + 1].first_record;
+        if (begin > map.count) begin = map.count;
+        if (end > map.count) end = map.count;
+    }
+    if (from != INT64_MIN) {
+        size_t lb = stats_lower_bound(&map, from);
+        if (lb > begin) begin = lb;
+    }
+    if (to != INT64_MAX) {
+        size_t ub = stats_lower_bound(&map, to);
+        if (ub < end) end = ub;
+    }
+
+    FILE *out = stdout;
+    if (out_path) {
+        out = fopen(out_path, "w");
+        if (!out) {
+            fprintf(stderr, "Cannot write: %s\n", out_path);
+            free(sessions);
+            stats_map_close(&map);
+            return 1;
+        }
+    }
+
+    fprintf(out, "timestamp,session,axis,direction,counter_strafe_ms,weapon,vel_start,ap_mm,rt_mm\n");
+    for (size_t i = begin; i < end; i++) {
+        const StatsRecord *r = &map.rec[i];
+        char ts[TIME_LEN];
+        format_time(r->ts_ns, ts, sizeof(ts));
+        fprintf(out, "%s,%u,%c,%c,%.2f,%s,%.1f,%.2f,%.2f\n",
+                ts, r->session, r->axis == STATS_AXIS_V ? 'V' : 'H', r->dir,
+                r->counter_ms, stats_weapon_name(r->weapon_id),
+                r->vel_start, r->ap_mm, r->rt_mm);
+    }
+
+    if (out_path) {
+        fclose(out);
+        fprintf(stderr, "Exported %zu of %zu records to %s\n", end > begin ? end - begin : 0,
+                map.count, out_path);
+    }
+    free(sessions);
+    stats_map_close(&map);
+    return 0;
+}
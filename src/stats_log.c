@@ -0,0 +1,101 @@
+/*
+ * stats_log.c - Asynchronous counter-strafe statistics logger
+ *
+ * Producer: the main loop, via stats_log() (ring push only).
+ * Consumer: stats_writer_thread, at the lowest priority, which owns
+ * the FILE* and is the only code that converts timestamps or calls stdio.
+ */
+
+#include "stats_log.h"
+#include "stats_store.h"
+#include <string.h>
+
+/* Idle sleep between drains; events are never latency-critical here */
+#define STATS_POLL_MS 50
+
+/* Drain the ring into one fwrite. Returns the number of records written. */
+static int stats_drain(Stats *st) {
+    StatsRecord batch[STATS_RING_SIZE];
+    StatsEvent ev;
+    int n = 0;
+    while (n < STATS_RING_SIZE && spsc_pop(&st->ring, &ev)) {
+        StatsRecord *r = &batch[n++];
+        r->ts_ns      = st->base_ns +
+                        (int64_t)((double)(ev.ticks - st->base_ticks) * 1e9 / st->freq);
+        r->session    = st->session;
+        r->counter_ms = ev.counter_ms;
+        r->vel_start  = ev.vel_start;
+        r->ap_mm      = ev.ap_mm;
+        r->rt_mm      = ev.rt_mm;
+        r->axis       = ev.axis;
+        r->dir        = ev.dir;
+        r->weapon_id  = ev.weapon_id;
+        r->weapon_cat = ev.weapon_cat;
+    }
+    if (n) fwrite(batch, sizeof(StatsRecord), (size_t)n, st->file);
+    return n;
+}
+
+static void stats_writer_thread(void *param) {
+    Stats *st = (Stats *)param;
+    uint32_t last_flush = 0;
+    int pending = 0;
+
+    while (atomic_load_explicit(&st->running, memory_order_acquire)) {
+        pending += stats_drain(st);
+
+        /* Batch records; hit the disk at most once per STATS_FLUSH_MS */
+        uint32_t now = plat_ms();
+        if (pending && now - last_flush >= STATS_FLUSH_MS) {
+            fflush(st->file);
+            last_flush = now;
+            pending = 0;
+        }
+        plat_sleep_ms(STATS_POLL_MS);
+    }
+
+    while (stats_drain(st) > 0) {}
+    fflush(st->file);
+}
+
+void stats_init(Stats *st, const char *path, const char *idx_path) {
+    spsc_init(&st->ring, st->slots, STATS_RING_SIZE, sizeof(StatsEvent));
+    atomic_init(&st->running, false);
+    atomic_init(&st->dropped, 0);
+
+    st->file = stats_store_open(path, idx_path, &st->session);
+    if (!st->file) return;
+
+    st->freq = (double)plat_tick_freq();
+    st->base_ticks = plat_ticks();
+    st->base_ns = stats_wall_ns();
+
+    atomic_store(&st->running, true);
+    if (!plat_thread_start(&st->thread, stats_writer_thread, st, PLAT_PRIO_LOWEST)) {
+        /* No writer: fall back to an inert logger rather than blocking the loop */
+        atomic_store(&st->running, false);
+        fclose(st->file);
+        st->file = NULL;
+        printf("[STATS] Failed to start writer thread.\n");
+        return;
+    }
+    printf("[STATS] Logging to: %s (session %u)\n", path, st->session);
+}
+
+void stats_log(Stats *st, const StatsEvent *ev) {
+    if (!atomic_load_explicit(&st->running, memory_order_relaxed)) return;
+    if (!spsc_push(&st->ring, ev))
+        atomic_fetch_add_explicit(&st->dropped, 1, memory_order_relaxed);
+}
+
+void stats_close(Stats *st) {
+    if (!atomic_exchange(&st->running, false)) return;
+
+    plat_thread_join(&st->thread, 3000);
+    if (st->file) fclose(st->file);
+    st->file = NULL;
+
+    unsigned dropped = atomic_load(&st->dropped);
+    if (dropped)
+        printf("[STATS] %u events dropped (writer fell behind)\n", dropped);
+}
@@ -0,0 +1,70 @@
+/*
+ * stats_log.h - Asynchronous counter-strafe statistics logger
+ *
+ * The hot loop pushes fixed-size binary events into a lock-free ring.
+ * A low-priority background thread timestamps them and batch-appends
+ * StatsRecords to the binary store (see stats_store.h) with periodic
+ * flushes, so the sampling thread never touches the clock APIs, stdio
+ * or the disk.
+ */
+
+#ifndef STATS_LOG_H
+#define STATS_LOG_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "platform.h"
+#include "spsc_ring.h"
+
+#define STATS_RING_SIZE    256   /* events buffered between flushes (power of 2) */
+#define STATS_FLUSH_MS     1000  /* max time a record sits in the stdio buffer */
+
+/* One completed counter-strafe, as produced by the sampling thread */
+typedef struct {
+    int64_t ticks;                   /* plat_ticks() at the end of the counter-strafe */
+    float   counter_ms;
+    float   vel_start;               /* |axis velocity| at counter-strafe start */
+    float   ap_mm;                   /* AP/RT on the counter key */
+    float   rt_mm;
+    uint8_t axis;                    /* STATS_AXIS_H / STATS_AXIS_V */
+    uint8_t dir;                     /* counter key: 'A', 'D', 'W', 'S' */
+    uint8_t weapon_id;               /* stats_weapon_id() */
+    uint8_t weapon_cat;
+} StatsEvent;
+
+typedef struct {
+    FILE *file;
+    uint32_t session;
+    SpscRing ring;
+    StatsEvent slots[STATS_RING_SIZE];
+    PlatThread thread;               /* writer thread */
+    atomic_bool running;
+    atomic_uint dropped;             /* events lost to a full ring */
+
+    /* Wall clock anchor for converting ticks in the writer thread */
+    int64_t base_ticks;
+    int64_t base_ns;                 /* stats_wall_ns() at base_ticks */
+    double  freq;
+} Stats;
+
+/*
+ * Open (append) the binary store, register a session in the index file
+ * and start the writer thread.
+ * On failure the Stats stays inert and stats_log() is a no-op.
+ */
+void stats_init(Stats *st, const char *path, const char *idx_path);
+
+/*
+ * Queue one event. Called from the hot loop: a handful of stores, no I/O.
+ */
+void stats_log(Stats *st, const StatsEvent *ev);
+
+/*
+ * Stop the writer thread, drain anything still queued and close the file.
+ * Safe to call more than once and from the console control handler.
+ */
+void stats_close(Stats *st);
+
+#endif /* STATS_LOG_H */
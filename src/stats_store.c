@@ -0,0 +1,255 @@
+/*
+ * stats_store.c - Binary append-only counter-strafe statistics store
+ *
+ * Shared by the tuner (writer side) and the offline tools (mapping,
+ * range queries). Kept free of SDK/HID dependencies.
+ */
+
+#include "stats_store.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/* ---------- weapons ---------- */
+
+/* Index = weapon id stored on disk. Append new entries at the end only. */
+static const char *const weapon_names[] = {
+    "",
+    "knife", "ak47", "m4a1", "m4a1_silencer", "famas", "galilar", "aug",
+    "sg556", "awp", "ssg08", "g3sg1", "scar20", "deagle", "revolver",
+    "glock", "hkp2000", "usp_silencer", "p250", "fiveseven", "tec9",
+    "cz75a", "elite", "mp9", "mac10", "bizon", "ump45", "p90", "mp7",
+    "mp5sd", "negev", "m249", "nova", "mag7", "sawedoff", "xm1014",
+    "taser", "c4", "flashbang", "hegrenade", "smokegrenade", "molotov",
+    "incgrenade", "decoy", "healthshot",
+};
+#define NUM_WEAPONS (sizeof(weapon_names) / sizeof(weapon_names[0]))
+
+uint8_t stats_weapon_id(const char *name) {
+    if (!name || !name[0]) return 0;
+    if (strncmp(name, "weapon_", 7) == 0) name += 7;
+    /* All knife skins share one id */
+    if (strstr(name, "knife") || strstr(name, "bayonet")) return 1;
+    for (size_t i = 2; i < NUM_WEAPONS; i++)
+        if (strcmp(name, weapon_names[i]) == 0) return (uint8_t)i;
+    return 0;
+}
+
+const char *stats_weapon_name(uint8_t id) {
+    return id < NUM_WEAPONS ? weapon_names[id] : "";
+}
+
+/* ---------- writing ---------- */
+
+int64_t stats_wall_ns(void) {
+#ifdef _WIN32
+    /* FILETIME: 100ns units since 1601-01-01 */
+    FILETIME ft;
+    GetSystemTimeAsFileTime(&ft);
+    int64_t t = ((int64_t)ft.dwHighDateTime << 32) | ft.dwLowDateTime;
+    return (t - 116444736000000000LL) * 100;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+#endif
+}
+
+static bool header_valid(const StatsFileHeader *h) {
+    return memcmp(h->magic, STATS_STORE_MAGIC, 4) == 0 &&
+           h->version == STATS_STORE_VERSION &&
+           h->record_size == sizeof(StatsRecord);
+}
+
+/* Cut a file back to `size` bytes (a torn trailing entry) */
+static bool file_truncate(const char *path, long size) {
+    FILE *f = fopen(path, "r+b");
+    if (!f) return false;
+#ifdef _WIN32
+    bool ok = _chsize_s(_fileno(f), size) == 0;
+#else
+    bool ok = ftruncate(fileno(f), size) == 0;
+#endif
+    fclose(f);
+    return ok;
+}
+
+FILE *stats_store_open(const char *path, const char *idx_path,
+                       uint32_t *session_id) {
+    uint64_t records = 0;
+    long size = 0;
+
+    /* Validate an existing file before appending to it */
+    FILE *f = fopen(path, "rb");
+    if (f) {
+        StatsFileHeader h;
+        bool ok = fread(&h, sizeof(h), 1, f) == 1 && header_valid(&h);
+        fseek(f, 0, SEEK_END);
+        size = ftell(f);
+        fclose(f);
+        if (!ok && size > 0) {
+            fprintf(stderr, "[STATS] %s: not a v%d stats file, refusing to append\n",
+                    path, STATS_STORE_VERSION);
+            return NULL;
+        }
+        if (size > (long)sizeof(StatsFileHeader))
+            records = (uint64_t)(size - sizeof(StatsFileHeader)) / sizeof(StatsRecord);
+    }
+
+    /* The index must describe this file: sessions numbered in order, none
+     * starting past its last whole record */
+    long idx_size = 0, idx_whole = 0;
+    FILE *idx = fopen(idx_path, "rb");
+    if (idx) {
+        fseek(idx, 0, SEEK_END);
+        idx_size = ftell(idx);
+        idx_whole = idx_size - idx_size % (long)sizeof(StatsSession);
+        bool ok = true;
+        if (idx_whole > 0) {
+            StatsSession last;
+            fseek(idx, idx_whole - (long)sizeof(StatsSession), SEEK_SET);
+            ok = fread(&last, sizeof(last), 1, idx) == 1 &&
+                 last.id == (uint32_t)(idx_whole / (long)sizeof(StatsSession) - 1) &&
+                 last.first_record <= records;
+        }
+        fclose(idx);
+        if (!ok) {
+            fprintf(stderr, "[STATS] %s does not match %s (%llu records), refusing to append\n",
+                    idx_path, path, (unsigned long long)records);
+            return NULL;
+        }
+    }
+
+    /* A crash mid-write leaves a torn record or session entry; appending
+     * after it would misalign everything that follows */
+    long whole = (long)sizeof(StatsFileHeader) + (long)(records * sizeof(StatsRecord));
+    if (size > whole) {
+        fprintf(stderr, "[STATS] %s: dropping %ld bytes of a torn record\n", path, size - whole);
+        if (!file_truncate(path, whole)) return NULL;
+    }
+    if (idx_size > idx_whole && !file_truncate(idx_path, idx_whole)) return NULL;
+
+    f = fopen(path, "ab");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    if (ftell(f) == 0) {
+        StatsFileHeader h = {0};
+        memcpy(h.magic, STATS_STORE_MAGIC, 4);
+        h.version = STATS_STORE_VERSION;
+        h.record_size = sizeof(StatsRecord);
+        fwrite(&h, sizeof(h), 1, f);
+        fflush(f);
+    }
+
+    /* Register the session: id = number of sessions so far */
+    StatsSession s = {0};
+    s.start_ns = stats_wall_ns();
+    s.first_record = records;
+    idx = fopen(idx_path, "ab");
+    if (idx) {
+        fseek(idx, 0, SEEK_END);
+        s.id = (uint32_t)(ftell(idx) / (long)sizeof(StatsSession));
+        fwrite(&s, sizeof(s), 1, idx);
+        fclose(idx);
+    }
+    *session_id = s.id;
+    return f;
+}
+
+/* ---------- reading ---------- */
+
+bool stats_map_open(StatsMap *m, const char *path) {
+    memset(m, 0, sizeof(*m));
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                              NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart < (LONGLONG)sizeof(StatsFileHeader)) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    void *base = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (!base) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    m->file = file;
+    m->mapping = mapping;
+    m->size = (size_t)size.QuadPart;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(StatsFileHeader)) {
+        close(fd);
+        return false;
+    }
+    void *base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return false;
+    m->size = (size_t)st.st_size;
+#endif
+    m->base = base;
+
+    if (!header_valid((const StatsFileHeader *)base)) {
+        stats_map_close(m);
+        return false;
+    }
+    m->rec = (const StatsRecord *)((const char *)base + sizeof(StatsFileHeader));
+    m->count = (m->size - sizeof(StatsFileHeader)) / sizeof(StatsRecord);
+    return true;
+}
+
+void stats_map_close(StatsMap *m) {
+#ifdef _WIN32
+    if (m->base) UnmapViewOfFile(m->base);
+    if (m->mapping) CloseHandle(m->mapping);
+    if (m->file) CloseHandle(m->file);
+#else
+    if (m->base) munmap(m->base, m->size);
+#endif
+    memset(m, 0, sizeof(*m));
+}
+
+size_t stats_lower_bound(const StatsMap *m, int64_t ts) {
+    size_t lo = 0, hi = m->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (m->rec[mid].ts_ns < ts) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+size_t stats_index_load(const char *idx_path, StatsSession **out) {
+    *out = NULL;
+    FILE *f = fopen(idx_path, "rb");
+    if (!f) return 0;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    size_t n = size > 0 ? (size_t)size / sizeof(StatsSession) : 0;
+    if (n) {
+        *out = malloc(n * sizeof(StatsSession));
+        if (!*out || fread(*out, sizeof(StatsSession), n, f) != n) {
+            free(*out);
+            *out = NULL;
+            n = 0;
+        }
+    }
+    fclose(f);
+    return n;
+}
@@ -0,0 +1,108 @@
+/*
+ * stats_store.h - Binary append-only counter-strafe statistics store
+ *
+ * File layout (wooting-aim-stats.bin):
+ *   StatsFileHeader (16 bytes)
+ *   StatsRecord[]   (32 bytes each, appended, time-ordered)
+ *
+ * Session index (wooting-aim-stats.idx): StatsSession[] (24 bytes each),
+ * one entry appended per program run, pointing at its first record.
+ *
+ * All fields are little-endian, fixed-size and naturally aligned, so the
+ * record array can be memory-mapped and binary-searched by timestamp.
+ */
+
+#ifndef STATS_STORE_H
+#define STATS_STORE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define STATS_STORE_MAGIC   "WAST"
+#define STATS_STORE_VERSION 1
+
+#define STATS_AXIS_H 0
+#define STATS_AXIS_V 1
+
+typedef struct {
+    char     magic[4];       /* STATS_STORE_MAGIC */
+    uint16_t version;        /* STATS_STORE_VERSION */
+    uint16_t record_size;    /* sizeof(StatsRecord) */
+    uint32_t reserved[2];
+} StatsFileHeader;
+
+typedef struct {
+    int64_t  ts_ns;          /* end of counter-strafe, ns since Unix epoch (UTC) */
+    uint32_t session;        /* StatsSession.id of the run that wrote it */
+    float    counter_ms;     /* counter-strafe duration */
+    float    vel_start;      /* |axis velocity| when the counter-strafe began (u/s) */
+    float    ap_mm;          /* AP on the counter key */
+    float    rt_mm;          /* RT on the counter key */
+    uint8_t  axis;           /* STATS_AXIS_H / STATS_AXIS_V */
+    uint8_t  dir;            /* counter key: 'A', 'D', 'W', 'S' */
+    uint8_t  weapon_id;      /* index into stats_weapon_name() */
+    uint8_t  weapon_cat;     /* WeaponCategory at the time */
+} StatsRecord;
+
+typedef struct {
+    int64_t  start_ns;       /* session start, ns since Unix epoch (UTC) */
+    uint64_t first_record;   /* index of the session's first StatsRecord */
+    uint32_t id;
+    uint32_t reserved;
+} StatsSession;
+
+/* Read-only memory mapping of a stats file */
+typedef struct {
+    const StatsRecord *rec;
+    size_t count;
+    void  *base;
+    size_t size;
+    void  *file;             /* platform handles */
+    void  *mapping;
+} StatsMap;
+
+/* ---------- weapons ---------- */
+
+/*
+ * Stable weapon id for a GSI weapon name ("weapon_ak47" -> id).
+ * 0 means unknown/none. Ids are part of the file format: append only.
+ */
+uint8_t stats_weapon_id(const char *name);
+
+/* Weapon name for an id ("" for unknown). */
+const char *stats_weapon_name(uint8_t id);
+
+/* ---------- writing ---------- */
+
+/* Wall clock, ns since Unix epoch (UTC). */
+int64_t stats_wall_ns(void);
+
+/*
+ * Open `path` for appending records and register a new session in
+ * `idx_path`. Writes the file header if the file is new, refuses files
+ * with a different magic/version/record size and an index whose sessions
+ * don't fit the records. A torn trailing record or index entry (crash
+ * mid-write) is truncated away first.
+ * Returns the FILE* (positioned at end) or NULL; fills *session_id.
+ */
+FILE *stats_store_open(const char *path, const char *idx_path,
+                       uint32_t *session_id);
+
+/* ---------- reading ---------- */
+
+/* Map a stats file read-only. Returns false on error or bad header. */
+bool stats_map_open(StatsMap *m, const char *path);
+void stats_map_close(StatsMap *m);
+
+/* First record with ts_ns >= ts (binary search), m->count if none. */
+size_t stats_lower_bound(const StatsMap *m, int64_t ts);
+
+/*
+ * Load the session index. Returns the number of sessions (0 if missing),
+ * *out is malloc'd (caller frees).
+ */
+size_t stats_index_load(const char *idx_path, StatsSession **out);
+
+#endif /* STATS_STORE_H */
@@ -0,0 +1,774 @@
+/*
+ * sweep.c - Parameter search over recorded traces
+ *
+ * Compiles main.c into this file (main renamed, as bench.c does), so each
+ * candidate runs the real axis_update / vel_update / update_targets over
+ * every trace: the recorded key depths, crouch, weapon and round phase go
+ * in, the AP/RT the engine would have written come out. Those feed the
+ * actuation model (actuation.c) against the static profile, and each
+ * candidate is scored per counter-strafe:
+ *
+ *   score = mean shootable gain (ms)
+ *         - ghost_cost * ghost presses - write_cost * HID writes
+ *
+ * Any numeric config key can be a parameter (ap_aggro, predict_threshold,
+ * predict_min_peak, phase_ultra_ms, rifle_ap, ...). --grid tries every
+ * combination of the given steps; --bayes N spends N candidates on a
+ * tree-structured Parzen estimator: a random first round, then batches
+ * drawn where good candidates are dense and poor ones are not.
+ *
+ * Each round is (candidate, trace) tasks on a work-stealing pool, one
+ * worker per core: a worker pops its own deque from the bottom and, once
+ * empty, steals from the top of another's. Trace lengths differ by orders
+ * of magnitude, so a static split would leave cores idle at the end.
+ *
+ * Usage: sweep [--config FILE] [--ap MM] [--rt MM] [--latency MS]
+ *              --param KEY=LO:HI[:STEPS] ... [--grid | --bayes N]
+ *              [--ghost-cost MS] [--write-cost MS] [--threads N]
+ *              [--top N] [--seed N] [--csv] trace.watrace ...
+ */
+
+#define main wooting_aim_main
+#include "main.c"
+#undef main
+#include "actuation.h"
+
+#define SWEEP_FREQ         1e9          /* traces are rebased to ns */
+#define SWEEP_MAX_TRACES   1024
+#define SWEEP_MAX_PARAMS   16
+#define SWEEP_MAX_THREADS  64
+#define SWEEP_MAX_GRID     (1u << 20)
+#define SWEEP_DEF_STEPS    5
+
+/* Tree-structured Parzen estimator */
+#define TPE_GAMMA          0.2          /* best fraction modelled as "good" */
+#define TPE_DRAWS          64           /* draws from the good model per candidate */
+#define TPE_MIN_BW         0.02         /* kernel width floor, fraction of the range */
+#define TPE_MIN_BATCH      16
+
+/* ---------- traces ---------- */
+
+static const char *const sweep_phases[] = { "", "live", "freezetime", "over" };
+
+/* What the engine reads from one recorded frame */
+typedef struct {
+    int64_t ticks;                 /* ns since the trace started */
+    float   w, a, s, d, ctrl;
+    float   weapon_speed;          /* max speed the engine assumed */
+    uint8_t weapon_cat;
+    uint8_t phase;                 /* sweep_phases[] */
+    bool    gsi;
+} SweepFrame;
+
+typedef struct {
+    const char *path;
+    SweepFrame *f;
+    size_t n;
+    double minutes;
+    ActRun *base;                  /* static profile: the same for every candidate */
+} SweepTrace;
+
+static bool sweep_load(SweepTrace *t, const char *path) {
+    TraceFile tf;
+    if (!trace_open(&tf, path)) {
+        fprintf(stderr, "Cannot open trace: %s\n", path);
+        return false;
+    }
+    size_t cap = tf.hdr.frames ? (size_t)tf.hdr.frames : 4096;
+    t->path = path;
+    t->n = 0;
+    t->f = malloc(cap * sizeof(*t->f));
+    double to_ns = SWEEP_FREQ / (double)tf.hdr.tick_freq;
+    int64_t t0 = 0;
+    TelemetryFrame fr;
+    while (t->f && trace_read(&tf, &fr)) {
+        if (t->n == cap) {
+            cap *= 2;
+            SweepFrame *nf = realloc(t->f, cap * sizeof(*nf));
+            if (!nf) { free(t->f); t->f = NULL; break; }
+            t->f = nf;
+        }
+        if (t->n == 0) t0 = fr.ticks;
+        SweepFrame *s = &t->f[t->n++];
+        s->ticks = (int64_t)((double)(fr.ticks - t0) * to_ns);
+        s->w = fr.w; s->a = fr.a; s->s = fr.s; s->d = fr.d; s->ctrl = fr.ctrl;
+        s->weapon_speed = fr.vel_threshold > 0 ? fr.vel_threshold / 0.34f : 0.0f;
+        s->weapon_cat = fr.weapon_cat < WCAT_COUNT ? fr.weapon_cat : WCAT_OTHER;
+        s->gsi = (fr.flags & TF_GSI) != 0;
+        s->phase = 0;
+        for (uint8_t p = 1; p < sizeof(sweep_phases) / sizeof(sweep_phases[0]); p++)
+            if (strncmp(fr.round_phase, sweep_phases[p], sizeof(fr.round_phase)) == 0)
+                s->phase = p;
+    }
+    trace_close(&tf);
+    if (!t->f) {
+        fprintf(stderr, "Out of memory reading %s\n", path);
+        return false;
+    }
+    t->minutes = t->n ? (double)t->f[t->n - 1].ticks / SWEEP_FREQ / 60.0 : 0.0;
+    return true;
+}
+
+/* ---------- parameters and candidates ---------- */
+
+typedef struct {
+    const CfgField *field;
+    float lo, hi;
+    int steps;
+} SweepParam;
+
+/* One candidate on one trace; summed over traces per candidate */
+typedef struct {
+    uint64_t strafes, shootable_n;
+    double   release_sum, press_sum, shootable_sum;
+    uint64_t writes, ghost;
+} SweepPart;
+
+typedef struct {
+    float     x[SWEEP_MAX_PARAMS];     /* parameter values */
+    SweepPart tot;
+    double    score;
+} SweepCand;
+
+static SweepParam g_params[SWEEP_MAX_PARAMS];
+static int g_num_params;
+static Config g_base;
+static ActOptions g_opt;
+static double g_ghost_cost = 10.0, g_write_cost = 0.1;
+
+static bool sweep_param_parse(const char *spec) {
+    char key[CFG_NAME_LEN];
+    const char *eq = strchr(spec, '=');
+    if (!eq || (size_t)(eq - spec) >= sizeof(key)) return false;
+    memcpy(key, spec, (size_t)(eq - spec));
+    key[eq - spec] = '\0';
+
+    const CfgField *f = config_find(key);
+    if (!f || (f->type != CFG_FLOAT && f->type != CFG_INT && f->type != CFG_BOOL) ||
+        (f->flags & CFG_RESTART)) {
+        fprintf(stderr, "Not a tunable number: %s\n", key);
+        return false;
+    }
+    SweepParam p = { f, 0, 0, SWEEP_DEF_STEPS };
+    int n = sscanf(eq + 1, "%f:%f:%d", &p.lo, &p.hi, &p.steps);
+    if (n < 2 || p.hi < p.lo || p.steps < 1) return false;
+    if (p.lo < f->min) p.lo = f->min;
+    if (p.hi > f->max) p.hi = f->max;
+    if (g_num_params == SWEEP_MAX_PARAMS) return false;
+    g_params[g_num_params++] = p;
+    return true;
+}
+
+static float sweep_param_get(const Config *c, const SweepParam *p) {
+    const char *at = (const char *)c + p->field->offset;
+    switch (p->field->type) {
+    case CFG_INT:  return (float)*(const int *)at;
+    case CFG_BOOL: return *(const bool *)at ? 1.0f : 0.0f;
+    default:       return *(const float *)at;
+    }
+}
+
+static void sweep_param_set(Config *c, const SweepParam *p, float v) {
+    char *at = (char *)c + p->field->offset;
+    switch (p->field->type) {
+    case CFG_INT:  *(int *)at = (int)lroundf(v); break;
+    case CFG_BOOL: *(bool *)at = v >= 0.5f; break;
+    default:       *(float *)at = v; break;
+    }
+}
+
+static void sweep_config(const SweepCand *cand, Config *c) {
+    *c = g_base;
+    for (int i = 0; i < g_num_params; i++) sweep_param_set(c, &g_params[i], cand->x[i]);
+    config_compile(c, SWEEP_FREQ);
+}
+
+/* ---------- replay ---------- */
+
+typedef struct {
+    PlatMutex lock;
+    uint32_t *tasks;               /* cand * num_traces + trace */
+    size_t top, bottom;            /* thieves take tasks[top], the owner tasks[bottom - 1] */
+
+    PlatThread thread;
+    uint64_t rng;
+    ActFrame *frames;              /* longest trace */
+    AimContext ctx;
+    uint64_t replayed, steals;
+} SweepWorker;
+
+static struct {
+    SweepTrace traces[SWEEP_MAX_TRACES];
+    int num_traces;
+    size_t max_frames;
+    SweepWorker *workers;
+    int num_workers;
+    const SweepCand *cands;        /* this round */
+    SweepPart *parts;              /* [cand * num_traces + trace] */
+    atomic_bool oom;
+} g_sw;
+
+/* Depths, time and speed of a frame; AP/RT and states are the caller's */
+static void sweep_act_frame(const SweepFrame *f, ActFrame *a) {
+    a->t_ms = (double)f->ticks / 1e6;
+    a->depth[0] = f->w; a->depth[1] = f->a; a->depth[2] = f->s; a->depth[3] = f->d;
+    a->max_speed = f->weapon_speed > 0 ? f->weapon_speed : 225.0f;
+}
+
+/* The engine half of session_frame(), fed from a trace instead of the SDK */
+static void sweep_replay(SweepWorker *w, const SweepTrace *t, const Config *cfg,
+                         SweepPart *out) {
+    AimContext *ctx = &w->ctx;
+    memset(ctx, 0, sizeof(*ctx));
+    for (int i = 0; i < MAX_KEYS; i++) {
+        ctx->current_ap[i] = ctx->target_ap[i] = cfg->ap_normal;
+        ctx->current_rt[i] = ctx->target_rt[i] = cfg->rt_normal;
+    }
+    ctx->vel_h.max_speed = ctx->vel_v.max_speed = 225.0f;
+    int64_t vel_timer = 0;
+    int phase = -1;
+
+    for (size_t i = 0; i < t->n; i++) {
+        const SweepFrame *f = &t->f[i];
+        int64_t now = f->ticks;
+        ctx->prev_w = ctx->w; ctx->prev_a = ctx->a;
+        ctx->prev_s = ctx->s; ctx->prev_d = ctx->d;
+        ctx->w = f->w; ctx->a = f->a; ctx->s = f->s; ctx->d = f->d;
+        ctx->ctrl = f->ctrl;
+        ctx->crouching = ctx->ctrl > DEAD_ZONE;
+        ctx->gsi_active = f->gsi;
+        ctx->weapon_cat = (WeaponCategory)f->weapon_cat;
+        ctx->weapon_speed = f->weapon_speed;
+        if (f->phase != phase) {
+            phase = f->phase;
+            snprintf(ctx->round_phase, sizeof(ctx->round_phase), "%s", sweep_phases[phase]);
+        }
+
+        axis_update(&ctx->h, cfg, ctx->d, ctx->a, ctx->prev_d, ctx->prev_a, now, SWEEP_FREQ);
+        axis_update(&ctx->v, cfg, ctx->w, ctx->s, ctx->prev_w, ctx->prev_s, now, SWEEP_FREQ);
+
+        float max_spd = ctx->weapon_speed > 0 ? ctx->weapon_speed : 225.0f;
+        if (cfg->vel_enabled && (double)(now - vel_timer) * 1000.0 / SWEEP_FREQ >= 1.0) {
+            vel_update(&ctx->vel_h, ctx->d, ctx->a, max_spd, now, SWEEP_FREQ);
+            vel_update(&ctx->vel_v, ctx->w, ctx->s, max_spd, now, SWEEP_FREQ);
+            vel_timer = now;
+        }
+
+        update_targets(ctx, cfg);
+
+        /* do_write(), with the writer thread taking every batch */
+        if (ctx->needs_write && now - ctx->last_write_time >= cfg->write_interval_ticks) {
+            memcpy(ctx->current_ap, ctx->target_ap, (size_t)g_key_count * sizeof(float));
+            memcpy(ctx->current_rt, ctx->target_rt, (size_t)g_key_count * sizeof(float));
+            ctx->needs_write = false;
+            ctx->last_write_time = now;
+            ctx->write_count++;
+        }
+
+        ActFrame *a = &w->frames[i];
+        sweep_act_frame(f, a);
+        memcpy(a->ap, ctx->current_ap, sizeof(a->ap));
+        memcpy(a->rt, ctx->current_rt, sizeof(a->rt));
+        a->h_state = (uint8_t)ctx->h.state;
+        a->v_state = (uint8_t)ctx->v.state;
+    }
+
+    ActResult r;
+    if (!act_simulate_with(w->frames, t->n, &g_opt, t->base, &r)) {
+        atomic_store(&g_sw.oom, true);
+        return;
+    }
+    out->strafes = r.count;
+    for (size_t i = 0; i < r.count; i++) {
+        const ActStrafe *s = &r.strafes[i];
+        out->release_sum += s->release_ms;
+        out->press_sum += s->press_ms;
+        if (!isnan(s->shootable_ms)) {
+            out->shootable_sum += s->shootable_ms;
+            out->shootable_n++;
+        }
+    }
+    out->writes = ctx->write_count;
+    out->ghost = r.ghost_presses;
+    act_result_free(&r);
+    w->replayed += t->n;
+}
+
+/* ---------- work-stealing pool ---------- */
+
+static bool sweep_pop(SweepWorker *w, uint32_t *task) {
+    plat_mutex_lock(&w->lock);
+    bool ok = w->bottom > w->top;
+    if (ok) *task = w->tasks[--w->bottom];
+    plat_mutex_unlock(&w->lock);
+    return ok;
+}
+
+static bool sweep_steal(SweepWorker *w, uint32_t *task) {
+    w->rng ^= w->rng << 13; w->rng ^= w->rng >> 7; w->rng ^= w->rng << 17;
+    int start = (int)(w->rng % (uint64_t)g_sw.num_workers);
+    for (int k = 0; k < g_sw.num_workers; k++) {
+        SweepWorker *v = &g_sw.workers[(start + k) % g_sw.num_workers];
+        if (v == w) continue;
+        plat_mutex_lock(&v->lock);
+        bool ok = v->bottom > v->top;
+        if (ok) *task = v->tasks[v->top++];
+        plat_mutex_unlock(&v->lock);
+        if (ok) {
+            w->steals++;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Tasks never spawn tasks: one empty pass over every deque ends the round */
+static void sweep_worker(void *param) {
+    SweepWorker *w = param;
+    uint32_t task;
+    while (sweep_pop(w, &task) || sweep_steal(w, &task)) {
+        if (atomic_load_explicit(&g_sw.oom, memory_order_relaxed)) continue;
+        uint32_t cand = task / (uint32_t)g_sw.num_traces;
+        uint32_t trace = task % (uint32_t)g_sw.num_traces;
+        Config cfg;
+        sweep_config(&g_sw.cands[cand], &cfg);
+        sweep_replay(w, &g_sw.traces[trace], &cfg, &g_sw.parts[task]);
+    }
+}
+
+static double sweep_score(const SweepPart *p) {
+    if (!p->shootable_n) return -HUGE_VAL;
+    return p->shootable_sum / (double)p->shootable_n -
+           (g_ghost_cost * (double)p->ghost + g_write_cost * (double)p->writes) /
+           (double)p->strafes;
+}
+
+/* Score `count` candidates; false on allocation failure */
+static bool sweep_round(SweepCand *cands, size_t count) {
+    size_t tasks = count * (size_t)g_sw.num_traces;
+    g_sw.cands = cands;
+    g_sw.parts = calloc(tasks, sizeof(SweepPart));
+    if (!g_sw.parts) return false;
+
+    /* Contiguous blocks: a worker's own tasks share traces and candidates */
+    for (int i = 0; i < g_sw.num_workers; i++) {
+        SweepWorker *w = &g_sw.workers[i];
+        w->top = tasks * (size_t)i / (size_t)g_sw.num_workers;
+        w->bottom = tasks * (size_t)(i + 1) / (size_t)g_sw.num_workers;
+        for (size_t t = w->top; t < w->bottom; t++) w->tasks[t] = (uint32_t)t;
+    }
+    for (int i = 1; i < g_sw.num_workers; i++) {
+        SweepWorker *w = &g_sw.workers[i];
+        if (!plat_thread_start(&w->thread, sweep_worker, w, PLAT_PRIO_NORMAL))
+            w->thread.started = false;      /* its tasks get stolen */
+    }
+    sweep_worker(&g_sw.workers[0]);
+    for (int i = 1; i < g_sw.num_workers; i++) plat_thread_join(&g_sw.workers[i].thread, -1);
+
+    for (size_t c = 0; c < count; c++) {
+        SweepPart *tot = &cands[c].tot;
+        memset(tot, 0, sizeof(*tot));
+        for (int t = 0; t < g_sw.num_traces; t++) {
+            const SweepPart *p = &g_sw.parts[c * (size_t)g_sw.num_traces + (size_t)t];
+            tot->strafes += p->strafes;
+            tot->shootable_n += p->shootable_n;
+            tot->release_sum += p->release_sum;
+            tot->press_sum += p->press_sum;
+            tot->shootable_sum += p->shootable_sum;
+            tot->writes += p->writes;
+            tot->ghost += p->ghost;
+        }
+        cands[c].score = sweep_score(tot);
+    }
+    free(g_sw.parts);
+    g_sw.parts = NULL;
+    return !atomic_load(&g_sw.oom);
+}
+
+/* ---------- search ---------- */
+
+static uint64_t g_rng = 0x9E3779B97F4A7C15ull;
+
+static double rand01(void) {
+    g_rng ^= g_rng << 13; g_rng ^= g_rng >> 7; g_rng ^= g_rng << 17;
+    return (double)(g_rng >> 11) / 9007199254740992.0;
+}
+
+static double rand_normal(void) {
+    double u = rand01(), v = rand01();
+    if (u < 1e-300) u = 1e-300;
+    return sqrt(-2.0 * log(u)) * cos(6.283185307179586 * v);
+}
+
+/* Floats to 0.01 (mm or ms), as a config file would write them */
+static float unit_to_value(const SweepParam *p, double u) {
+    double v = p->lo + u * (p->hi - p->lo);
+    return p->field->type == CFG_FLOAT ? (float)(round(v * 100.0) / 100.0) : (float)lround(v);
+}
+
+static double value_to_unit(const SweepParam *p, float v) {
+    return p->hi > p->lo ? (double)(v - p->lo) / (double)(p->hi - p->lo) : 0.0;
+}
+
+/* Every combination of the parameters' steps */
+static size_t grid_fill(SweepCand *out) {
+    size_t count = 1;
+    for (int i = 0; i < g_num_params; i++) count *= (size_t)g_params[i].steps;
+    for (size_t c = 0; c < count; c++) {
+        size_t rest = c;
+        for (int i = 0; i < g_num_params; i++) {
+            const SweepParam *p = &g_params[i];
+            int k = (int)(rest % (size_t)p->steps);
+            rest /= (size_t)p->steps;
+            out[c].x[i] = unit_to_value(p, p->steps > 1 ? (double)k / (p->steps - 1) : 0.0);
+        }
+    }
+    return count;
+}
+
+/* Per-dimension Parzen density of u over `set`, Gaussian kernels of width bw */
+static double tpe_density(const double *u, const double (*set)[SWEEP_MAX_PARAMS],
+                          size_t n, const double *bw) {
+    double sum = 0;
+    for (size_t k = 0; k < n; k++) {
+        double e = 0;
+        for (int i = 0; i < g_num_params; i++) {
+            double z = (u[i] - set[k][i]) / bw[i];
+            e += z * z;
+        }
+        sum += exp(-0.5 * e);
+    }
+    double norm = 1;
+    for (int i = 0; i < g_num_params; i++) norm *= bw[i];
+    return sum / (double)n / norm + 1e-300;
+}
+
+static void tpe_bandwidth(const double (*set)[SWEEP_MAX_PARAMS], size_t n, double *bw) {
+    for (int i = 0; i < g_num_params; i++) {
+        double mean = 0, var = 0;
+        for (size_t k = 0; k < n; k++) mean += set[k][i];
+        mean /= (double)n;
+        for (size_t k = 0; k < n; k++) var += (set[k][i] - mean) * (set[k][i] - mean);
+        /* Scott's rule */
+        bw[i] = 1.06 * sqrt(var / (double)n) * pow((double)n, -1.0 / (g_num_params + 4));
+        if (bw[i] < TPE_MIN_BW) bw[i] = TPE_MIN_BW;
+    }
+}
+
+static int cmp_score_desc(const void *a, const void *b) {
+    double x = ((const SweepCand *)a)->score, y = ((const SweepCand *)b)->score;
+    return (x < y) - (x > y);
+}
+
+static bool cand_same(const SweepCand *a, const SweepCand *b) {
+    return memcmp(a->x, b->x, (size_t)g_num_params * sizeof(float)) == 0;
+}
+
+/*
+ * Next batch from the candidates scored so far: split them at TPE_GAMMA
+ * into good and poor, draw from the good density and keep the draw where
+ * good/poor is highest. A draw that rounds to a candidate already tried is
+ * replaced by a uniform one rather than scored twice.
+ */
+static bool tpe_propose(const SweepCand *seen, size_t n_seen, SweepCand *out, size_t count) {
+    SweepCand *sorted = malloc(n_seen * sizeof(*sorted));
+    double (*u)[SWEEP_MAX_PARAMS] = malloc(n_seen * sizeof(*u));
+    if (!sorted || !u) { free(sorted); free(u); return false; }
+    memcpy(sorted, seen, n_seen * sizeof(*sorted));
+    qsort(sorted, n_seen, sizeof(*sorted), cmp_score_desc);
+    for (size_t k = 0; k < n_seen; k++)
+        for (int i = 0; i < g_num_params; i++) u[k][i] = value_to_unit(&g_params[i], sorted[k].x[i]);
+
+    size_t n_good = (size_t)ceil(TPE_GAMMA * (double)n_seen);
+    if (n_good < 2) n_good = 2;
+    if (n_good > n_seen - 1) n_good = n_seen - 1;
+    double bw_good[SWEEP_MAX_PARAMS], bw_poor[SWEEP_MAX_PARAMS];
+    tpe_bandwidth(u, n_good, bw_good);
+    tpe_bandwidth(u + n_good, n_seen - n_good, bw_poor);
+
+    for (size_t c = 0; c < count; c++) {
+        double best[SWEEP_MAX_PARAMS], best_ratio = -1;
+        for (int d = 0; d < TPE_DRAWS; d++) {
+            const double *centre = u[(size_t)(rand01() * (double)n_good) % n_good];
+            double x[SWEEP_MAX_PARAMS];
+            for (int i = 0; i < g_num_params; i++) {
+                int tries = 0;
+                do x[i] = centre[i] + rand_normal() * bw_good[i];
+                while ((x[i] < 0 || x[i] > 1) && ++tries < 8);
+                if (x[i] < 0) x[i] = 0;
+                if (x[i] > 1) x[i] = 1;
+            }
+            double ratio = tpe_density(x, u, n_good, bw_good) /
+                           tpe_density(x, u + n_good, n_seen - n_good, bw_poor);
+            if (ratio > best_ratio) {
+                best_ratio = ratio;
+                memcpy(best, x, sizeof(best));
+            }
+        }
+        for (int i = 0; i < g_num_params; i++) out[c].x[i] = unit_to_value(&g_params[i], best[i]);
+
+        bool dup = false;
+        for (size_t k = 0; k < n_seen + c && !dup; k++)
+            dup = cand_same(k < n_seen ? &seen[k] : &out[k - n_seen], &out[c]);
+        if (dup)
+            for (int i = 0; i < g_num_params; i++)
+                out[c].x[i] = unit_to_value(&g_params[i], rand01());
+    }
+    free(sorted);
+    free(u);
+    return true;
+}
+
+/* ---------- report ---------- */
+
+static int param_width(const SweepParam *p) {
+    int w = (int)strlen(p->field->key);
+    return w > 8 ? w : 8;
+}
+
+static void print_cand(const char *label, const SweepCand *c, double minutes) {
+    const SweepPart *t = &c->tot;
+    if (!t->shootable_n) {
+        printf("%-8s %8s  no counter-strafes reached 34%% speed in both runs\n", label, "-");
+        return;
+    }
+    printf("%-8s %+8.2f %+7.2f %+8.2f %+7.2f %8.1f %8.2f ", label, c->score,
+           t->shootable_sum / (double)t->shootable_n, t->release_sum / (double)t->strafes,
+           t->press_sum / (double)t->strafes, (double)t->writes / minutes,
+           (double)t->ghost / minutes);
+    for (int i = 0; i < g_num_params; i++) printf(" %*g", param_width(&g_params[i]), c->x[i]);
+    printf("\n");
+}
+
+static void print_csv(const SweepCand *c, double minutes, bool current) {
+    const SweepPart *t = &c->tot;
+    printf("%s,%.4f,%.3f,%.3f,%.3f,%.2f,%.3f,%llu", current ? "current" : "",
+           t->shootable_n ? c->score : NAN,
+           t->shootable_n ? t->shootable_sum / (double)t->shootable_n : NAN,
+           t->strafes ? t->release_sum / (double)t->strafes : NAN,
+           t->strafes ? t->press_sum / (double)t->strafes : NAN,
+           (double)t->writes / minutes, (double)t->ghost / minutes,
+           (unsigned long long)t->strafes);
+    for (int i = 0; i < g_num_params; i++) printf(",%g", c->x[i]);
+    printf("\n");
+}
+
+static void sweep_usage(void) {
+    printf("Usage: sweep [--config FILE] [--ap MM] [--rt MM] [--latency MS]\n"
+           "             --param KEY=LO:HI[:STEPS] ... [--grid | --bayes N]\n"
+           "             [--ghost-cost MS] [--write-cost MS] [--threads N]\n"
+           "             [--top N] [--seed N] [--csv] trace.watrace ...\n"
+           "  --config FILE    engine settings not swept; static profile = ap_normal/rt_normal\n"
+           "  --ap, --rt       static profile AP/RT in mm\n"
+           "  --latency MS     delay before the engine's AP/RT reaches the firmware\n"
+           "  --param          numeric config key and range (STEPS for --grid, default %d)\n"
+           "  --grid           every combination (default)\n"
+           "  --bayes N        N candidates, tree-structured Parzen estimator\n"
+           "  --ghost-cost MS  score lost per ghost press (default 10)\n"
+           "  --write-cost MS  score lost per HID write (default 0.1)\n"
+           "  --csv            every candidate, one line each\n", SWEEP_DEF_STEPS);
+}
+
+int main(int argc, char *argv[]) {
+    config_defaults(&g_base);
+    float ap = -1.0f, rt = -1.0f;
+    int threads = 0, top = 10;
+    size_t bayes = 0;
+    bool csv = false;
+    const char *paths[SWEEP_MAX_TRACES];
+    int num_paths = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--config") == 0 && i + 1 < argc) {
+            const char *path = argv[++i];
+            if (!plat_path_exists(path)) { fprintf(stderr, "Cannot open config: %s\n", path); return 1; }
+            if (config_parse_file(&g_base, path, NULL) != 0) return 1;
+        } else if (strcmp(argv[i], "--ap") == 0 && i + 1 < argc) ap = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--rt") == 0 && i + 1 < argc) rt = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--latency") == 0 && i + 1 < argc)
+            g_opt.write_latency_ms = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--param") == 0 && i + 1 < argc) {
+            if (!sweep_param_parse(argv[++i])) {
+                fprintf(stderr, "Bad --param: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--grid") == 0) bayes = 0;
+        else if (strcmp(argv[i], "--bayes") == 0 && i + 1 < argc) bayes = (size_t)atol(argv[++i]);
+        else if (strcmp(argv[i], "--ghost-cost") == 0 && i + 1 < argc) g_ghost_cost = atof(argv[++i]);
+        else if (strcmp(argv[i], "--write-cost") == 0 && i + 1 < argc) g_write_cost = atof(argv[++i]);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--top") == 0 && i + 1 < argc) top = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            g_rng ^= (uint64_t)strtoull(argv[++i], NULL, 10) * 0x2545F4914F6CDD1Dull;
+        else if (strcmp(argv[i], "--csv") == 0) csv = true;
+        else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) { sweep_usage(); return 0; }
+        else if (argv[i][0] == '-') { sweep_usage(); return 1; }
+        else if (num_paths < SWEEP_MAX_TRACES) paths[num_paths++] = argv[i];
+    }
+    g_opt.base_ap = ap >= 0.0f ? ap : g_base.ap_normal;
+    g_opt.base_rt = rt >= 0.0f ? rt : g_base.rt_normal;
+    if (num_paths == 0 || g_num_params == 0 || g_opt.base_ap < 0.1f || g_opt.base_ap > 4.0f ||
+        g_opt.base_rt < 0.0f || g_opt.base_rt > 4.0f || g_opt.write_latency_ms < 0.0f) {
+        sweep_usage();
+        return 1;
+    }
+
+    size_t grid = 1;
+    for (int i = 0; i < g_num_params && grid <= SWEEP_MAX_GRID; i++) grid *= (size_t)g_params[i].steps;
+    size_t total = bayes ? bayes : grid;
+    if (total > SWEEP_MAX_GRID) {
+        fprintf(stderr, "%zu candidates; at most %u\n", total, SWEEP_MAX_GRID);
+        return 1;
+    }
+
+    /* Traces stay in memory for the whole search */
+    double minutes = 0;
+    size_t frames = 0;
+    for (int p = 0; p < num_paths; p++) {
+        SweepTrace *t = &g_sw.traces[g_sw.num_traces];
+        if (!sweep_load(t, paths[p])) return 1;
+        if (t->n == 0) { free(t->f); continue; }
+        minutes += t->minutes;
+        frames += t->n;
+        if (t->n > g_sw.max_frames) g_sw.max_frames = t->n;
+        g_sw.num_traces++;
+    }
+    if (g_sw.num_traces == 0 || minutes <= 0) {
+        fprintf(stderr, "No frames in the traces\n");
+        return 1;
+    }
+
+    /* Round size bounds the task lists: the grid at once, TPE in batches */
+    if (threads <= 0) {
+        uint64_t mask = thread_cpus_available();
+        while (mask) { threads++; mask &= mask - 1; }
+    }
+    if (threads < 1) threads = 1;
+    if (threads > SWEEP_MAX_THREADS) threads = SWEEP_MAX_THREADS;
+    size_t batch = (size_t)threads * 4 > TPE_MIN_BATCH ? (size_t)threads * 4 : TPE_MIN_BATCH;
+    size_t init = (size_t)g_num_params * 10 > batch ? (size_t)g_num_params * 10 : batch;
+    size_t round_max = bayes ? (init > batch ? init : batch) : grid;
+    if (round_max > total) round_max = total;
+    if ((round_max + 1) * (size_t)g_sw.num_traces > UINT32_MAX) {
+        fprintf(stderr, "Too many candidates x traces\n");
+        return 1;
+    }
+
+    g_sw.num_workers = threads;
+    g_sw.workers = calloc((size_t)threads, sizeof(SweepWorker));
+    SweepCand *cands = calloc(total + 1, sizeof(SweepCand));
+    if (!g_sw.workers || !cands) { fprintf(stderr, "Out of memory\n"); return 1; }
+    for (int i = 0; i < threads; i++) {
+        SweepWorker *w = &g_sw.workers[i];
+        plat_mutex_init(&w->lock);
+        w->rng = 0x9E3779B97F4A7C15ull * (uint64_t)(i + 1);
+        w->tasks = malloc((round_max + 1) * (size_t)g_sw.num_traces * sizeof(uint32_t));
+        w->frames = malloc(g_sw.max_frames * sizeof(ActFrame));
+        if (!w->tasks || !w->frames) { fprintf(stderr, "Out of memory\n"); return 1; }
+    }
+
+    for (int t = 0; t < g_sw.num_traces; t++) {
+        SweepTrace *tr = &g_sw.traces[t];
+        ActFrame *af = g_sw.workers[0].frames;
+        for (size_t i = 0; i < tr->n; i++) sweep_act_frame(&tr->f[i], &af[i]);
+        tr->base = act_run_static(af, tr->n, &g_opt);
+        if (!tr->base) {
+            fprintf(stderr, "Cannot simulate %s: out of memory or frames out of order\n",
+                    tr->path);
+            return 1;
+        }
+    }
+
+    /* cands[0] is the config as given; the search fills the rest */
+    SweepCand *current = &cands[0], *search = &cands[1];
+    for (int i = 0; i < g_num_params; i++) current->x[i] = sweep_param_get(&g_base, &g_params[i]);
+
+    if (!csv) {
+        printf("Traces: %d, %zu frames, %.1f min   Threads: %d\n", g_sw.num_traces, frames,
+               minutes, threads);
+        printf("Static profile: AP %.2f mm  RT %.2f mm   write latency %.1f ms\n",
+               g_opt.base_ap, g_opt.base_rt, g_opt.write_latency_ms);
+        printf("Search: %s, %zu candidates over", bayes ? "bayes (TPE)" : "grid", total);
+        for (int i = 0; i < g_num_params; i++)
+            printf(" %s %g..%g", g_params[i].field->key, g_params[i].lo, g_params[i].hi);
+        printf("\n\n");
+    }
+
+    int64_t t0 = plat_ticks();
+    double freq = (double)plat_tick_freq();
+    size_t done = 0;
+    int round = 0;
+    bool ok = true;
+    while (ok && done < total) {
+        size_t n;
+        SweepCand *next = search + done;
+        if (!bayes) {
+            n = grid_fill(next);
+        } else if (done == 0) {
+            n = init < total ? init : total;
+            for (size_t c = 0; c < n; c++)
+                for (int i = 0; i < g_num_params; i++)
+                    next[c].x[i] = unit_to_value(&g_params[i], rand01());
+        } else {
+            n = total - done < batch ? total - done : batch;
+            ok = tpe_propose(search, done, next, n);
+            if (!ok) break;
+        }
+        /* The current config rides along in the first round */
+        ok = round == 0 ? sweep_round(current, n + 1) : sweep_round(next, n);
+        done += n;
+        round++;
+        if (!csv && bayes && (done * 10 / total != (done - n) * 10 / total || done == total)) {
+            SweepCand *best = search;
+            for (size_t c = 1; c < done; c++) if (search[c].score > best->score) best = &search[c];
+            printf("Round %d: %zu/%zu candidates, best score %+.2f (%.1f s)\n", round, done,
+                   total, best->score, (double)(plat_ticks() - t0) / freq);
+        }
+    }
+    if (!ok) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    double secs = (double)(plat_ticks() - t0) / freq;
+
+    uint64_t replayed = 0, steals = 0;
+    for (int i = 0; i < threads; i++) {
+        replayed += g_sw.workers[i].replayed;
+        steals += g_sw.workers[i].steals;
+    }
+    qsort(search, total, sizeof(SweepCand), cmp_score_desc);
+
+    if (csv) {
+        printf("candidate,score,shootable_ms,release_ms,press_ms,writes_per_min,ghost_per_min,strafes");
+        for (int i = 0; i < g_num_params; i++) printf(",%s", g_params[i].field->key);
+        printf("\n");
+        print_csv(current, minutes, true);
+        for (size_t c = 0; c < total; c++) print_csv(&search[c], minutes, false);
+        return 0;
+    }
+
+    if (bayes) printf("\n");
+    printf("%zu candidates x %d traces in %.1f s (%.1f M frames/s, %llu tasks stolen)\n\n",
+           total + 1, g_sw.num_traces, secs, secs > 0 ? (double)replayed / secs / 1e6 : 0.0,
+           (unsigned long long)steals);
+    printf("score = shootable gain - %g ms/ghost press - %g ms/write, per counter-strafe "
+           "(%llu of them)\n", g_ghost_cost, g_write_cost, (unsigned long long)current->tot.strafes);
+    printf("%-8s %8s %7s %8s %7s %8s %8s ", "", "score", "shoot", "release", "press",
+           "writes/m", "ghost/m");
+    for (int i = 0; i < g_num_params; i++) printf(" %*s", param_width(&g_params[i]), g_params[i].field->key);
+    printf("\n");
+    print_cand("current", current, minutes);
+    if ((size_t)top > total) top = (int)total;
+    for (int k = 0; k < top; k++) {
+        char label[16];
+        snprintf(label, sizeof(label), "#%d", k + 1);
+        print_cand(label, &search[k], minutes);
+    }
+
+    if (search[0].tot.shootable_n) {
+        printf("\nBest:\n");
+        for (int i = 0; i < g_num_params; i++)
+            printf("%s=%g\n", g_params[i].field->key, search[0].x[i]);
+    }
+    return 0;
+}
@@ -0,0 +1,87 @@
+/*
+ * sweep_stubs.c - Keyboard entry points for the sweep build
+ *
+ * sweep.c compiles main.c in for the engine, which drags in its device
+ * code: the Analog SDK calls and the HID writer. A sweep only replays
+ * traces and never reaches them, so they are stubbed out here instead of
+ * linking the SDK, hidapi and setupapi. Everything reports "no device".
+ */
+
+#include "../include/wooting-analog-sdk.h"
+#include "hid_writer.h"
+
+/* ---------- Analog SDK ---------- */
+
+int wooting_analog_initialise(void) {
+    return WootingAnalogResult_DLLNotFound;
+}
+
+enum WootingAnalogResult wooting_analog_uninitialise(void) {
+    return WootingAnalogResult_UnInitialized;
+}
+
+enum WootingAnalogResult wooting_analog_set_keycode_mode(unsigned int mode) {
+    return WootingAnalogResult_UnInitialized;
+}
+
+enum WootingAnalogResult wooting_analog_set_device_event_cb(
+        void (*cb)(enum WootingAnalog_DeviceEventType, struct WootingAnalog_DeviceInfo_FFI *)) {
+    return WootingAnalogResult_UnInitialized;
+}
+
+enum WootingAnalogResult wooting_analog_clear_device_event_cb(void) {
+    return WootingAnalogResult_UnInitialized;
+}
+
+int wooting_analog_get_connected_devices_info(struct WootingAnalog_DeviceInfo_FFI **buffer,
+                                              unsigned int len) {
+    return WootingAnalogResult_UnInitialized;
+}
+
+int wooting_analog_read_full_buffer_device(unsigned short *code_buffer, float *analog_buffer,
+                                           unsigned int len, WootingAnalog_DeviceID device_id) {
+    return WootingAnalogResult_UnInitialized;
+}
+
+/* ---------- HID writer ---------- */
+
+WootingHID *wooting_hid_open(const char *cache_path) {
+    return NULL;
+}
+
+WootingHID *wooting_hid_open_match(const char *cache_path, uint64_t device_id) {
+    return NULL;
+}
+
+void wooting_hid_close(WootingHID *dev) {
+}
+
+const char *wooting_hid_serial(const WootingHID *dev) {
+    return "";
+}
+
+uint64_t wooting_hid_device_id(const WootingHID *dev) {
+    return 0;
+}
+
+bool wooting_key_position(uint8_t usage, uint8_t *row, uint8_t *col) {
+    return false;
+}
+
+bool wooting_hid_handshake(WootingHID *dev) {
+    return false;
+}
+
+bool wooting_hid_activate_profile(WootingHID *dev, int profile_idx) {
+    return false;
+}
+
+bool wooting_hid_write_actuation(WootingHID *dev, int profile_idx,
+                                 const KeySetting *keys, int count, bool save) {
+    return false;
+}
+
+bool wooting_hid_write_rt(WootingHID *dev, int profile_idx,
+                          const KeySetting *keys, int count, bool save) {
+    return false;
+}
@@ -0,0 +1,88 @@
+/*
+ * telemetry.h - Sampler -> display telemetry
+ *
+ * TelemetryFrame is a flat snapshot of everything the status line shows.
+ * The sampling thread publishes it through a seqlock (two counter stores
+ * and a memcpy, never blocks); readers retry until they get a consistent
+ * copy. Discrete state changes go through a bounded SPSC event ring
+ * instead, so none are lost to snapshot overwrites.
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+/* TelemetryFrame.flags */
+#define TF_H_PREDICTIVE  0x01
+#define TF_H_JIGGLE      0x02
+#define TF_V_PREDICTIVE  0x04
+#define TF_V_JIGGLE      0x08
+#define TF_CROUCH        0x10
+#define TF_GSI           0x20
+#define TF_ADAPTIVE      0x40
+#define TF_VEL           0x80
+
+typedef struct {
+    uint64_t frame;               /* sampler loop iteration */
+    int64_t  ticks;               /* QPC ticks of the sample */
+    float    w, a, s, d, ctrl;    /* analog depth 0-1 */
+    float    ap[4], rt[4];        /* AP/RT currently on the keyboard (W, A, S, D) */
+    float    vel;                 /* estimated |velocity| (u/s) */
+    float    vel_threshold;       /* 34% accuracy threshold for the weapon */
+    float    time_to_accurate_ms;
+    float    h_p50, h_p90;        /* live H-axis counter-strafe distribution */
+    float    h_perf;              /* PERF share, 0-1 */
+    uint32_t h_count;
+    uint64_t write_count;
+    uint8_t  h_state, v_state;    /* AxisState */
+    uint8_t  flags;               /* TF_* */
+    uint8_t  weapon_cat;          /* WeaponCategory */
+    char     round_phase[16];
+    uint8_t  idle;                /* 1 while the idle governor has the loop parked */
+} TelemetryFrame;
+
+/* One axis state transition, for the transition log lines */
+typedef struct {
+    uint8_t axis;                 /* 0 = H, 1 = V */
+    uint8_t from, to;             /* AxisState */
+    uint8_t quality;              /* StrafeQuality if a counter-strafe ended, else 0xFF */
+    float   ms;                   /* counter-strafe duration */
+} TelemetryEvent;
+
+#define TELEMETRY_NO_QUALITY 0xFF
+
+typedef struct {
+    _Atomic uint32_t seq;         /* odd while a write is in progress */
+    TelemetryFrame frame;
+} TelemetrySeqlock;
+
+/* Single writer. Never blocks. */
+static inline void telemetry_publish(TelemetrySeqlock *sl, const TelemetryFrame *f) {
+    uint32_t s = atomic_load_explicit(&sl->seq, memory_order_relaxed);
+    atomic_store_explicit(&sl->seq, s + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(&sl->frame, f, sizeof(*f));
+    atomic_store_explicit(&sl->seq, s + 2, memory_order_release);
+}
+
+/*
+ * Any number of readers. Returns false if nothing was published yet or
+ * the writer kept the slot busy for every retry.
+ */
+static inline bool telemetry_read(TelemetrySeqlock *sl, TelemetryFrame *out) {
+    for (int tries = 0; tries < 64; tries++) {
+        uint32_t s1 = atomic_load_explicit(&sl->seq, memory_order_acquire);
+        if (s1 & 1) continue;
+        memcpy(out, &sl->frame, sizeof(*out));
+        atomic_thread_fence(memory_order_acquire);
+        uint32_t s2 = atomic_load_explicit(&sl->seq, memory_order_relaxed);
+        if (s1 == s2) return s1 != 0;
+    }
+    return false;
+}
+
+#endif /* TELEMETRY_H */
@@ -0,0 +1,183 @@
+/*
+ * telemetry_shm.c - Shared-memory telemetry ring (writer + reader library)
+ *
+ * Kept free of SDK/HID dependencies so overlays can link just this file.
+ */
+
+#include "telemetry_shm.h"
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define SHM_MASK (TELEMETRY_SHM_SLOTS - 1)
+
+static size_t shm_size(void) {
+    return sizeof(TelemetryShmHeader) + (size_t)TELEMETRY_SHM_SLOTS * sizeof(TelemetryShmSlot);
+}
+
+static void shm_attach(TelemetryShm *shm, void *base) {
+    shm->hdr = (TelemetryShmHeader *)base;
+    shm->slots = (TelemetryShmSlot *)((char *)base + sizeof(TelemetryShmHeader));
+}
+
+/* ---------- writer ---------- */
+
+bool telemetry_shm_create(TelemetryShm *shm, uint64_t tick_freq) {
+    memset(shm, 0, sizeof(*shm));
+    size_t size = shm_size();
+    void *base;
+
+#ifdef _WIN32
+    HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                                        0, (DWORD)size, TELEMETRY_SHM_NAME_WIN);
+    if (!mapping) return false;
+    base = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (!base) { CloseHandle(mapping); return false; }
+    shm->mapping = mapping;
+    DWORD pid = GetCurrentProcessId();
+#else
+    int fd = shm_open(TELEMETRY_SHM_NAME_POSIX, O_CREAT | O_RDWR, 0644);
+    if (fd < 0) return false;
+    if (ftruncate(fd, (off_t)size) != 0) { close(fd); return false; }
+    base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return false;
+    uint32_t pid = (uint32_t)getpid();
+#endif
+
+    shm_attach(shm, base);
+    shm->size = size;
+    shm->writer = true;
+
+    /* A reader may still hold a mapping from a previous run: invalidate
+     * the magic first, reset, then publish the header last. */
+    TelemetryShmHeader *h = shm->hdr;
+    h->magic = 0;
+    atomic_thread_fence(memory_order_release);
+    for (uint32_t i = 0; i < TELEMETRY_SHM_SLOTS; i++)
+        atomic_store_explicit(&shm->slots[i].seq, 0, memory_order_relaxed);
+    atomic_store_explicit(&h->head, 0, memory_order_relaxed);
+    h->version = TELEMETRY_SHM_VERSION;
+    h->header_size = (uint16_t)sizeof(TelemetryShmHeader);
+    h->slot_size = (uint32_t)sizeof(TelemetryShmSlot);
+    h->capacity = TELEMETRY_SHM_SLOTS;
+    h->tick_freq = tick_freq;
+    h->writer_pid = (uint32_t)pid;
+    atomic_thread_fence(memory_order_release);
+    h->magic = TELEMETRY_SHM_MAGIC;
+    return true;
+}
+
+void telemetry_shm_publish(TelemetryShm *shm, const TelemetryFrame *f) {
+    TelemetryShmHeader *h = shm->hdr;
+    uint64_t n = atomic_load_explicit(&h->head, memory_order_relaxed);
+    TelemetryShmSlot *slot = &shm->slots[n & SHM_MASK];
+
+    atomic_store_explicit(&slot->seq, 2 * n + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(&slot->frame, f, sizeof(*f));
+    atomic_store_explicit(&slot->seq, 2 * n + 2, memory_order_release);
+    atomic_store_explicit(&h->head, n + 1, memory_order_release);
+}
+
+/* ---------- readers ---------- */
+
+bool telemetry_shm_open(TelemetryShm *shm) {
+    memset(shm, 0, sizeof(*shm));
+    size_t size = shm_size();
+    void *base;
+
+#ifdef _WIN32
+    HANDLE mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, TELEMETRY_SHM_NAME_WIN);
+    if (!mapping) return false;
+    base = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+    if (!base) { CloseHandle(mapping); return false; }
+    shm->mapping = mapping;
+#else
+    int fd = shm_open(TELEMETRY_SHM_NAME_POSIX, O_RDONLY, 0);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < size) { close(fd); return false; }
+    base = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return false;
+#endif
+
+    shm_attach(shm, base);
+    shm->size = size;
+
+    const TelemetryShmHeader *h = shm->hdr;
+    if (h->magic != TELEMETRY_SHM_MAGIC || h->version != TELEMETRY_SHM_VERSION ||
+        h->header_size != sizeof(TelemetryShmHeader) ||
+        h->slot_size != sizeof(TelemetryShmSlot) || h->capacity != TELEMETRY_SHM_SLOTS) {
+        telemetry_shm_close(shm);
+        return false;
+    }
+    atomic_thread_fence(memory_order_acquire);
+    return true;
+}
+
+void telemetry_cursor_init(const TelemetryShm *shm, TelemetryCursor *cur) {
+    uint64_t head = atomic_load_explicit(&shm->hdr->head, memory_order_acquire);
+    cur->next = head ? head - 1 : 0;
+    cur->lost = 0;
+}
+
+/* Copy frame n if it is still intact in its slot */
+static bool read_slot(const TelemetryShm *shm, uint64_t n, TelemetryFrame *out) {
+    TelemetryShmSlot *slot = &shm->slots[n & SHM_MASK];
+    uint64_t s1 = atomic_load_explicit(&slot->seq, memory_order_acquire);
+    if (s1 != 2 * n + 2) return false;
+    memcpy(out, &slot->frame, sizeof(*out));
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&slot->seq, memory_order_relaxed) == s1;
+}
+
+bool telemetry_shm_next(const TelemetryShm *shm, TelemetryCursor *cur, TelemetryFrame *out) {
+    for (;;) {
+        uint64_t head = atomic_load_explicit(&shm->hdr->head, memory_order_acquire);
+        if (cur->next > head) cur->next = head;     /* writer restarted */
+        if (cur->next == head) return false;
+
+        /* Fell a full lap behind: skip to the oldest frame still present */
+        if (head - cur->next > TELEMETRY_SHM_SLOTS) {
+            uint64_t oldest = head - TELEMETRY_SHM_SLOTS;
+            cur->lost += oldest - cur->next;
+            cur->next = oldest;
+        }
+
+        if (read_slot(shm, cur->next, out)) {
+            cur->next++;
+            return true;
+        }
+        cur->lost++;
+        cur->next++;
+    }
+}
+
+bool telemetry_shm_latest(const TelemetryShm *shm, TelemetryFrame *out) {
+    for (int tries = 0; tries < 8; tries++) {
+        uint64_t head = atomic_load_explicit(&shm->hdr->head, memory_order_acquire);
+        if (head == 0) return false;
+        if (read_slot(shm, head - 1, out)) return true;
+    }
+    return false;
+}
+
+void telemetry_shm_close(TelemetryShm *shm) {
+#ifdef _WIN32
+    if (shm->hdr) UnmapViewOfFile(shm->hdr);
+    if (shm->mapping) CloseHandle(shm->mapping);
+#else
+    if (shm->hdr) munmap(shm->hdr, shm->size);
+    if (shm->writer) shm_unlink(TELEMETRY_SHM_NAME_POSIX);
+#endif
+    memset(shm, 0, sizeof(*shm));
+}
@@ -0,0 +1,97 @@
+/*
+ * telemetry_shm.h - Shared-memory telemetry ring for external overlays
+ *
+ * The tuner publishes TelemetryFrames into a named shared-memory ring
+ * (file mapping "Local\wooting-aim-telemetry" on Windows, shm_open
+ * "/wooting-aim-telemetry" elsewhere). One writer, any number of readers;
+ * readers map the region read-only and never signal the writer, so they
+ * cannot slow the sampling thread down.
+ *
+ * Protocol: each slot carries a sequence number, 2n+1 while frame n is
+ * being written and 2n+2 once it is complete. `head` is the number of
+ * frames published. A reader copies a slot and accepts it only if the
+ * sequence is 2n+2 before and after the copy; otherwise the writer lapped
+ * it and the frame is counted as lost.
+ *
+ * Compatibility: readers must check magic, version and slot_size. Fields
+ * are only ever appended to TelemetryFrame; a layout change bumps version.
+ */
+
+#ifndef TELEMETRY_SHM_H
+#define TELEMETRY_SHM_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "telemetry.h"
+
+#define TELEMETRY_SHM_NAME_WIN    "Local\\wooting-aim-telemetry"
+#define TELEMETRY_SHM_NAME_POSIX  "/wooting-aim-telemetry"
+#ifdef _WIN32
+#define TELEMETRY_SHM_NAME        TELEMETRY_SHM_NAME_WIN
+#else
+#define TELEMETRY_SHM_NAME        TELEMETRY_SHM_NAME_POSIX  /* shm_open name */
+#endif
+#define TELEMETRY_SHM_MAGIC       0x4C544157u   /* "WATL" */
+#define TELEMETRY_SHM_VERSION     1
+#define TELEMETRY_SHM_SLOTS       4096          /* power of two, ~4s at 1 kHz */
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;
+    uint32_t slot_size;
+    uint32_t capacity;
+    uint64_t tick_freq;             /* TelemetryFrame.ticks per second */
+    uint32_t writer_pid;
+    uint32_t reserved;
+    _Alignas(64) _Atomic uint64_t head;  /* frames published so far */
+    char pad[56];
+} TelemetryShmHeader;
+
+typedef struct {
+    _Alignas(64) _Atomic uint64_t seq;
+    TelemetryFrame frame;
+} TelemetryShmSlot;
+
+typedef struct {
+    TelemetryShmHeader *hdr;
+    TelemetryShmSlot *slots;
+    size_t size;
+    bool writer;
+#ifdef _WIN32
+    void *mapping;
+#endif
+} TelemetryShm;
+
+/* Reader position. `lost` counts frames overwritten before they were read. */
+typedef struct {
+    uint64_t next;
+    uint64_t lost;
+} TelemetryCursor;
+
+/* ---------- writer (tuner) ---------- */
+
+bool telemetry_shm_create(TelemetryShm *shm, uint64_t tick_freq);
+void telemetry_shm_publish(TelemetryShm *shm, const TelemetryFrame *f);
+
+/* ---------- readers ---------- */
+
+/* Map an existing ring read-only. Fails if no tuner is running or the
+ * layout does not match this build. */
+bool telemetry_shm_open(TelemetryShm *shm);
+
+/* Start at the newest frame (live view). */
+void telemetry_cursor_init(const TelemetryShm *shm, TelemetryCursor *cur);
+
+/* Copy the next frame. Returns false when the reader has caught up. */
+bool telemetry_shm_next(const TelemetryShm *shm, TelemetryCursor *cur, TelemetryFrame *out);
+
+/* Copy the most recent frame only. Returns false if none is available. */
+bool telemetry_shm_latest(const TelemetryShm *shm, TelemetryFrame *out);
+
+/* Unmap (and, for the writer, unlink) the ring. The writer must have stopped
+ * publishing. Safe to call again, or on a ring that was never opened. */
+void telemetry_shm_close(TelemetryShm *shm);
+
+#endif /* TELEMETRY_SHM_H */
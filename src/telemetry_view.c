@@ -0,0 +1,98 @@
+/*
+ * telemetry_view.c - Example consumer of the shared-memory telemetry ring
+ *
+ * Attaches to a running wooting-aim and shows the live state, or streams
+ * every published frame as CSV with --csv. Reference for overlay authors:
+ * open, init a cursor, call telemetry_shm_next() in your render loop.
+ *
+ * Usage: telemetry-view [--csv]
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "telemetry_shm.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#define sleep_ms(ms) Sleep(ms)
+#else
+#include <time.h>
+static void sleep_ms(int ms) {
+    struct timespec ts = { ms / 1000, (long)(ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+}
+#endif
+
+#define REFRESH_MS 33
+
+static const char *state_names[] = { "I", "S+", "S-", "C+", "C-" };
+
+static const char *state_name(uint8_t s) {
+    return s < sizeof(state_names) / sizeof(state_names[0]) ? state_names[s] : "?";
+}
+
+static void print_bar(const char *label, float val) {
+    int bars = (int)(val * 20.0f);
+    printf(" %s:", label);
+    for (int i = 0; i < 20; i++) putchar(i < bars ? '#' : '.');
+}
+
+static void print_csv(const TelemetryFrame *f, double tick_freq) {
+    printf("%llu,%.6f,%.3f,%.3f,%.3f,%.3f,%.3f,%s,%s,%.2f,%.2f,%.2f,%.2f,%.1f,%.0f\n",
+           (unsigned long long)f->frame, (double)f->ticks / tick_freq,
+           f->w, f->a, f->s, f->d, f->ctrl,
+           state_name(f->h_state), state_name(f->v_state),
+           f->ap[1], f->rt[1], f->ap[3], f->rt[3], f->vel, f->time_to_accurate_ms);
+}
+
+int main(int argc, char *argv[]) {
+    bool csv = argc > 1 && strcmp(argv[1], "--csv") == 0;
+    if (argc > 1 && !csv) {
+        printf("Usage: telemetry-view [--csv]\n");
+        return 1;
+    }
+
+    TelemetryShm shm;
+    if (!telemetry_shm_open(&shm)) {
+        fprintf(stderr, "No telemetry found. Is wooting-aim running (telemetry_shm=1)?\n");
+        return 1;
+    }
+    double tick_freq = (double)shm.hdr->tick_freq;
+    fprintf(stderr, "Attached to wooting-aim (pid %u), %u-frame ring\n",
+            shm.hdr->writer_pid, shm.hdr->capacity);
+
+    TelemetryCursor cur;
+    telemetry_cursor_init(&shm, &cur);
+    TelemetryFrame f;
+
+    if (csv) {
+        printf("frame,time_s,w,a,s,d,ctrl,h_state,v_state,a_ap,a_rt,d_ap,d_rt,vel,tta_ms\n");
+        for (;;) {
+            while (telemetry_shm_next(&shm, &cur, &f)) print_csv(&f, tick_freq);
+            fflush(stdout);
+            sleep_ms(1);
+        }
+    }
+
+    uint64_t frames = 0;
+    for (;;) {
+        /* Drain everything new; only the newest frame is drawn */
+        bool got = false;
+        while (telemetry_shm_next(&shm, &cur, &f)) { frames++; got = true; }
+        if (got) {
+            printf("\r");
+            print_bar("A", f.a);
+            print_bar("D", f.d);
+            printf(" [H:%s V:%s%s] A:%.1f/%.1f D:%.1f/%.1f v:%.0f",
+                   state_name(f.h_state), state_name(f.v_state),
+                   (f.flags & TF_CROUCH) ? " C" : "",
+                   f.ap[1], f.rt[1], f.ap[3], f.rt[3], f.vel);
+            if (f.h_count)
+                printf(" p50:%.0f PERF:%.0f%%", f.h_p50, 100.0f * f.h_perf);
+            printf(" frames:%llu lost:%llu   ",
+                   (unsigned long long)frames, (unsigned long long)cur.lost);
+            fflush(stdout);
+        }
+        sleep_ms(REFRESH_MS);
+    }
+}
@@ -2,9 +2,12 @@
  * test_math.c - Unit tests for wooting-aim pure functions
  *
  * Tests velocity model, phase decay, vel scaling, mm conversion,
- * config parsing, weapon categorization, protobuf encoding.
+ * config parsing, weapon categorization, protobuf encoding, the
+ * actuation simulator.
  *
- * Build: gcc -O0 -g -Wall -fsanitize=address,undefined -I./include -o test_math.exe src/test_math.c
+ * Build: gcc -O0 -g -Wall -fsanitize=address,undefined -I./include -o test_math.exe \
+ *        src/test_math.c src/stats_store.c src/histogram.c src/config.c \
+ *        src/trace_file.c src/gsi.c src/actuation.c
  * (no SDK/HID dependencies)
  */
 
@@ -14,6 +17,12 @@
 #include <stdbool.h>
 #include <math.h>
 #include <stdint.h>
+#include "stats_store.h"
+#include "histogram.h"
+#include "config.h"
+#include "trace_file.h"
+#include "gsi.h"
+#include "actuation.h"
 
 /* ── test framework ── */
 static int g_pass = 0, g_fail = 0;
@@ -87,10 +96,6 @@ static int encode_varint(uint8_t *buf, uint32_t value) {
 #define VEL_AGGRO_ZONE     0.50f
 #define VEL_MIN_AP_FACTOR  0.5f
 
-typedef enum {
-    WCAT_RIFLE, WCAT_AWP, WCAT_PISTOL, WCAT_SMG, WCAT_KNIFE, WCAT_OTHER, WCAT_COUNT
-} WeaponCategory;
-
 static WeaponCategory categorize_weapon_type(const char *type) {
     if (!type[0]) return WCAT_OTHER;
     if (strcmp(type, "Rifle") == 0 || strcmp(type, "Machine Gun") == 0)
@@ -477,6 +482,450 @@ TEST(phase_decay_with_low_base) {
     ASSERT_FLOAT_EQ(result, expected, 0.01f);  /* 0.125 */
 }
 
+TEST(stats_record_layout) {
+    /* On-disk format: fixed sizes, no padding surprises across compilers */
+    ASSERT_INT_EQ((int)sizeof(StatsFileHeader), 16);
+    ASSERT_INT_EQ((int)sizeof(StatsRecord), 32);
+    ASSERT_INT_EQ((int)sizeof(StatsSession), 24);
+}
+
+TEST(stats_weapon_ids) {
+    ASSERT_INT_EQ(stats_weapon_id(""), 0);
+    ASSERT_INT_EQ(stats_weapon_id("weapon_unknown"), 0);
+    /* Prefix optional, exact match (m4a1 != m4a1_silencer) */
+    ASSERT_TRUE(stats_weapon_id("weapon_ak47") == stats_weapon_id("ak47"));
+    ASSERT_TRUE(stats_weapon_id("weapon_m4a1") != stats_weapon_id("weapon_m4a1_silencer"));
+    /* All knife skins collapse to one id */
+    ASSERT_INT_EQ(stats_weapon_id("weapon_knife_karambit"), stats_weapon_id("weapon_bayonet"));
+    /* Roundtrip */
+    ASSERT_TRUE(strcmp(stats_weapon_name(stats_weapon_id("weapon_awp")), "awp") == 0);
+    ASSERT_TRUE(strcmp(stats_weapon_name(250), "") == 0);
+}
+
+TEST(stats_store_torn_tail) {
+    const char *path = "test_stats.bin", *idx_path = "test_stats.idx";
+    remove(path);
+    remove(idx_path);
+    uint32_t sid = 99;
+    FILE *f = stats_store_open(path, idx_path, &sid);
+    ASSERT_TRUE(f != NULL);
+    ASSERT_INT_EQ((int)sid, 0);
+    StatsRecord r;
+    memset(&r, 0, sizeof(r));
+    for (int i = 0; i < 2; i++) {
+        r.ts_ns = i;
+        fwrite(&r, sizeof(r), 1, f);
+    }
+    fputs("torn", f);
+    fclose(f);
+    FILE *idx = fopen(idx_path, "ab");
+    fputs("torn", idx);
+    fclose(idx);
+
+    /* The torn tails go; the next record lands on a record boundary */
+    f = stats_store_open(path, idx_path, &sid);
+    ASSERT_TRUE(f != NULL);
+    ASSERT_INT_EQ((int)sid, 1);
+    r.ts_ns = 2;
+    fwrite(&r, sizeof(r), 1, f);
+    fclose(f);
+    StatsMap m;
+    ASSERT_TRUE(stats_map_open(&m, path));
+    ASSERT_INT_EQ((int)m.count, 3);
+    ASSERT_TRUE(m.rec[2].ts_ns == 2);
+    stats_map_close(&m);
+    StatsSession *sess;
+    ASSERT_INT_EQ((int)stats_index_load(idx_path, &sess), 2);
+    ASSERT_INT_EQ((int)sess[1].first_record, 2);
+    free(sess);
+
+    /* An index claiming records the file doesn't have is refused */
+    remove(path);
+    ASSERT_TRUE(stats_store_open(path, idx_path, &sid) == NULL);
+    remove(idx_path);
+}
+
+TEST(hist_bucket_layout) {
+    /* Exact below HIST_SUB, contiguous and monotonic above */
+    ASSERT_INT_EQ(hist_bucket(0), 0);
+    ASSERT_INT_EQ(hist_bucket(15), 15);
+    ASSERT_INT_EQ(hist_bucket(16), 16);
+    ASSERT_INT_EQ(hist_bucket(32), 32);
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        uint32_t lo = hist_bucket_low(i);
+        ASSERT_INT_EQ(hist_bucket(lo), i);
+        ASSERT_INT_EQ(hist_bucket(lo + hist_bucket_width(i) - 1), i);
+    }
+    /* Past the top octave clamps to the last bucket */
+    ASSERT_INT_EQ(hist_bucket(0xFFFFFFFFu), HIST_BUCKETS - 1);
+}
+
+TEST(hist_percentiles) {
+    static Histogram h;
+    memset(&h, 0, sizeof(h));
+    ASSERT_FLOAT_EQ((float)hist_percentile(&h, 50), 0.0f, 0.001f);
+
+    /* 1..1000 ms uniform: pXX ~ XX*10 ms within bucket precision (6.25%) */
+    for (int ms = 1; ms <= 1000; ms++) hist_record(&h, ms);
+    ASSERT_TRUE(h.total == 1000);
+    ASSERT_FLOAT_EQ((float)hist_percentile(&h, 50), 500.0f, 500.0f * 0.0625f);
+    ASSERT_FLOAT_EQ((float)hist_percentile(&h, 90), 900.0f, 900.0f * 0.0625f);
+    ASSERT_FLOAT_EQ((float)hist_percentile(&h, 99), 990.0f, 990.0f * 0.0625f);
+    ASSERT_FLOAT_EQ((float)hist_percentile(&h, 100), 1000.0f, 0.001f);
+    ASSERT_FLOAT_EQ((float)hist_mean(&h), 500.5f, 0.01f);
+
+    /* Merge doubles counts, keeps percentiles */
+    static Histogram m;
+    memset(&m, 0, sizeof(m));
+    hist_merge(&m, &h);
+    hist_merge(&m, &h);
+    ASSERT_TRUE(m.total == 2000);
+    ASSERT_FLOAT_EQ((float)hist_percentile(&m, 50), (float)hist_percentile(&h, 50), 0.001f);
+}
+
+TEST(strafe_quality_classes) {
+    ASSERT_INT_EQ(strafe_quality(80.0), CSQ_PERF);
+    ASSERT_INT_EQ(strafe_quality(65.0), CSQ_PERF);
+    ASSERT_INT_EQ(strafe_quality(62.0), CSQ_GOOD);
+    ASSERT_INT_EQ(strafe_quality(110.0), CSQ_GOOD);
+    ASSERT_INT_EQ(strafe_quality(40.0), CSQ_FAST);
+    ASSERT_INT_EQ(strafe_quality(150.0), CSQ_LATE);
+}
+
+/* ═══════════════════════ CONFIG SCHEMA ═══════════════════════ */
+
+TEST(config_defaults_and_sections) {
+    static Config c;
+    const char *text =
+        "# comment\n"
+        "ap_normal = 1.5\n"
+        "ws_adaptive = on   ; trailing comment\n"
+        "profile = retake\n"
+        "[weapon.awp]\n"
+        "ap = 0.9\n"
+        "[profile.retake]\n"
+        "ap_aggro = 0.3\n"
+        "[profile.retake.weapon.rifle]\n"
+        "rt = 0.15\n"
+        "[profile.entry]\n"
+        "ap_aggro = 0.2\n";
+    ASSERT_INT_EQ(config_parse_text(&c, text, "t", NULL, false), 0);
+    ASSERT_FLOAT_EQ(c.ap_normal, 1.5f, 0.0001f);
+    ASSERT_TRUE(c.ws_adaptive);
+    ASSERT_FLOAT_EQ(c.weapon[WCAT_AWP].ap, 0.9f, 0.0001f);
+    ASSERT_FLOAT_EQ(c.ap_aggro, 0.3f, 0.0001f);            /* active profile wins */
+    ASSERT_FLOAT_EQ(c.weapon[WCAT_RIFLE].rt, 0.15f, 0.0001f);
+    ASSERT_FLOAT_EQ(c.rt_normal, 1.0f, 0.0001f);           /* untouched default */
+    ASSERT_TRUE(strcmp(c.profile, "retake") == 0);
+    ASSERT_INT_EQ(c.profile_count, 2);
+
+    /* Caller override selects the other profile */
+    ASSERT_INT_EQ(config_parse_text(&c, text, "t", "entry", false), 0);
+    ASSERT_FLOAT_EQ(c.ap_aggro, 0.2f, 0.0001f);
+    ASSERT_FLOAT_EQ(c.weapon[WCAT_RIFLE].rt, 0.1f, 0.0001f);
+    ASSERT_TRUE(strcmp(c.profile, "entry") == 0);
+}
+
+TEST(config_rejects_bad_input) {
+    static Config c;
+    char err[160];
+    ASSERT_TRUE(!config_set(&c, "ap_normal", "5.0", err, sizeof(err)));    /* above 4mm */
+    ASSERT_TRUE(!config_set(&c, "ap_normal", "1.2mm", err, sizeof(err)));  /* trailing junk */
+    ASSERT_TRUE(!config_set(&c, "gsi_port", "70000", err, sizeof(err)));
+    ASSERT_TRUE(!config_set(&c, "ws_adaptive", "maybe", err, sizeof(err)));
+    ASSERT_TRUE(!config_set(&c, "no_such_key", "1", err, sizeof(err)));
+    ASSERT_TRUE(config_set(&c, "gsi_port", "3000", err, sizeof(err)));
+    ASSERT_INT_EQ(c.gsi_port, 3000);
+
+    /* Each bad line is one error, including inside inactive profiles */
+    ASSERT_INT_EQ(config_parse_text(&c, "ap_normal=9\nbogus=1\n", "t", NULL, false), 2);
+    ASSERT_INT_EQ(config_parse_text(&c, "[weapon.railgun]\nap=1\n", "t", NULL, false), 1);
+    ASSERT_INT_EQ(config_parse_text(&c, "[weapon.awp]\nvel_enabled=1\n", "t", NULL, false), 1);
+    ASSERT_INT_EQ(config_parse_text(&c, "[profile.x]\nap_aggro=0\n", "t", NULL, false), 1);
+    ASSERT_INT_EQ(config_parse_text(&c, "[profile.x\n", "t", NULL, false), 1);
+    ASSERT_INT_EQ(config_parse_text(&c, "[profile.x]\nprofile=x\n", "t", NULL, false), 1);
+
+    /* Selecting a profile the file does not define */
+    ASSERT_INT_EQ(config_parse_text(&c, "profile=missing\n", "t", NULL, false), 1);
+    ASSERT_INT_EQ(config_parse_text(&c, "ap_normal=1\n", "t", "missing", false), 1);
+}
+
+TEST(config_cpu_lists) {
+    static Config c;
+    char err[160], buf[64];
+    config_defaults(&c);
+    ASSERT_TRUE(c.sampler_cpus == 0);
+    ASSERT_TRUE(config_set(&c, "sampler_cpus", "2-3,6", err, sizeof(err)));
+    ASSERT_TRUE(c.sampler_cpus == 0x4Cull);
+    config_format(&c, config_find("sampler_cpus"), buf, sizeof(buf));
+    ASSERT_TRUE(strcmp(buf, "2-3,6") == 0);
+    ASSERT_TRUE(config_set(&c, "aux_cpus", "63", err, sizeof(err)));
+    ASSERT_TRUE(c.aux_cpus == 1ull << 63);
+    ASSERT_TRUE(config_set(&c, "aux_cpus", "", err, sizeof(err)));
+    ASSERT_TRUE(c.aux_cpus == 0);
+
+    ASSERT_TRUE(!config_set(&c, "sampler_cpus", "64", err, sizeof(err)));
+    ASSERT_TRUE(!config_set(&c, "sampler_cpus", "3-1", err, sizeof(err)));
+    ASSERT_TRUE(!config_set(&c, "sampler_cpus", "1-", err, sizeof(err)));
+    ASSERT_TRUE(!config_set(&c, "sampler_cpus", "a", err, sizeof(err)));
+    ASSERT_TRUE(!config_set(&c, "sampler_cpus", "-1", err, sizeof(err)));
+    ASSERT_TRUE(c.sampler_cpus == 0x4Cull);
+}
+
+TEST(config_key_lists) {
+    static Config c;
+    char err[160], buf[CFG_VALUE_MAX];
+    config_defaults(&c);
+    ASSERT_INT_EQ(c.key_forward, 0x1A);
+    ASSERT_INT_EQ(c.key_crouch, 0xE0);
+    ASSERT_INT_EQ(c.adaptive_keys.count, 0);
+
+    ASSERT_TRUE(config_set(&c, "key_forward", "i", err, sizeof(err)));
+    ASSERT_INT_EQ(c.key_forward, 0x0C);
+    ASSERT_TRUE(config_set(&c, "adaptive_keys", "space, lshift,e", err, sizeof(err)));
+    ASSERT_INT_EQ(c.adaptive_keys.count, 3);
+    ASSERT_INT_EQ(c.adaptive_keys.usage[0], 0x2C);
+    ASSERT_INT_EQ(c.adaptive_keys.usage[1], 0xE1);
+    config_format(&c, config_find("adaptive_keys"), buf, sizeof(buf));
+    ASSERT_TRUE(strcmp(buf, "space,lshift,e") == 0);
+
+    ASSERT_TRUE(!config_set(&c, "key_forward", "f13", err, sizeof(err)));
+    ASSERT_TRUE(!config_set(&c, "adaptive_keys", "space,space", err, sizeof(err)));
+    ASSERT_TRUE(!config_set(&c, "adaptive_keys", "space,,e", err, sizeof(err)));
+    ASSERT_INT_EQ(c.adaptive_keys.count, 3);
+
+    /* Every key name, once: the whole 61-key board */
+    char all[CFG_VALUE_MAX] = "";
+    for (int u = 0; u < 256; u++) {
+        const char *name = config_key_name(u);
+        if (!name) continue;
+        if (all[0]) strcat(all, ",");
+        strcat(all, name);
+    }
+    ASSERT_TRUE(config_set(&c, "adaptive_keys", all, err, sizeof(err)));
+    ASSERT_INT_EQ(c.adaptive_keys.count, 61);
+    config_format(&c, config_find("adaptive_keys"), buf, sizeof(buf));
+    ASSERT_TRUE(strcmp(buf, all) == 0);
+    ASSERT_TRUE(config_set(&c, "adaptive_keys", "", err, sizeof(err)));
+    ASSERT_INT_EQ(c.adaptive_keys.count, 0);
+}
+
+TEST(config_compile_derived) {
+    static Config c;
+    config_defaults(&c);
+    c.write_interval_ms = 50.0f;
+    c.poll_rate_hz = 8000.0f;
+    config_compile(&c, 10000000.0);
+    ASSERT_TRUE(c.write_interval_ticks == 500000);
+    ASSERT_TRUE(c.poll_period_ticks == 1250);
+    ASSERT_FLOAT_EQ(c.aggro[WCAT_AWP].ap, c.weapon[WCAT_AWP].ap, 0.0001f);
+    ASSERT_FLOAT_EQ(c.aggro[WCAT_COUNT].ap, c.ap_aggro, 0.0001f);
+
+    c.poll_rate_hz = 0.0f;
+    config_compile(&c, 10000000.0);
+    ASSERT_TRUE(c.poll_period_ticks == 0);
+
+    c.idle_after_ms = 2000.0f;
+    c.idle_poll_hz = 250.0f;
+    config_compile(&c, 10000000.0);
+    ASSERT_TRUE(c.idle_after_ticks == 20000000);
+    ASSERT_TRUE(c.idle_sleep_ms == 4);
+
+    /* Every schema default is inside its own range */
+    for (int i = 0; i < config_schema_count; i++) {
+        const CfgField *f = &config_schema[i];
+        if (f->type == CFG_NAME) continue;
+        ASSERT_TRUE(f->def >= f->min && f->def <= f->max);
+    }
+}
+
+/* ═══════════════════════ TRACE FILES ═══════════════════════ */
+
+TEST(trace_file_roundtrip) {
+    const char *path = "test_trace.watrace";
+    TraceFile t;
+    ASSERT_TRUE(trace_create(&t, path, 10000000));
+    for (int i = 0; i < 3; i++) {
+        TelemetryFrame f;
+        memset(&f, 0, sizeof(f));
+        f.frame = (uint64_t)i;
+        f.d = 0.25f * (float)i;
+        f.ap[3] = 0.4f;
+        ASSERT_TRUE(trace_write(&t, &f));
+    }
+    t.hdr.lost = 7;
+    trace_close(&t);
+
+    ASSERT_TRUE(trace_open(&t, path));
+    ASSERT_TRUE(t.hdr.tick_freq == 10000000);
+    ASSERT_INT_EQ((int)t.hdr.lost, 7);
+    TelemetryFrame f;
+    int n = 0;
+    while (trace_read(&t, &f)) {
+        ASSERT_TRUE(f.frame == (uint64_t)n);
+        ASSERT_FLOAT_EQ(f.d, 0.25f * (float)n, 0.0001f);
+        ASSERT_FLOAT_EQ(f.ap[3], 0.4f, 0.0001f);
+        n++;
+    }
+    ASSERT_INT_EQ(n, 3);
+    trace_close(&t);
+
+    /* Foreign files are refused */
+    FILE *junk = fopen(path, "wb");
+    fputs("not a trace, just some text that is long enough", junk);
+    fclose(junk);
+    ASSERT_TRUE(!trace_open(&t, path));
+    remove(path);
+}
+
+/* ═══════════════════════ ACTUATION SIMULATOR ═══════════════════════ */
+
+TEST(act_key_rapid_trigger) {
+    ActKey k;
+    act_key_reset(&k);
+    /* AP 1.0 mm, RT 0.2 mm */
+    ASSERT_INT_EQ(act_key_step(&k, 0.5f, 1.0f, 0.2f), 0);
+    ASSERT_INT_EQ(act_key_step(&k, 1.0f, 1.0f, 0.2f), 1);     /* crosses AP */
+    ASSERT_INT_EQ(act_key_step(&k, 2.0f, 1.0f, 0.2f), 0);
+    ASSERT_INT_EQ(act_key_step(&k, 1.85f, 1.0f, 0.2f), 0);
+    ASSERT_INT_EQ(act_key_step(&k, 1.75f, 1.0f, 0.2f), -1);   /* rose RT from 2.0 */
+    ASSERT_INT_EQ(act_key_step(&k, 1.7f, 1.0f, 0.2f), 0);     /* new highest point */
+    ASSERT_INT_EQ(act_key_step(&k, 1.95f, 1.0f, 0.2f), 1);    /* sank RT from 1.7 */
+    ASSERT_INT_EQ(act_key_step(&k, 0.9f, 1.0f, 0.2f), -1);    /* above AP: zone ends */
+    ASSERT_INT_EQ(act_key_step(&k, 0.95f, 1.0f, 0.2f), 0);
+    ASSERT_INT_EQ(act_key_step(&k, 1.05f, 1.0f, 0.2f), 1);    /* AP again, not RT */
+
+    /* RT 0 = plain actuation point */
+    act_key_reset(&k);
+    ASSERT_INT_EQ(act_key_step(&k, 2.0f, 1.0f, 0.0f), 1);
+    ASSERT_INT_EQ(act_key_step(&k, 1.1f, 1.0f, 0.0f), 0);
+    ASSERT_INT_EQ(act_key_step(&k, 0.9f, 1.0f, 0.0f), -1);
+}
+
+TEST(act_counter_strafe_gain) {
+    /* A held 200 ms, lifted over 40 ms from t=200; D pressed over 40 ms
+     * from t=210. 1 ms frames, engine AP 0.4 / RT 0.1 on every key. */
+    enum { N = 400 };
+    static ActFrame f[N];
+    for (int i = 0; i < N; i++) {
+        ActFrame *a = &f[i];
+        memset(a, 0, sizeof(*a));
+        a->t_ms = i;
+        a->depth[1] = i < 200 ? 1.0f : i < 240 ? (240 - i) / 40.0f : 0.0f;
+        a->depth[3] = i < 210 ? 0.0f : i < 250 ? (i - 210) / 40.0f : 1.0f;
+        for (int k = 0; k < ACT_KEYS; k++) { a->ap[k] = 0.4f; a->rt[k] = 0.1f; }
+        a->max_speed = 215.0f;
+        a->h_state = i < 211 ? 2 : i < 300 ? 3 : 1;   /* S-, C+, S+ */
+    }
+    ActOptions o = { 1.2f, 1.0f, 0.0f };
+    ActResult r;
+    ASSERT_TRUE(act_simulate(f, N, &o, &r));
+    ASSERT_INT_EQ((int)r.count, 1);
+    ASSERT_INT_EQ((int)r.skipped, 0);
+    if (r.count == 1) {
+        ASSERT_INT_EQ(r.strafes[0].axis, 0);
+        ASSERT_INT_EQ(r.strafes[0].dir, 1);
+        ASSERT_FLOAT_EQ(r.strafes[0].release_ms, 9.0f, 1.5f);  /* 3.9 mm vs 3.0 mm */
+        ASSERT_FLOAT_EQ(r.strafes[0].press_ms, 8.0f, 1.5f);    /* 0.4 mm vs 1.2 mm */
+        ASSERT_TRUE(r.strafes[0].shootable_ms > 0.0f);
+    }
+    ASSERT_TRUE(r.presses[0] == 2 && r.presses[1] == 2);
+    ASSERT_TRUE(r.ghost_presses == 0);
+
+    /* A prebuilt static run (as the sweep shares per trace) gives the same */
+    ActRun *base = act_run_static(f, N, &o);
+    ActResult w;
+    ASSERT_TRUE(base != NULL && act_simulate_with(f, N, &o, base, &w));
+    ASSERT_INT_EQ((int)w.count, (int)r.count);
+    if (w.count == 1 && r.count == 1) {
+        ASSERT_FLOAT_EQ(w.strafes[0].release_ms, r.strafes[0].release_ms, 0.0001f);
+        ASSERT_FLOAT_EQ(w.strafes[0].shootable_ms, r.strafes[0].shootable_ms, 0.0001f);
+    }
+    act_result_free(&w);
+    act_run_free(base);
+
+    /* Same AP/RT on both sides: nothing gained */
+    ActOptions same = { 0.4f, 0.1f, 0.0f };
+    ActResult z;
+    ASSERT_TRUE(act_simulate(f, N, &same, &z));
+    ActSummary s;
+    act_summarize(&z, &s);
+    ASSERT_INT_EQ((int)s.release.n, 1);
+    ASSERT_FLOAT_EQ(s.release.mean, 0.0f, 0.001f);
+    ASSERT_FLOAT_EQ(s.shootable.mean, 0.0f, 0.001f);
+    act_result_free(&z);
+    act_result_free(&r);
+}
+
+TEST(act_simulate_rejects_backwards_time) {
+    /* Time running backwards fails the adaptive run; with no static run
+     * given, nothing is left to compare against */
+    ActFrame f[3];
+    memset(f, 0, sizeof(f));
+    for (int i = 0; i < 3; i++) {
+        for (int k = 0; k < ACT_KEYS; k++) { f[i].ap[k] = 0.4f; f[i].rt[k] = 0.1f; }
+        f[i].max_speed = 215.0f;
+        f[i].h_state = 2;
+    }
+    f[0].t_ms = 10.0; f[1].t_ms = 5.0; f[2].t_ms = 20.0;
+    f[2].depth[3] = 1.0f;
+    f[2].h_state = 3;
+    ActOptions o = { 1.2f, 1.0f, 0.0f };
+    ActResult r;
+    ASSERT_TRUE(!act_simulate_with(f, 3, &o, NULL, &r));
+    ASSERT_TRUE(r.strafes == NULL && r.count == 0);
+    ASSERT_TRUE(r.presses[0] == 0 && r.presses[1] == 0);
+    ASSERT_TRUE(act_run_static(f, 3, &o) == NULL);
+}
+
+/* ═══════════════════════ GSI ═══════════════════════ */
+
+TEST(gsi_parse_fields) {
+    const char *json =
+        "{ \"map\": { \"phase\": \"live\", \"round\": 7 },"
+        "  \"round\": { \"phase\": \"freezetime\" },"
+        "  \"player\": { \"state\": { \"health\": 76 },"
+        "    \"weapons\": {"
+        "      \"weapon_0\": { \"name\": \"weapon_knife\", \"type\": \"Knife\", \"state\": \"holstered\" },"
+        "      \"weapon_1\": { \"name\": \"weapon_ak47\", \"type\": \"Rifle\", \"state\": \"active\" } } } }";
+    GsiUpdate u;
+    gsi_parse(json, (int)strlen(json), &u);
+    ASSERT_TRUE(strcmp(u.round_phase, "freezetime") == 0);  /* not map.phase */
+    ASSERT_INT_EQ(u.health, 76);
+    ASSERT_TRUE(strcmp(u.weapon_name, "weapon_ak47") == 0);
+    ASSERT_TRUE(strcmp(u.weapon_type, "Rifle") == 0);
+
+    /* Cut short: only what lies inside len is seen */
+    const char *w = strstr(json, "\"weapon_1\"");
+    gsi_parse(json, (int)(w - json), &u);
+    ASSERT_INT_EQ(u.health, 76);
+    ASSERT_TRUE(u.weapon_name[0] == '\0');
+
+    const char *dropped = "{\"player\":{\"weapons\":{\"w\":{\"x\":\"active\",\"state\":\"dropped\"}}}}";
+    gsi_parse(dropped, (int)strlen(dropped), &u);
+    ASSERT_TRUE(u.weapon_name[0] == '\0');
+    ASSERT_INT_EQ(u.health, -1);
+}
+
+TEST(gsi_http_framing) {
+    const char *req = "POST / HTTP/1.1\r\ncontent-length:  5\r\n\r\n{}{}{}";
+    const char *body;
+    bool complete;
+    ASSERT_INT_EQ(gsi_http_body(req, 20, &body, &complete), -1);
+    ASSERT_INT_EQ(gsi_http_body(req, (int)strlen(req), &body, &complete), 5);
+    ASSERT_TRUE(complete && strncmp(body, "{}{}{", 5) == 0);
+
+    /* Content-Length past what arrived is clipped to it */
+    const char *big = "POST / HTTP/1.1\r\nContent-Length: 99999999999\r\n\r\n{\"a\"";
+    ASSERT_INT_EQ(gsi_http_body(big, (int)strlen(big), &body, &complete), 4);
+    ASSERT_TRUE(!complete);
+
+    /* No Content-Length: done at the end of the headers */
+    const char *none = "POST / HTTP/1.1\r\n\r\nContent-Length: 3\r\n";
+    ASSERT_INT_EQ(gsi_http_body(none, (int)strlen(none), &body, &complete), 0);
+    ASSERT_TRUE(complete);
+}
+
 /* ═══════════════════════ MAIN ═══════════════════════ */
 
 int main(void) {
@@ -515,6 +964,35 @@ int main(void) {
     RUN(velocity_clamp_max_speed);
     RUN(velocity_stopspeed_behavior);
 
+    printf("\n--- stats store ---\n");
+    RUN(stats_record_layout);
+    RUN(stats_weapon_ids);
+    RUN(stats_store_torn_tail);
+
+    printf("\n--- timing histograms ---\n");
+    RUN(hist_bucket_layout);
+    RUN(hist_percentiles);
+    RUN(strafe_quality_classes);
+
+    printf("\n--- config schema ---\n");
+    RUN(config_defaults_and_sections);
+    RUN(config_rejects_bad_input);
+    RUN(config_cpu_lists);
+    RUN(config_key_lists);
+    RUN(config_compile_derived);
+
+    printf("\n--- trace files ---\n");
+    RUN(trace_file_roundtrip);
+
+    printf("\n--- actuation simulator ---\n");
+    RUN(act_key_rapid_trigger);
+    RUN(act_counter_strafe_gain);
+    RUN(act_simulate_rejects_backwards_time);
+
+    printf("\n--- game state integration ---\n");
+    RUN(gsi_parse_fields);
+    RUN(gsi_http_framing);
+
     printf("\n=== RESULTS: %d passed, %d failed ===\n", g_pass, g_fail);
     return g_fail > 0 ? 1 : 0;
 }
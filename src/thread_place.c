@@ -0,0 +1,241 @@
+/*
+ * thread_place.c - Thread affinity / priority / MMCSS
+ */
+
+#ifndef _WIN32
+#define _GNU_SOURCE
+#endif
+
+#include "thread_place.h"
+#include "config.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+typedef HANDLE (WINAPI *AvSetMmThreadCharacteristicsA_t)(LPCSTR, LPDWORD);
+typedef BOOL (WINAPI *AvRevertMmThreadCharacteristics_t)(HANDLE);
+
+static HANDLE g_mmcss_task;
+static DWORD  g_mmcss_thread;     /* thread id registered with MMCSS */
+static AvRevertMmThreadCharacteristics_t g_AvRevert;
+
+/* NtQueryInformationThread(ThreadBasicInformation): the only way to read a
+ * thread's affinity without changing it */
+typedef struct {
+    LONG      exit_status;
+    PVOID     teb;
+    PVOID     client_id[2];
+    ULONG_PTR affinity;
+    LONG      priority;
+    LONG      base_priority;
+} ThreadBasicInfo;
+typedef LONG (NTAPI *NtQueryInformationThread_t)(HANDLE, int, PVOID, ULONG, PULONG);
+
+static HANDLE native(const PlatThread *t) {
+    return t ? t->handle : GetCurrentThread();
+}
+
+uint64_t thread_cpus_available(void) {
+    DWORD_PTR proc = 0, sys = 0;
+    if (!GetProcessAffinityMask(GetCurrentProcess(), &proc, &sys)) return 0;
+    return (uint64_t)proc;
+}
+
+static bool mmcss_register(void) {
+    HMODULE avrt = LoadLibraryA("avrt.dll");
+    if (!avrt) return false;
+    AvSetMmThreadCharacteristicsA_t set = (AvSetMmThreadCharacteristicsA_t)
+        GetProcAddress(avrt, "AvSetMmThreadCharacteristicsA");
+    g_AvRevert = (AvRevertMmThreadCharacteristics_t)
+        GetProcAddress(avrt, "AvRevertMmThreadCharacteristics");
+    if (!set || !g_AvRevert) return false;
+
+    DWORD task = 0;
+    g_mmcss_task = set("Games", &task);
+    if (!g_mmcss_task) return false;
+    g_mmcss_thread = GetCurrentThreadId();
+    return true;
+}
+
+bool thread_place(const PlatThread *pt, const ThreadPlacement *p) {
+    HANDLE t = native(pt);
+    bool ok = true;
+    if (p->cpus) {
+        uint64_t mask = p->cpus & thread_cpus_available();
+        if (!mask || !SetThreadAffinityMask(t, (DWORD_PTR)mask)) {
+            printf("[CPU] Cannot set affinity: %lu\n", mask ? GetLastError() : 0ul);
+            ok = false;
+        }
+    }
+
+    static const int prio[] = { 0, THREAD_PRIORITY_ABOVE_NORMAL, THREAD_PRIORITY_HIGHEST,
+                                THREAD_PRIORITY_TIME_CRITICAL };
+    if (p->priority > THREAD_PRIO_DEFAULT && p->priority <= THREAD_PRIO_TIME_CRITICAL &&
+        !SetThreadPriority(t, prio[p->priority])) {
+        printf("[CPU] Cannot set priority: %lu\n", GetLastError());
+        ok = false;
+    }
+
+    if (p->mmcss && !g_mmcss_task && !mmcss_register()) {
+        printf("[CPU] MMCSS registration failed: %lu\n", GetLastError());
+        ok = false;
+    }
+    return ok;
+}
+
+void thread_place_report(const PlatThread *pt, char *buf, size_t size) {
+    HANDLE t = native(pt);
+    char cpus[96] = "?";
+    static NtQueryInformationThread_t query;
+    if (!query) {
+        HMODULE ntdll = GetModuleHandleA("ntdll.dll");
+        if (ntdll) query = (NtQueryInformationThread_t)GetProcAddress(ntdll, "NtQueryInformationThread");
+    }
+    ThreadBasicInfo tbi;
+    if (query && query(t, 0, &tbi, sizeof(tbi), NULL) == 0)
+        config_format_cpuset((uint64_t)tbi.affinity, cpus, sizeof(cpus));
+
+    const char *prio;
+    switch (GetThreadPriority(t)) {
+    case THREAD_PRIORITY_IDLE:          prio = "idle"; break;
+    case THREAD_PRIORITY_LOWEST:        prio = "lowest"; break;
+    case THREAD_PRIORITY_BELOW_NORMAL:  prio = "below-normal"; break;
+    case THREAD_PRIORITY_NORMAL:        prio = "normal"; break;
+    case THREAD_PRIORITY_ABOVE_NORMAL:  prio = "above-normal"; break;
+    case THREAD_PRIORITY_HIGHEST:       prio = "highest"; break;
+    case THREAD_PRIORITY_TIME_CRITICAL: prio = "time-critical"; break;
+    default:                            prio = "?"; break;
+    }
+
+    bool mmcss = g_mmcss_task && GetThreadId(t) == g_mmcss_thread;
+    snprintf(buf, size, "cpus %s  prio %s%s", cpus, prio, mmcss ? "  mmcss Games" : "");
+}
+
+void thread_place_release(void) {
+    if (g_mmcss_task && GetCurrentThreadId() == g_mmcss_thread) {
+        g_AvRevert(g_mmcss_task);
+        g_mmcss_task = NULL;
+    }
+}
+
+#else /* Linux */
+
+/*
+ * THREAD_PRIO_* as nice values. A busy-polling thread under SCHED_FIFO
+ * never gives its CPU to SCHED_OTHER work there (the HID writer, the
+ * device thread, the kernel's per-CPU kthreads), with only RT throttling,
+ * which can be turned off, as a guard. So SCHED_FIFO, kept under the
+ * kernel's threaded IRQs (50), is used only when none of our other threads
+ * share the CPUs; kernel work is kept off them with isolcpus/nohz_full.
+ */
+static const int nice_of[]   = { 0, -5, -10, -15 };
+static const int fifo_prio[] = { 0, 10, 20, 30 };
+
+static pthread_t native(const PlatThread *t) {
+    return t ? t->id : pthread_self();
+}
+
+static uint64_t mask_from_set(const cpu_set_t *set) {
+    uint64_t mask = 0;
+    for (int i = 0; i < 64; i++)
+        if (CPU_ISSET(i, set)) mask |= 1ull << i;
+    return mask;
+}
+
+uint64_t thread_cpus_available(void) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) return 0;
+    return mask_from_set(&set);
+}
+
+bool thread_place(const PlatThread *pt, const ThreadPlacement *p) {
+    pthread_t t = native(pt);
+    bool ok = true;
+    if (p->cpus) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int i = 0; i < 64; i++)
+            if (p->cpus >> i & 1) CPU_SET(i, &set);
+        int rc = pthread_setaffinity_np(t, sizeof(set), &set);
+        if (rc != 0) {
+            printf("[CPU] Cannot set affinity: %s\n", strerror(rc));
+            ok = false;
+        }
+    }
+
+    if (p->priority > THREAD_PRIO_DEFAULT && p->priority <= THREAD_PRIO_TIME_CRITICAL &&
+        p->exclusive && p->cpus) {
+        struct sched_param sp = { .sched_priority = fifo_prio[p->priority] };
+        int rc = pthread_setschedparam(t, SCHED_FIFO, &sp);
+        if (rc != 0) {
+            printf("[CPU] Cannot set SCHED_FIFO %d: %s%s\n", sp.sched_priority, strerror(rc),
+                   rc == EPERM ? " (needs CAP_SYS_NICE or an rtprio limit)" : "");
+            ok = false;
+        }
+    } else if (p->priority > THREAD_PRIO_DEFAULT && p->priority <= THREAD_PRIO_TIME_CRITICAL) {
+        /* nice is per kernel thread id, which only the thread itself knows */
+        int n = nice_of[p->priority];
+        if (pt) {
+            printf("[CPU] nice applies to the calling thread only, ignored.\n");
+            ok = false;
+        } else if (setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), n) != 0) {
+            int err = errno;
+            printf("[CPU] Cannot set nice %d: %s%s\n", n, strerror(err),
+                   err == EACCES || err == EPERM ? " (needs CAP_SYS_NICE or a nice limit)" : "");
+            ok = false;
+        }
+    }
+
+    if (p->mmcss) printf("[CPU] MMCSS is Windows-only, ignored.\n");
+    return ok;
+}
+
+void thread_place_report(const PlatThread *pt, char *buf, size_t size) {
+    pthread_t t = native(pt);
+    char cpus[96] = "?";
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (pthread_getaffinity_np(t, sizeof(set), &set) == 0)
+        config_format_cpuset(mask_from_set(&set), cpus, sizeof(cpus));
+
+    int policy;
+    struct sched_param sp;
+    if (pthread_getschedparam(t, &policy, &sp) != 0) policy = -1;
+    if (policy == SCHED_FIFO || policy == SCHED_RR) {
+        snprintf(buf, size, "cpus %s  prio %s %d", cpus,
+                 policy == SCHED_FIFO ? "fifo" : "rr", sp.sched_priority);
+        return;
+    }
+
+    /* PLAT_PRIO_BELOW_NORMAL / _LOWEST run as batch / idle. The nice value
+     * is only readable for the calling thread (no TID for the others) */
+    const char *prio;
+    switch (policy) {
+    case SCHED_OTHER: prio = "normal"; break;
+    case SCHED_BATCH: prio = "batch"; break;
+    case SCHED_IDLE:  prio = "idle"; break;
+    default:          prio = "?"; break;
+    }
+    errno = 0;
+    int nice = pt ? 0 : getpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid));
+    if (errno) nice = 0;
+    if (nice && policy != SCHED_IDLE)
+        snprintf(buf, size, "cpus %s  prio %s nice %d", cpus, prio, nice);
+    else
+        snprintf(buf, size, "cpus %s  prio %s", cpus, prio);
+}
+
+void thread_place_release(void) {
+}
+
+#endif
@@ -0,0 +1,52 @@
+/*
+ * thread_place.h - CPU affinity and priority for the tuner's threads
+ *
+ * The sampling loop and the helper threads (GSI, stats writer, renderer,
+ * metrics, control) are placed from the config at startup:
+ *   Windows  SetThreadAffinityMask, SetThreadPriority, MMCSS via avrt.dll
+ *   Linux    pthread_setaffinity_np, nice for raised priorities (SCHED_FIFO
+ *            only on CPUs reserved for the thread)
+ *
+ * thread_place_report() reads the placement back from the OS, so the
+ * startup lines show what was actually granted, not what was asked for.
+ */
+
+#ifndef THREAD_PLACE_H
+#define THREAD_PLACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "platform.h"
+
+typedef enum {
+    THREAD_PRIO_DEFAULT,        /* leave as created */
+    THREAD_PRIO_ABOVE_NORMAL,
+    THREAD_PRIO_HIGHEST,
+    THREAD_PRIO_TIME_CRITICAL,
+} ThreadPrio;
+
+typedef struct {
+    uint64_t cpus;              /* bit n = CPU n, 0 = leave unchanged */
+    ThreadPrio priority;
+    bool exclusive;             /* none of our other threads run on cpus */
+    bool mmcss;                 /* calling thread only */
+} ThreadPlacement;
+
+/* CPUs this process may run on. */
+uint64_t thread_cpus_available(void);
+
+/*
+ * Apply p to thread t (NULL = the calling thread). Each part is attempted
+ * on its own; failures are printed as [CPU] lines and make the call
+ * return false.
+ */
+bool thread_place(const PlatThread *t, const ThreadPlacement *p);
+
+/* One line: "cpus 2-3 prio highest mmcss" from the thread's actual state. */
+void thread_place_report(const PlatThread *t, char *buf, size_t size);
+
+/* Undo MMCSS registration on the calling thread. */
+void thread_place_release(void);
+
+#endif /* THREAD_PLACE_H */
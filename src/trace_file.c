@@ -0,0 +1,64 @@
+/*
+ * trace_file.c - Recorded telemetry trace reader/writer
+ */
+
+#include "trace_file.h"
+#include <string.h>
+
+bool trace_create(TraceFile *t, const char *path, uint64_t tick_freq) {
+    memset(t, 0, sizeof(*t));
+    t->f = fopen(path, "wb");
+    if (!t->f) return false;
+
+    t->hdr.magic = TRACE_MAGIC;
+    t->hdr.version = TRACE_VERSION;
+    t->hdr.header_size = (uint16_t)sizeof(TraceHeader);
+    t->hdr.frame_size = (uint32_t)sizeof(TelemetryFrame);
+    t->hdr.tick_freq = tick_freq;
+    t->writing = true;
+    if (fwrite(&t->hdr, sizeof(t->hdr), 1, t->f) != 1) {
+        fclose(t->f);
+        t->f = NULL;
+        return false;
+    }
+    return true;
+}
+
+bool trace_write(TraceFile *t, const TelemetryFrame *f) {
+    if (fwrite(f, sizeof(*f), 1, t->f) != 1) return false;
+    t->hdr.frames++;
+    return true;
+}
+
+bool trace_open(TraceFile *t, const char *path) {
+    memset(t, 0, sizeof(*t));
+    t->f = fopen(path, "rb");
+    if (!t->f) return false;
+
+    if (fread(&t->hdr, sizeof(t->hdr), 1, t->f) != 1 ||
+        t->hdr.magic != TRACE_MAGIC || t->hdr.version != TRACE_VERSION ||
+        t->hdr.header_size < sizeof(TraceHeader) ||
+        t->hdr.frame_size != sizeof(TelemetryFrame) ||
+        fseek(t->f, t->hdr.header_size, SEEK_SET) != 0) {
+        fclose(t->f);
+        t->f = NULL;
+        return false;
+    }
+    /* Reader-side count: 0 in the header just means the writer never closed */
+    t->hdr.frames = 0;
+    return true;
+}
+
+bool trace_read(TraceFile *t, TelemetryFrame *out) {
+    if (fread(out, sizeof(*out), 1, t->f) != 1) return false;
+    t->hdr.frames++;
+    return true;
+}
+
+void trace_close(TraceFile *t) {
+    if (!t->f) return;
+    if (t->writing && fseek(t->f, 0, SEEK_SET) == 0)
+        fwrite(&t->hdr, sizeof(t->hdr), 1, t->f);
+    fclose(t->f);
+    t->f = NULL;
+}
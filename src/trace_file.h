@@ -0,0 +1,54 @@
+/*
+ * trace_file.h - Recorded telemetry traces (.watrace)
+ *
+ * A trace is the frame stream the tuner published to its telemetry ring,
+ * saved to disk: analog depths of W/A/S/D/Ctrl, axis states and the AP/RT
+ * in effect, one TelemetryFrame per input or setting change. Replaying it
+ * reproduces exactly what the engine saw and what it wrote.
+ *
+ * Layout: TraceHeader, then TelemetryFrame records back to back, little
+ * endian, no padding between them. Readers must check magic, version and
+ * frame_size; frames are only ever appended to, never reordered.
+ */
+
+#ifndef TRACE_FILE_H
+#define TRACE_FILE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "telemetry.h"
+
+#define TRACE_MAGIC    0x52544157u   /* "WATR" */
+#define TRACE_VERSION  1
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;
+    uint32_t frame_size;
+    uint32_t lost;              /* frames the recorder missed (ring lapped) */
+    uint64_t tick_freq;         /* TelemetryFrame.ticks per second */
+    uint64_t frames;            /* written on close; 0 if the recorder died */
+} TraceHeader;
+
+typedef struct {
+    FILE *f;
+    TraceHeader hdr;            /* frames counts writes / reads so far */
+    bool writing;
+} TraceFile;
+
+/* Create a trace for writing. */
+bool trace_create(TraceFile *t, const char *path, uint64_t tick_freq);
+bool trace_write(TraceFile *t, const TelemetryFrame *f);
+
+/* Open an existing trace. Fails on a foreign or incompatible file. */
+bool trace_open(TraceFile *t, const char *path);
+
+/* Next frame. Returns false at the end of the file. */
+bool trace_read(TraceFile *t, TelemetryFrame *out);
+
+/* Writers patch the frame and lost counts into the header. */
+void trace_close(TraceFile *t);
+
+#endif /* TRACE_FILE_H */